@@ -0,0 +1,193 @@
+#ifndef	RING_BUFFER_BENCH_H
+#	define	RING_BUFFER_BENCH_H
+
+/** ring_buffer_bench harness, shared by the C and C++ (comparison) translation units.
+ *
+ * - `bench_loop` times a single-thread loop, doubling its iteration count until
+ *   it lasts `--min-time`, and reports ns per operation;
+ * - `bench_xfer_run` streams `--items` items from producer to consumer threads,
+ *   each pinned to its own cpu, and reports throughput plus latency percentiles.
+ *   `BENCH_XFER_THREADS` generates the thread bodies of a backend, so its
+ *   put/get calls are inlined and every backend runs the very same loop.
+ *
+ * Latency is sampled (one item in BENCH_SAMPLE_MASK + 1 carries a timestamp)
+ * and measured under full load, so it includes the time spent queued.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** Options and state. @{ */
+
+struct bench_opt
+{
+	const char	*filter;	///< Only run benchmarks whose name contains this.
+	uint64_t	min_ns;		///< Minimum duration of a timed loop.
+	uint64_t	items;		///< Items streamed by each threaded run.
+	bool		compare;	///< Also run the comparison backends.
+	bool		list;		///< Only list benchmark names.
+};
+
+extern struct bench_opt	bench_opt;
+extern int		bench_failed;	///< Set when a threaded run lost, duplicated or reordered items.
+extern volatile uint64_t	bench_sink;	///< Keeps timed loop results alive.
+
+/** @} */
+
+
+/** Timed loops. @{ */
+
+typedef void	( *bench_loop_fn )( void *arg, uint64_t iters );
+
+uint64_t	bench_now_ns ( void );
+bool		bench_selected ( const char *name );
+
+/** Time `fn( arg, iters )`, doing `ops` operations and moving `bytes` bytes (0: don't report) per iteration. */
+void	bench_loop ( const char *name, bench_loop_fn fn, void *arg, unsigned ops, size_t bytes );
+
+/** @} */
+
+
+/** Threaded transfers. @{ */
+
+/// Items: sequence number, sampling timestamp (0: not sampled), padding to the element size.
+struct bench_item16
+{
+	uint64_t	seq;
+	uint64_t	stamp;
+};
+
+struct bench_item64
+{
+	uint64_t	seq;
+	uint64_t	stamp;
+	uint64_t	pad[ 6 ];
+};
+
+#define	BENCH_SAMPLE_MASK	255u
+#define	BENCH_SENTINEL		UINT64_MAX	///< Sequence number telling a consumer to stop.
+#define	BENCH_MAX_THREADS	8
+
+struct bench_xfer
+{
+	void		*rb;
+	uint64_t	items;		///< Per producer.
+	unsigned	producers;
+	unsigned	consumers;
+	uint64_t	*lat;		///< Sampled latencies (ns).
+	uint64_t	nlat;
+	uint64_t	seq_sum;	///< Sum of the sequence numbers received.
+	uint64_t	errors;		///< Out of order items (single producer only).
+	unsigned	started;
+	unsigned	go;
+};
+
+typedef void	*( *bench_thread_fn )( void *xfer );
+
+/** Run `producers` `producer` and `consumers` `consumer` threads over `rb` (already initialised).
+ *
+ * Once the producers are done, `sentinel( rb )` is called once per consumer from
+ * the calling thread (then the only producer), to stop them.
+ */
+void	bench_xfer_run ( const char *name, void *rb, unsigned producers, unsigned consumers,
+	bench_thread_fn producer, bench_thread_fn consumer, void ( *sentinel )( void *rb ) );
+
+/// Pin the calling thread to the next cpu and wait for the start signal.
+void	bench_xfer_start ( struct bench_xfer *x );
+
+/// Record the latency of an item stamped `stamp`.
+void	bench_xfer_sample ( struct bench_xfer *x, uint64_t stamp );
+
+/// Back off after a failed put/get: pause first, then yield (so single-cpu runs progress).
+void	bench_backoff ( unsigned *spin );
+
+/** @} */
+
+
+/// Comparison runs on boost::lockfree::spsc_queue (bench_boost.cpp, RINGBUF_BENCH_BOOST builds only).
+void	bench_compare_boost ( void );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/** Producer, consumer and sentinel bodies of backend `ID` moving `ITEM`s.
+ *
+ * The backend provides `bool ID_put( void *rb, const ITEM *it )` and
+ * `bool ID_get( void *rb, ITEM *it )`, preferably `static inline`.
+ */
+#define	BENCH_XFER_THREADS( ID, ITEM )	\
+	static void	*ID ## _producer ( void *arg )	\
+	{	\
+		struct bench_xfer	*x = ( struct bench_xfer * )arg;	\
+		ITEM		it;	\
+		uint64_t	i;	\
+		unsigned	spin = 0;	\
+		\
+		memset( &it, 0, sizeof( it ) );	\
+		bench_xfer_start( x );	\
+		for ( i = 0; i < x->items; ++i )	\
+		{	\
+			it.seq		= i;	\
+			it.stamp	= ( i & BENCH_SAMPLE_MASK ) ? 0 : bench_now_ns();	\
+			while ( !ID ## _put( x->rb, &it ) )	\
+				bench_backoff( &spin );	\
+			spin	= 0;	\
+		}	\
+		return NULL;	\
+	}	\
+	\
+	static void	*ID ## _consumer ( void *arg )	\
+	{	\
+		struct bench_xfer	*x = ( struct bench_xfer * )arg;	\
+		ITEM		it;	\
+		uint64_t	expect = 0, sum = 0;	\
+		unsigned	spin = 0;	\
+		\
+		bench_xfer_start( x );	\
+		for ( ;; )	\
+		{	\
+			if ( !ID ## _get( x->rb, &it ) )	\
+			{ bench_backoff( &spin ); continue; }	\
+			spin	= 0;	\
+			if ( BENCH_SENTINEL == it.seq )	\
+				break;	\
+			if ( 1 == x->producers && it.seq != expect )	\
+				__atomic_add_fetch( &x->errors, 1, __ATOMIC_RELAXED );	\
+			expect	= it.seq + 1;	\
+			sum	+= it.seq;	\
+			if ( it.stamp )	\
+				bench_xfer_sample( x, it.stamp );	\
+		}	\
+		__atomic_add_fetch( &x->seq_sum, sum, __ATOMIC_RELAXED );	\
+		return NULL;	\
+	}	\
+	\
+	static void	ID ## _sentinel ( void *rb )	\
+	{	\
+		ITEM		it;	\
+		unsigned	spin = 0;	\
+		\
+		memset( &it, 0, sizeof( it ) );	\
+		it.seq	= BENCH_SENTINEL;	\
+		while ( !ID ## _put( rb, &it ) )	\
+			bench_backoff( &spin );	\
+	}
+
+/// `bench_xfer_run` of backend `ID` (see BENCH_XFER_THREADS).
+#define	BENCH_XFER_RUN( name, ID, rb, producers, consumers )	\
+	bench_xfer_run( ( name ), ( rb ), ( producers ), ( consumers ),	\
+		ID ## _producer, ID ## _consumer, ID ## _sentinel )
+
+
+#endif	// RING_BUFFER_BENCH_H
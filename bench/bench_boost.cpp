@@ -0,0 +1,65 @@
+/** ring_buffer_bench comparison backend: boost::lockfree::spsc_queue (runtime-sized).
+ *
+ * Same harness and thread bodies as the C backends (bench.h), so the rows are
+ * directly comparable with cross/spsc/ and elem/spsc/.
+ */
+
+
+#include <cstdio>
+
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "bench.h"
+
+
+typedef boost::lockfree::spsc_queue< bench_item16 >	boost_e16_queue;
+typedef boost::lockfree::spsc_queue< bench_item64 >	boost_e64_queue;
+
+#define	BENCH_BOOST_DEF( ID, ITEM )	\
+	static inline bool	boost_ ## ID ## _put ( void *rb, const ITEM *it )	\
+	{ return static_cast< boost_ ## ID ## _queue * >( rb )->push( *it ); }	\
+	\
+	static inline bool	boost_ ## ID ## _get ( void *rb, ITEM *it )	\
+	{ return static_cast< boost_ ## ID ## _queue * >( rb )->pop( *it ); }	\
+	\
+	BENCH_XFER_THREADS( boost_ ## ID, ITEM )
+
+BENCH_BOOST_DEF( e16, bench_item16 )
+BENCH_BOOST_DEF( e64, bench_item64 )
+
+static void	boost_push_pop_loop ( void *arg, uint64_t iters )
+{
+	boost_e16_queue	*q = static_cast< boost_e16_queue * >( arg );
+	bench_item16	v = { 0, 0 };
+
+	for ( ; iters; --iters )
+	{
+		v.seq	= iters;
+		q->push( v );
+		q->pop( v );
+	}
+	bench_sink	= v.seq;
+}
+
+#define	BENCH_BOOST_RUN( ID, LEN )	do {	\
+	boost_ ## ID ## _queue	q_( LEN );	\
+	\
+	BENCH_XFER_RUN( "compare/boost/" #ID "_" #LEN, boost_ ## ID, &q_, 1, 1 );	\
+} while ( 0 )
+
+extern "C" void	bench_compare_boost ( void )
+{
+	{
+		boost_e16_queue	q( 4096 );
+		bench_item16	v = { 0, 0 };
+
+		for ( unsigned i = 0; i < 4096 / 2; ++i )
+			q.push( v );
+		bench_loop( "compare/boost/e16_4096/push_pop", boost_push_pop_loop, &q, 2, 0 );
+	}
+
+	BENCH_BOOST_RUN( e16, 256 );
+	BENCH_BOOST_RUN( e16, 4096 );
+	BENCH_BOOST_RUN( e64, 256 );
+	BENCH_BOOST_RUN( e64, 4096 );
+}
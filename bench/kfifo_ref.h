@@ -0,0 +1,101 @@
+#ifndef	KFIFO_REF_H
+#	define	KFIFO_REF_H
+
+/** User-space port of the Linux kfifo algorithm, as the comparison reference.
+ *
+ * Follows lib/kfifo.c (`__kfifo_in`/`__kfifo_out` for `esize`-byte elements):
+ * free-running `unsigned int` indices, power-of-two size, copies split in two
+ * `memcpy` at the wrap point and the index bumped once per call. The kernel's
+ * smp_wmb()/plain index reads map to a release fence and acquire loads here,
+ * so one producer and one consumer may run concurrently, as with kfifo.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+
+struct kfifo_ref
+{
+	unsigned int	in;
+	unsigned int	out;
+	unsigned int	mask;
+	unsigned int	esize;
+	void		*data;
+};
+
+/// Allocate `size` (power of two) elements of `esize` bytes. Returns 0 or -1.
+static inline int	kfifo_ref_alloc ( struct kfifo_ref *fifo, unsigned int size, unsigned int esize )
+{
+	if ( !size || ( size & ( size - 1 ) ) || !( fifo->data = malloc( ( size_t )size * esize ) ) )
+		return -1;
+
+	fifo->in	= fifo->out = 0;
+	fifo->mask	= size - 1;
+	fifo->esize	= esize;
+
+	return 0;
+}
+
+static inline void	kfifo_ref_free ( struct kfifo_ref *fifo )
+{
+	free( fifo->data );
+	fifo->data	= NULL;
+}
+
+static inline void	kfifo_ref_copy_in ( struct kfifo_ref *fifo, const void *src, unsigned int len, unsigned int off )
+{
+	unsigned int	size = ( fifo->mask + 1 ) * fifo->esize, l;
+
+	off	= ( off & fifo->mask ) * fifo->esize;
+	len	*= fifo->esize;
+	l	= len < size - off ? len : size - off;
+
+	memcpy( ( char * )fifo->data + off, src, l );
+	memcpy( fifo->data, ( const char * )src + l, len - l );
+	__atomic_thread_fence( __ATOMIC_RELEASE );	// smp_wmb(): data before `in`.
+}
+
+static inline void	kfifo_ref_copy_out ( struct kfifo_ref *fifo, void *dst, unsigned int len, unsigned int off )
+{
+	unsigned int	size = ( fifo->mask + 1 ) * fifo->esize, l;
+
+	off	= ( off & fifo->mask ) * fifo->esize;
+	len	*= fifo->esize;
+	l	= len < size - off ? len : size - off;
+
+	memcpy( dst, ( const char * )fifo->data + off, l );
+	memcpy( ( char * )dst + l, fifo->data, len - l );
+	__atomic_thread_fence( __ATOMIC_RELEASE );	// smp_wmb(): data before `out`.
+}
+
+/// Producer: __kfifo_in. Returns elements stored.
+static inline unsigned int	kfifo_ref_in ( struct kfifo_ref *fifo, const void *buf, unsigned int len )
+{
+	unsigned int	l = ( fifo->mask + 1 ) - ( fifo->in - __atomic_load_n( &fifo->out, __ATOMIC_ACQUIRE ) );
+
+	if ( len > l )
+		len	= l;
+
+	kfifo_ref_copy_in( fifo, buf, len, fifo->in );
+	__atomic_store_n( &fifo->in, fifo->in + len, __ATOMIC_RELAXED );
+
+	return len;
+}
+
+/// Consumer: __kfifo_out. Returns elements copied out.
+static inline unsigned int	kfifo_ref_out ( struct kfifo_ref *fifo, void *buf, unsigned int len )
+{
+	unsigned int	l = __atomic_load_n( &fifo->in, __ATOMIC_ACQUIRE ) - fifo->out;
+
+	if ( len > l )
+		len	= l;
+
+	kfifo_ref_copy_out( fifo, buf, len, fifo->out );
+	__atomic_store_n( &fifo->out, fifo->out + len, __ATOMIC_RELAXED );
+
+	return len;
+}
+
+
+#endif	// KFIFO_REF_H
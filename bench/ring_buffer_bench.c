@@ -0,0 +1,714 @@
+/** ring_buffer_bench: microbenchmarks of the generated ring-buffer operations.
+ *
+ * Single-thread groups (ns per operation, see bench_loop):
+ * - elem/:	`_push_front`/`_pop_back` in steady state, `_peek`, and fill/drain
+ *		bursts, on plain and SPSC rings, for 4, 16 and 64-byte elements and
+ *		64 and 4096-element capacities;
+ * - string/:	`_push_string` alone and against an element-wise `_push_front` loop
+ *		(the baseline it replaces), then with `_pop_string`, `_pop_cstring`
+ *		and `_pop_until`;
+ * - bulk/:	`_push_n`/`_pop_n`, `_reserve`/`_commit` and `_peek_span`/`_consume`.
+ *
+ * Threaded groups (throughput and latency percentiles, see bench_xfer_run):
+ * - cross/:	SPSC rings, and MPMC rings with 1 and 2 producers/consumers,
+ *		for 16 and 64-byte items and 256 and 4096-element capacities;
+ * - layout/:	RINGBUF_PACKED against RINGBUF_CACHELINE rings, same code and
+ *		items as cross/, one item per `_push_n`/`_pop_n`;
+ * - compare/:	(`--compare`) the same runs on a kfifo port (kfifo_ref.h) and,
+ *		when built with it, boost::lockfree::spsc_queue.
+ *
+ * \code
+	ring_buffer_bench [--filter TEXT] [--min-time MS] [--items N] [--compare] [--quick] [--list]
+ * \endcode
+ *
+ * Exits non-zero if a threaded run lost, duplicated or reordered items.
+ */
+
+#define	_GNU_SOURCE	// sched_getaffinity(), pthread_setaffinity_np().
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_mpmc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_string.h"
+
+#include "bench.h"
+#include "kfifo_ref.h"
+
+
+struct bench_opt	bench_opt	= { NULL, 200000000ull, 1ull << 22, false, false };
+int			bench_failed;
+volatile uint64_t	bench_sink;
+
+static cpu_set_t	bench_cpus;
+static unsigned		bench_ncpus;
+
+
+// --------------------------------------
+/** Harness. @{ */
+
+uint64_t	bench_now_ns ( void )
+{
+	struct timespec	ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ( uint64_t )ts.tv_sec * 1000000000ull + ( uint64_t )ts.tv_nsec;
+}
+
+bool	bench_selected ( const char *name )
+{
+	return !bench_opt.filter || strstr( name, bench_opt.filter );
+}
+
+void	bench_loop ( const char *name, bench_loop_fn fn, void *arg, unsigned ops, size_t bytes )
+{
+	uint64_t	iters = 16, t;
+	double		ns;
+
+	if ( !bench_selected( name ) )
+		return;
+	if ( bench_opt.list )
+	{
+		puts( name );
+		return;
+	}
+
+	fn( arg, iters );	// Warm up.
+
+	for ( ;; )
+	{
+		t	= bench_now_ns();
+		fn( arg, iters );
+		t	= bench_now_ns() - t;
+		if ( t >= bench_opt.min_ns )
+			break;
+		iters	*= ( t * 16 > bench_opt.min_ns ) ? 2 : 16;
+	}
+
+	ns	= ( double )t / ( ( double )iters * ops );
+	printf( "%-44s %10.2f ns/op %10.2f Mops/s", name, ns, 1e3 / ns );
+	if ( bytes )
+		printf( " %8.2f GB/s", ( double )bytes * iters / t );
+	putchar( '\n' );
+}
+
+/// Cpu of the `k`-th started thread: the allowed ones, in turn.
+static void	bench_pin ( unsigned k )
+{
+	cpu_set_t	set;
+	unsigned	cpu, seen = 0;
+
+	k	%= bench_ncpus;
+	for ( cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+	{
+		if ( !CPU_ISSET( cpu, &bench_cpus ) || seen++ != k )
+			continue;
+
+		CPU_ZERO( &set );
+		CPU_SET( cpu, &set );
+		pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+		return;
+	}
+}
+
+void	bench_xfer_start ( struct bench_xfer *x )
+{
+	unsigned	spin = 0;
+
+	bench_pin( __atomic_fetch_add( &x->started, 1, __ATOMIC_ACQ_REL ) );
+
+	while ( !__atomic_load_n( &x->go, __ATOMIC_ACQUIRE ) )
+		bench_backoff( &spin );
+}
+
+void	bench_xfer_sample ( struct bench_xfer *x, uint64_t stamp )
+{
+	x->lat[ __atomic_fetch_add( &x->nlat, 1, __ATOMIC_RELAXED ) ]	= bench_now_ns() - stamp;
+}
+
+void	bench_backoff ( unsigned *spin )
+{
+	if ( ++*spin < 64 )
+	{
+#if defined( __x86_64__ ) || defined( __i386__ )
+		__builtin_ia32_pause();
+#else
+		__asm__ __volatile__( "" ::: "memory" );
+#endif
+	}
+	else
+		sched_yield();
+}
+
+static int	bench_cmp_u64 ( const void *a, const void *b )
+{
+	uint64_t	x = *( const uint64_t * )a, y = *( const uint64_t * )b;
+
+	return ( x > y ) - ( x < y );
+}
+
+/// `permille` percentile of the `n` sorted samples at `v`.
+static unsigned long long	bench_pct ( const uint64_t *v, uint64_t n, unsigned permille )
+{
+	return n ? v[ ( n - 1 ) * permille / 1000 ] : 0;
+}
+
+void	bench_xfer_run ( const char *name, void *rb, unsigned producers, unsigned consumers,
+	bench_thread_fn producer, bench_thread_fn consumer, void ( *sentinel )( void *rb ) )
+{
+	struct bench_xfer	x;
+	pthread_t	th[ BENCH_MAX_THREADS ];
+	unsigned	i, n = producers + consumers;
+	uint64_t	t, expect;
+	int		err;
+
+	if ( !bench_selected( name ) )
+		return;
+	if ( bench_opt.list )
+	{
+		puts( name );
+		return;
+	}
+
+	memset( &x, 0, sizeof( x ) );
+	x.rb		= rb;
+	x.items		= bench_opt.items / producers;
+	x.producers	= producers;
+	x.consumers	= consumers;
+	x.lat		= malloc( ( x.items / ( BENCH_SAMPLE_MASK + 1 ) + 1 ) * producers * sizeof( *x.lat ) );
+
+	if ( !x.lat || n > BENCH_MAX_THREADS )
+	{
+		fprintf( stderr, "%s: cannot set up the run\n", name );
+		exit( EXIT_FAILURE );
+	}
+
+	for ( i = 0; i < n; ++i )
+		if ( ( err = pthread_create( &th[ i ], NULL, i < consumers ? consumer : producer, &x ) ) )
+		{
+			fprintf( stderr, "%s: pthread_create: %s\n", name, strerror( err ) );
+			exit( EXIT_FAILURE );
+		}
+
+	while ( __atomic_load_n( &x.started, __ATOMIC_ACQUIRE ) < n )
+		sched_yield();
+
+	t	= bench_now_ns();
+	__atomic_store_n( &x.go, 1, __ATOMIC_RELEASE );
+
+	for ( i = consumers; i < n; ++i )
+		pthread_join( th[ i ], NULL );
+	for ( i = 0; i < consumers; ++i )
+		sentinel( rb );		// Producers are done: this thread is the only one left.
+	for ( i = 0; i < consumers; ++i )
+		pthread_join( th[ i ], NULL );
+
+	t	= bench_now_ns() - t;
+
+	expect	= producers * ( x.items * ( x.items - 1 ) / 2 );
+	if ( x.errors || x.seq_sum != expect )
+	{
+		fprintf( stderr, "%s: FAILED: %llu out of order, sequence sum %llu, expected %llu\n", name,
+			( unsigned long long )x.errors, ( unsigned long long )x.seq_sum, ( unsigned long long )expect );
+		bench_failed	= 1;
+	}
+
+	qsort( x.lat, x.nlat, sizeof( *x.lat ), bench_cmp_u64 );
+	printf( "%-44s %10.2f Mops/s   latency ns: p50 %8llu p99 %8llu p99.9 %8llu\n", name,
+		( double )x.items * producers * 1e3 / t,
+		bench_pct( x.lat, x.nlat, 500 ), bench_pct( x.lat, x.nlat, 990 ), bench_pct( x.lat, x.nlat, 999 ) );
+
+	free( x.lat );
+}
+
+/** @} end Harness. */
+
+
+// --------------------------------------
+/** elem/: single-element operations. @{ */
+
+/// Steady-state push/pop pairs, `_peek` over a full ring, and fill/drain bursts.
+#define	BENCH_ELEM_LOOPS( NAME )	\
+	static void	NAME ## _push_pop_loop ( void *arg, uint64_t iters )	\
+	{	\
+		NAME	*rb = ( NAME * )arg;	\
+		DATA_TYPE( NAME )	v;	\
+		\
+		memset( &v, 0, sizeof( v ) );	\
+		for ( ; iters; --iters )	\
+		{	\
+			*( uint8_t * )&v	= ( uint8_t )iters;	\
+			NAME ## _push_front( rb, &v );	\
+			NAME ## _pop_back( rb );	\
+		}	\
+	}	\
+	\
+	static void	NAME ## _peek_loop ( void *arg, uint64_t iters )	\
+	{	\
+		NAME	*rb = ( NAME * )arg;	\
+		uint64_t	sum = 0;	\
+		\
+		for ( ; iters; --iters )	\
+			sum	+= *( uint8_t * )NAME ## _peek( rb, ( index_t )iters & ( BUFFER_LEN( NAME ) - 1 ) );	\
+		bench_sink	= sum;	\
+	}	\
+	\
+	static void	NAME ## _fill_drain_loop ( void *arg, uint64_t iters )	\
+	{	\
+		NAME	*rb = ( NAME * )arg;	\
+		DATA_TYPE( NAME )	v;	\
+		uint64_t	sum = 0;	\
+		size_t	i;	\
+		\
+		memset( &v, 0, sizeof( v ) );	\
+		for ( ; iters; --iters )	\
+		{	\
+			for ( i = 0; i < BUFFER_LEN( NAME ); ++i )	\
+				NAME ## _push_front( rb, &v );	\
+			for ( i = 0; i < BUFFER_LEN( NAME ); ++i )	\
+			{	\
+				sum	+= *( uint8_t * )NAME ## _peek( rb, 0 );	\
+				NAME ## _pop_back( rb );	\
+			}	\
+		}	\
+		bench_sink	= sum;	\
+	}
+
+#define	BENCH_ELEM( NAME, LABEL )	do {	\
+	static NAME	rb_;	\
+	DATA_TYPE( NAME )	v_;	\
+	size_t	i_;	\
+	\
+	memset( &v_, 0, sizeof( v_ ) );	\
+	NAME ## _init( &rb_, NULL );	\
+	for ( i_ = 0; i_ < BUFFER_LEN( NAME ) / 2; ++i_ )	\
+		NAME ## _push_front( &rb_, &v_ );	\
+	bench_loop( "elem/" LABEL "/push_pop", NAME ## _push_pop_loop, &rb_, 2, 0 );	\
+	while ( NAME ## _push_front( &rb_, &v_ ) )	\
+		;	\
+	bench_loop( "elem/" LABEL "/peek", NAME ## _peek_loop, &rb_, 1, 0 );	\
+	NAME ## _init( &rb_, NULL );	\
+	bench_loop( "elem/" LABEL "/fill_drain", NAME ## _fill_drain_loop, &rb_, 2 * BUFFER_LEN( NAME ), 0 );	\
+} while ( 0 )
+
+#define	BENCH_ELEM_RINGS( X )	\
+	X( u32_64,	uint32_t,		64 )	\
+	X( u32_4096,	uint32_t,		4096 )	\
+	X( e16_64,	struct bench_item16,	64 )	\
+	X( e16_4096,	struct bench_item16,	4096 )	\
+	X( e64_64,	struct bench_item64,	64 )	\
+	X( e64_4096,	struct bench_item64,	4096 )
+
+#define	BENCH_ELEM_DEF( ID, TYPE, LEN )	\
+	ringbuffer_type_def( plain_ ## ID, TYPE, LEN );	\
+	ringbuffer_define_all( plain_ ## ID )	\
+	BENCH_ELEM_LOOPS( plain_ ## ID )	\
+	\
+	ringbuffer_spsc_type_def( spsc_ ## ID, TYPE, LEN );	\
+	ringbuffer_spsc_define_all( spsc_ ## ID )	\
+	BENCH_ELEM_LOOPS( spsc_ ## ID )
+
+#define	BENCH_ELEM_RUN( ID, TYPE, LEN )	\
+	BENCH_ELEM( plain_ ## ID, "plain/" #ID );	\
+	BENCH_ELEM( spsc_ ## ID, "spsc/" #ID );
+
+BENCH_ELEM_RINGS( BENCH_ELEM_DEF )
+
+static void	bench_elem ( void )
+{
+	BENCH_ELEM_RINGS( BENCH_ELEM_RUN )
+}
+
+/** @} end elem/. */
+
+
+// --------------------------------------
+/** string/: string pushes and pops. @{ */
+
+ringbuffer_type_def( str, char, 4096 );
+ringbuffer_define_all( str )
+ringbuffer_push_string_def( str )
+ringbuffer_pop_string_def( str )
+ringbuffer_pop_cstring_def( str )
+ringbuffer_pop_until_def( str )
+
+struct bench_str
+{
+	str	rb;
+	size_t	len;
+	char	src[ 1024 ];
+	char	dst[ 1024 + 1 ];
+};
+
+/// The push alone: the consumer side just drops what was pushed (`output` caught up).
+static void	bench_str_push_string_loop ( void *arg, uint64_t iters )
+{
+	struct bench_str	*s = arg;
+
+	for ( ; iters; --iters )
+	{
+		bench_sink	= str_push_string( &s->rb, s->src, s->len );
+		s->rb.output	= s->rb.input;
+	}
+}
+
+/// Baseline: the same string pushed one `_push_front` at a time.
+static void	bench_str_push_front_loop ( void *arg, uint64_t iters )
+{
+	struct bench_str	*s = arg;
+	size_t			i;
+
+	for ( ; iters; --iters )
+	{
+		for ( i = 0; i < s->len && str_push_front( &s->rb, &s->src[ i ] ); ++i )
+			;
+		bench_sink	= i;
+		s->rb.output	= s->rb.input;
+	}
+}
+
+static void	bench_str_pop_string_loop ( void *arg, uint64_t iters )
+{
+	struct bench_str	*s = arg;
+
+	for ( ; iters; --iters )
+	{
+		str_push_string( &s->rb, s->src, s->len );
+		bench_sink	= str_pop_string( &s->rb, s->dst, s->len );
+	}
+}
+
+static void	bench_str_pop_cstring_loop ( void *arg, uint64_t iters )
+{
+	struct bench_str	*s = arg;
+
+	for ( ; iters; --iters )
+	{
+		str_push_string( &s->rb, s->src, s->len );
+		bench_sink	= str_pop_cstring( &s->rb, s->dst, s->len + 1 );
+	}
+}
+
+static void	bench_str_pop_until_loop ( void *arg, uint64_t iters )
+{
+	struct bench_str	*s = arg;
+
+	for ( ; iters; --iters )
+	{
+		str_push_string( &s->rb, s->src, s->len );
+		bench_sink	= str_pop_until( &s->rb, s->dst, s->len + 1, '\n' );
+	}
+}
+
+static void	bench_string ( void )
+{
+	static struct bench_str	s;
+	static const size_t	lens[] = { 16, 256, 1024 };
+	char	name[ 64 ];
+	size_t	i;
+
+	for ( i = 0; i < ARRAY_COUNT( lens ); ++i )
+	{
+		str_init( &s.rb, NULL );
+		s.len	= lens[ i ];
+		memset( s.src, 'x', s.len - 1 );
+		s.src[ s.len - 1 ]	= '\n';
+
+		snprintf( name, sizeof( name ), "string/push_string/%zu", s.len );
+		bench_loop( name, bench_str_push_string_loop, &s, 1, s.len );
+		snprintf( name, sizeof( name ), "string/push_front_loop/%zu", s.len );
+		bench_loop( name, bench_str_push_front_loop, &s, 1, s.len );
+		snprintf( name, sizeof( name ), "string/push_string+pop_string/%zu", s.len );
+		bench_loop( name, bench_str_pop_string_loop, &s, 1, s.len );
+		snprintf( name, sizeof( name ), "string/push_string+pop_cstring/%zu", s.len );
+		bench_loop( name, bench_str_pop_cstring_loop, &s, 1, s.len );
+		snprintf( name, sizeof( name ), "string/push_string+pop_until/%zu", s.len );
+		bench_loop( name, bench_str_pop_until_loop, &s, 1, s.len );
+	}
+}
+
+/** @} end string/. */
+
+
+// --------------------------------------
+/** bulk/: bulk copies and in-place spans, 64 elements at a time. @{ */
+
+#define	BENCH_BULK_N	64
+
+ringbuffer_bulk_define_all( plain_u32_4096 )
+ringbuffer_spsc_bulk_define_all( spsc_u32_4096 )
+
+#define	BENCH_BULK_LOOPS( NAME )	\
+	static void	NAME ## _push_pop_n_loop ( void *arg, uint64_t iters )	\
+	{	\
+		NAME	*rb = ( NAME * )arg;	\
+		uint32_t	buf[ BENCH_BULK_N ] = { 0 };	\
+		\
+		for ( ; iters; --iters )	\
+		{	\
+			NAME ## _push_n( rb, buf, BENCH_BULK_N );	\
+			NAME ## _pop_n( rb, buf, BENCH_BULK_N );	\
+		}	\
+		bench_sink	= buf[ 0 ];	\
+	}	\
+	\
+	static void	NAME ## _span_loop ( void *arg, uint64_t iters )	\
+	{	\
+		NAME	*rb = ( NAME * )arg;	\
+		uint32_t	*p1, *p2;	\
+		size_t	l1, l2, n, i;	\
+		uint64_t	sum = 0;	\
+		\
+		for ( ; iters; --iters )	\
+		{	\
+			n	= NAME ## _reserve( rb, BENCH_BULK_N, &p1, &l1, &p2, &l2 );	\
+			for ( i = 0; i < l1; ++i ) p1[ i ] = ( uint32_t )i;	\
+			for ( i = 0; i < l2; ++i ) p2[ i ] = ( uint32_t )i;	\
+			NAME ## _commit( rb, n );	\
+			n	= NAME ## _peek_span( rb, BENCH_BULK_N, &p1, &l1, &p2, &l2 );	\
+			for ( i = 0; i < l1; ++i ) sum += p1[ i ];	\
+			for ( i = 0; i < l2; ++i ) sum += p2[ i ];	\
+			NAME ## _consume( rb, n );	\
+		}	\
+		bench_sink	= sum;	\
+	}
+
+BENCH_BULK_LOOPS( plain_u32_4096 )
+BENCH_BULK_LOOPS( spsc_u32_4096 )
+
+#define	BENCH_BULK( NAME, LABEL )	do {	\
+	static NAME	rb_;	\
+	\
+	NAME ## _init( &rb_, NULL );	\
+	bench_loop( "bulk/" LABEL "/push_n+pop_n", NAME ## _push_pop_n_loop, &rb_, 2 * BENCH_BULK_N, BENCH_BULK_N * sizeof( uint32_t ) );	\
+	bench_loop( "bulk/" LABEL "/reserve+commit+peek_span+consume", NAME ## _span_loop, &rb_, 2 * BENCH_BULK_N, BENCH_BULK_N * sizeof( uint32_t ) );	\
+} while ( 0 )
+
+static void	bench_bulk ( void )
+{
+	BENCH_BULK( plain_u32_4096, "plain/u32_4096" );
+	BENCH_BULK( spsc_u32_4096, "spsc/u32_4096" );
+}
+
+/** @} end bulk/. */
+
+
+// --------------------------------------
+/** cross/: producer and consumer threads on different cpus. @{ */
+
+#define	BENCH_CROSS_DEF( ID, ITEM, LEN )	\
+	ringbuffer_spsc_type_def( xs_ ## ID, ITEM, LEN );	\
+	ringbuffer_spsc_define_all( xs_ ## ID )	\
+	\
+	static inline bool	xs_ ## ID ## _put ( void *rb, const ITEM *it )	\
+	{ return xs_ ## ID ## _push_front( ( xs_ ## ID * )rb, ( ITEM * )it ); }	\
+	\
+	static inline bool	xs_ ## ID ## _get ( void *rb, ITEM *it )	\
+	{ ITEM *p = xs_ ## ID ## _peek( ( xs_ ## ID * )rb, 0 );	\
+	  if ( !p ) return false;	\
+	  *it = *p;	\
+	  return xs_ ## ID ## _pop_back( ( xs_ ## ID * )rb ); }	\
+	\
+	BENCH_XFER_THREADS( xs_ ## ID, ITEM )	\
+	\
+	ringbuffer_mpmc_type_def( xm_ ## ID, ITEM, LEN );	\
+	ringbuffer_mpmc_define_all( xm_ ## ID )	\
+	\
+	static inline bool	xm_ ## ID ## _put ( void *rb, const ITEM *it )	\
+	{ return xm_ ## ID ## _push_front( ( xm_ ## ID * )rb, ( ITEM * )it ); }	\
+	\
+	static inline bool	xm_ ## ID ## _get ( void *rb, ITEM *it )	\
+	{ return xm_ ## ID ## _pop_back( ( xm_ ## ID * )rb, it ); }	\
+	\
+	BENCH_XFER_THREADS( xm_ ## ID, ITEM )
+
+#define	BENCH_CROSS( ID )	do {	\
+	static xs_ ## ID	s_;	\
+	static xm_ ## ID	m_;	\
+	\
+	xs_ ## ID ## _init( &s_, NULL );	\
+	BENCH_XFER_RUN( "cross/spsc/" #ID, xs_ ## ID, &s_, 1, 1 );	\
+	xm_ ## ID ## _init( &m_ );	\
+	BENCH_XFER_RUN( "cross/mpmc_1x1/" #ID, xm_ ## ID, &m_, 1, 1 );	\
+	xm_ ## ID ## _init( &m_ );	\
+	BENCH_XFER_RUN( "cross/mpmc_2x2/" #ID, xm_ ## ID, &m_, 2, 2 );	\
+} while ( 0 )
+
+#define	BENCH_CROSS_RUN( ID, ITEM, LEN )	\
+	BENCH_CROSS( ID );
+
+#define	BENCH_CROSS_RINGS( X )	\
+	X( e16_256,	struct bench_item16,	256 )	\
+	X( e16_4096,	struct bench_item16,	4096 )	\
+	X( e64_256,	struct bench_item64,	256 )	\
+	X( e64_4096,	struct bench_item64,	4096 )
+
+BENCH_CROSS_RINGS( BENCH_CROSS_DEF )
+
+static void	bench_cross ( void )
+{
+	BENCH_CROSS_RINGS( BENCH_CROSS_RUN )
+}
+
+/** @} end cross/. */
+
+
+// --------------------------------------
+/** layout/: RINGBUF_PACKED against RINGBUF_CACHELINE, producer and consumer on different cpus.
+ *
+ * Both rings run the very same code, the generic `_push_n`/`_pop_n` (acquire/
+ * release on either layout) one item at a time: only the placement of `input`,
+ * `output` and the callbacks differs, so the gap between layout/packed/ and
+ * layout/cacheline/ is the cost of the shared index line. cross/spsc/ adds the
+ * cached remote indices (RINGBUF_SPSC_CACHED) on top.
+ * @{ */
+
+#define	BENCH_LAYOUT_DEF( ID, ITEM, LEN, LAYOUT, TAG )		ringbuffer_type_def_ex( xl_ ## TAG ## _ ## ID, ITEM, LEN, LAYOUT, index_t );		ringbuffer_init_def( xl_ ## TAG ## _ ## ID )		ringbuffer_push_n_def( xl_ ## TAG ## _ ## ID )		ringbuffer_pop_n_def( xl_ ## TAG ## _ ## ID )			static inline bool	xl_ ## TAG ## _ ## ID ## _put ( void *rb, const ITEM *it )		{ return xl_ ## TAG ## _ ## ID ## _push_n( ( xl_ ## TAG ## _ ## ID * )rb, it, 1 ); }			static inline bool	xl_ ## TAG ## _ ## ID ## _get ( void *rb, ITEM *it )		{ return xl_ ## TAG ## _ ## ID ## _pop_n( ( xl_ ## TAG ## _ ## ID * )rb, it, 1 ); }			BENCH_XFER_THREADS( xl_ ## TAG ## _ ## ID, ITEM )
+
+#define	BENCH_LAYOUT_DEFS( ID, ITEM, LEN )		BENCH_LAYOUT_DEF( ID, ITEM, LEN, RINGBUF_PACKED, packed )		BENCH_LAYOUT_DEF( ID, ITEM, LEN, RINGBUF_CACHELINE, cacheline )
+
+#define	BENCH_LAYOUT_RUN( ID, ITEM, LEN )	do {		static xl_packed_ ## ID		p_;		static xl_cacheline_ ## ID	c_;			xl_packed_ ## ID ## _init( &p_, NULL );		BENCH_XFER_RUN( "layout/packed/" #ID, xl_packed_ ## ID, &p_, 1, 1 );		xl_cacheline_ ## ID ## _init( &c_, NULL );		BENCH_XFER_RUN( "layout/cacheline/" #ID, xl_cacheline_ ## ID, &c_, 1, 1 );	} while ( 0 );
+
+BENCH_CROSS_RINGS( BENCH_LAYOUT_DEFS )
+
+static void	bench_layout ( void )
+{
+	BENCH_CROSS_RINGS( BENCH_LAYOUT_RUN )
+}
+
+/** @} end layout/. */
+
+
+// --------------------------------------
+/** compare/: reference implementations, same loops. @{ */
+
+#define	BENCH_KFIFO_DEF( ID, ITEM )	\
+	static inline bool	kfifo_ ## ID ## _put ( void *rb, const ITEM *it )	\
+	{ return 1 == kfifo_ref_in( ( struct kfifo_ref * )rb, it, 1 ); }	\
+	\
+	static inline bool	kfifo_ ## ID ## _get ( void *rb, ITEM *it )	\
+	{ return 1 == kfifo_ref_out( ( struct kfifo_ref * )rb, it, 1 ); }	\
+	\
+	BENCH_XFER_THREADS( kfifo_ ## ID, ITEM )
+
+BENCH_KFIFO_DEF( e16, struct bench_item16 )
+BENCH_KFIFO_DEF( e64, struct bench_item64 )
+
+static void	bench_kfifo_push_pop_loop ( void *arg, uint64_t iters )
+{
+	struct kfifo_ref	*f = arg;
+	struct bench_item16	v = { 0, 0 };
+
+	for ( ; iters; --iters )
+	{
+		v.seq	= iters;
+		kfifo_ref_in( f, &v, 1 );
+		kfifo_ref_out( f, &v, 1 );
+	}
+	bench_sink	= v.seq;
+}
+
+#define	BENCH_KFIFO_RUN( ID, ITEM, LEN )	do {	\
+	struct kfifo_ref	f_;	\
+	\
+	if ( kfifo_ref_alloc( &f_, LEN, sizeof( ITEM ) ) )	\
+		break;	\
+	BENCH_XFER_RUN( "compare/kfifo/" #ID "_" #LEN, kfifo_ ## ID, &f_, 1, 1 );	\
+	kfifo_ref_free( &f_ );	\
+} while ( 0 )
+
+static void	bench_compare ( void )
+{
+	struct kfifo_ref	f;
+	struct bench_item16	v = { 0, 0 };
+	unsigned int	i;
+
+	if ( !kfifo_ref_alloc( &f, 4096, sizeof( v ) ) )
+	{
+		for ( i = 0; i < 4096 / 2; ++i )
+			kfifo_ref_in( &f, &v, 1 );
+		bench_loop( "compare/kfifo/e16_4096/push_pop", bench_kfifo_push_pop_loop, &f, 2, 0 );
+		kfifo_ref_free( &f );
+	}
+
+	BENCH_KFIFO_RUN( e16, struct bench_item16, 256 );
+	BENCH_KFIFO_RUN( e16, struct bench_item16, 4096 );
+	BENCH_KFIFO_RUN( e64, struct bench_item64, 256 );
+	BENCH_KFIFO_RUN( e64, struct bench_item64, 4096 );
+
+#ifdef	RINGBUF_BENCH_BOOST
+	bench_compare_boost();
+#endif
+}
+
+/** @} end compare/. */
+
+
+// --------------------------------------
+static void	usage ( const char *argv0 )
+{
+	fprintf( stderr, "usage: %s [--filter TEXT] [--min-time MS] [--items N] [--compare] [--quick] [--list]\n", argv0 );
+	exit( EXIT_FAILURE );
+}
+
+int	main ( int argc, char *argv[] )
+{
+	int	i;
+
+	for ( i = 1; i < argc; ++i )
+	{
+		if ( !strcmp( argv[ i ], "--filter" ) && i + 1 < argc )
+			bench_opt.filter	= argv[ ++i ];
+		else if ( !strcmp( argv[ i ], "--min-time" ) && i + 1 < argc )
+			bench_opt.min_ns	= strtoull( argv[ ++i ], NULL, 0 ) * 1000000ull;
+		else if ( !strcmp( argv[ i ], "--items" ) && i + 1 < argc )
+			bench_opt.items		= strtoull( argv[ ++i ], NULL, 0 );
+		else if ( !strcmp( argv[ i ], "--compare" ) )
+			bench_opt.compare	= true;
+		else if ( !strcmp( argv[ i ], "--quick" ) )	// Smoke run (ctest).
+		{
+			bench_opt.min_ns	= 2000000ull;
+			bench_opt.items		= 1ull << 15;
+		}
+		else if ( !strcmp( argv[ i ], "--list" ) )
+			bench_opt.list		= true;
+		else
+			usage( argv[ 0 ] );
+	}
+
+	if ( bench_opt.items < 2 )
+		usage( argv[ 0 ] );
+
+	if ( sched_getaffinity( 0, sizeof( bench_cpus ), &bench_cpus ) || !( bench_ncpus = CPU_COUNT( &bench_cpus ) ) )
+	{
+		CPU_ZERO( &bench_cpus );
+		CPU_SET( 0, &bench_cpus );
+		bench_ncpus	= 1;
+	}
+
+	if ( !bench_opt.list )
+	{
+		printf( "# ring_buffer_bench: %u cpu(s), min time %llu ms, %llu items per threaded run\n", bench_ncpus,
+			( unsigned long long )( bench_opt.min_ns / 1000000ull ), ( unsigned long long )bench_opt.items );
+		if ( bench_ncpus < 2 )
+			printf( "# single cpu: threaded runs share it, they are not cross-core\n" );
+	}
+
+	bench_elem();
+	bench_string();
+	bench_bulk();
+	bench_cross();
+	bench_layout();
+	if ( bench_opt.compare )
+		bench_compare();
+
+	return bench_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
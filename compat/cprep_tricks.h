@@ -0,0 +1,21 @@
+#ifndef	CPREP_TRICKS_H
+#	define	CPREP_TRICKS_H
+
+/** Minimal stand-in for the project-wide cprep_tricks.h, so the tests and benchmarks
+ * in this tree build on their own (see RINGBUF_COMPAT_DIR in CMakeLists.txt).
+ * Only what ring_buffer*.h use.
+ */
+
+#define	CPT_CAT_( a, b )	a ## b
+#define	CPT_CAT( a, b )		CPT_CAT_( a, b )
+
+/// First argument (or nothing).
+#define	EFIRST( ... )		EFIRST_( __VA_ARGS__, )
+#define	EFIRST_( a, ... )	a
+
+/// `TEST( x )( then, else )`: `then` if `x` is not empty, `else` otherwise.
+#define	TEST( ... )		CPT_CAT( TEST_, __VA_OPT__( 1 ) )
+#define	TEST_1( a, ... )	a
+#define	TEST_( a, ... )		__VA_ARGS__
+
+#endif	// CPREP_TRICKS_H
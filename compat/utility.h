@@ -0,0 +1,13 @@
+#ifndef	UTILITY_H
+#	define	UTILITY_H
+
+/** Minimal stand-in for the project-wide utility.h, so the tests and benchmarks
+ * in this tree build on their own (see RINGBUF_COMPAT_DIR in CMakeLists.txt).
+ * Only what ring_buffer*.h use.
+ */
+
+#ifndef	ARRAY_COUNT
+#	define	ARRAY_COUNT( a )	( sizeof( a ) / sizeof( ( a )[ 0 ] ) )
+#endif
+
+#endif	// UTILITY_H
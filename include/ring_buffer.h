@@ -26,6 +26,23 @@
  * 	Use `ringbuffer_define_all( NAME )` in your source file (.c) to
  * 	\b define all your functions at once exactly as done in a).
  *
+ * c) For ring-buffers whose functions should be inlined into every caller
+ * 	(e.g. hot ISR loops), put
+ * 	`ringbuffer_type_def( NAME, TYPE, LEN )` and `ringbuffer_define_all_inline( NAME )`
+ * 	in your header file (.h) instead: every function is emitted `static inline`,
+ * 	and `_count`, `_empty` and `_full` are forced inline.
+ *
+ * d) To choose the control structure layout (e.g. `RINGBUF_CACHELINE` to keep
+ * 	producer and consumer indices on separate cache lines) or the index width
+ * 	(e.g. `uint8_t` for small rings, `uint64_t` for never-overflowing ones),
+ * 	use the `_ex` forms:
+ * 	`ringbuffer_declare_all_ex( NAME, TYPE, LEN, LAYOUT, INDEX )` or
+ * 	`ringbuffer_type_def_ex( NAME, TYPE, LEN, LAYOUT, INDEX )`.
+ *
+ * e) Define `RINGBUF_STATS` (build-wide) to add instrumentation counters to every
+ * 	control structure (see Instrumentation counters); `_stats_snapshot` reads them.
+ * 	Define `RINGBUF_DEBUG` to check caller-supplied counts (see Debug checks).
+ *
  * This macros will create a typedef'd control structure like in the example below:
  *
  * \code
@@ -35,6 +52,7 @@
 	struct ring_buffer_peanuts;
 
 	typedef bool	( * peanuts_push_callback_t ) ( struct ring_buffer_peanuts *rb, int data );
+	typedef void	( * peanuts_push_batch_callback_t ) ( struct ring_buffer_peanuts *rb, int *first, size_t n );
 
 	typedef struct ring_buffer_peanuts
 	{
@@ -42,6 +60,7 @@
 		index_t output;
 		int data_buffer[ 8 ];
 		peanuts_push_callback_t push_callback;
+		peanuts_push_batch_callback_t push_batch_callback;
 	} peanuts;
  * \endcode
  *
@@ -55,6 +74,7 @@
 	size_t	peanuts_count ( peanuts *rb );
 	bool	peanuts_empty ( peanuts *rb );
 	bool	peanuts_full ( peanuts *rb );
+	void	peanuts_stats_snapshot ( peanuts *rb, struct ring_buffer_stats *stats );
  * \endcode
  *
  * \addtogroup PushCallback	Push Callback Function
@@ -72,11 +92,10 @@ bool	peanuts_push_front_callback ( peanuts *rb, TYPE data )
  *
  */
 
-// TODO: Consider `static` ring buffer functions.
-
-
 #ifdef __KERNEL__
 #	include <linux/types.h>
+#	include <asm/barrier.h>
+#	include <linux/cache.h>
 #else
 #	include <stdint.h>
 #	include <stddef.h>
@@ -87,6 +106,7 @@ bool	peanuts_push_front_callback ( peanuts *rb, TYPE data )
 #include "cprep_tricks.h"
 
 
+/// Default index type. Each ring-buffer may pick its own (see ringbuffer_type_def_ex).
 typedef	uint32_t	index_t;
 
 
@@ -98,11 +118,36 @@ typedef	uint32_t	index_t;
 
 // --------------------------------------
 
+/// Don't use. Runtime storage descriptor: first member of runtime-sized control structures (see ring_buffer_dynamic.h).
+struct ring_buffer_storage
+{
+	size_t	mask;
+	size_t	linear;		///< Elements addressable from data_buffer[ 0 ] (2x capacity when mirrored).
+};
+
+/// Don't use. Storage descriptor of `rb`; a function so the (discarded) fixed-size branches don't trip -Wstrict-aliasing.
+static inline const struct ring_buffer_storage	*ring_buffer_storage_ ( const volatile void *rb )
+{
+	return ( const struct ring_buffer_storage * )rb;
+}
+
+/// True if `rb` is a runtime-sized ring-buffer (`data_buffer` is a pointer, not an array).
+#define	RINGBUF_IS_DYNAMIC( rb )	\
+	__builtin_types_compatible_p( typeof( ( rb )->data_buffer ), typeof( &( rb )->data_buffer[ 0 ] ) )
+
+/** Index mask: compile-time constant for fixed-size ring-buffers, runtime `mask` otherwise.
+ *
+ * \note	The `+ 0` keeps -Wsizeof-pointer-div quiet on the (discarded) array branch of dynamic rings.
+ */
+#define	RINGBUF_MASK( rb )	__builtin_choose_expr( RINGBUF_IS_DYNAMIC( rb ),	\
+	ring_buffer_storage_( rb )->mask,	\
+	( ( sizeof( ( rb )->data_buffer ) + 0 ) / sizeof( ( rb )->data_buffer[ 0 ] ) - 1 ) )
+
 /** Limits index inside buffer bounds wrapping if needed.
  *
  * \note Buffer lenght \b must be power of two!
  */
-#define RINGBUF_WRAP( rb, index )	( ( index ) & ( ARRAY_COUNT( ( rb )->data_buffer ) - 1 ) )
+#define RINGBUF_WRAP( rb, index )	( ( index ) & RINGBUF_MASK( rb ) )
 
 /// Shortcut to current input position.
 #define RINGBUF_CURR_i( rb )		( rb )->data_buffer[ RINGBUF_WRAP ( ( rb ), ( rb )->input ) ]
@@ -115,16 +160,221 @@ typedef	uint32_t	index_t;
 /// Shortcut to current output position.
 #define RINGBUF_CURR_o( rb, ... )	RINGBUF_CURR_o_( ( rb ), EFIRST( __VA_ARGS__ ) )
 
+/// Get buffer element capacity from a control structure pointer (fixed-size or runtime-sized).
+#define	RINGBUF_CAPACITY( rb )		( RINGBUF_MASK( rb ) + 1 )
+
+/// Elements linearly addressable from data_buffer[ 0 ]: the capacity, or twice that for mirrored rings.
+#define	RINGBUF_LINEAR( rb )	__builtin_choose_expr( RINGBUF_IS_DYNAMIC( rb ),	\
+	ring_buffer_storage_( rb )->linear, RINGBUF_CAPACITY( rb ) )
+
+/// Contiguous elements from `index` up to the physical end of data_buffer (the wrap point).
+#define	RINGBUF_TO_END( rb, index )	( RINGBUF_LINEAR( rb ) - RINGBUF_WRAP( ( rb ), ( index ) ) )
+
+/** Compile-time check of `LEN`: non-zero power of two, and at most half the `INDEX` range. */
+#define	RINGBUF_LEN_ASSERT( NAME, LEN, INDEX )	\
+	_Static_assert( ( LEN ) && !( ( LEN ) & ( ( LEN ) - 1 ) ),	\
+		"ring buffer " #NAME ": LEN must be a power of two" );	\
+	_Static_assert( ( unsigned long long )( LEN ) - 1 <= ( ( unsigned long long )( INDEX )~( INDEX )0 >> 1 ),	\
+		"ring buffer " #NAME ": LEN too large for its index type" )
+
 /// Get buffer intrinsic element type.
 #define DATA_TYPE( NAME )	typeof( ( ( NAME * )0 )->data_buffer[ 0 ] )
 
-/// Get buffer element capacity.
+/// Get buffer element capacity (fixed-size ring-buffers only; see RINGBUF_CAPACITY).
 #define	BUFFER_LEN( NAME )	ARRAY_COUNT( ( ( NAME * )0 )->data_buffer )
 
 
 /** @} end Ring buffer helpers. */
 
 
+/** Index publication helpers.
+ *
+ * Used by the concurrent variants (see ring_buffer_spsc.h, ring_buffer_mpmc.h)
+ * to order the element accesses against the index each side hands over to the other.
+ * @{ */
+
+#ifdef __KERNEL__
+#	define	RINGBUF_LOAD_ACQUIRE( ptr )		smp_load_acquire( ptr )
+#	define	RINGBUF_STORE_RELEASE( ptr, val )	smp_store_release( ( ptr ), ( val ) )
+#	define	RINGBUF_LOAD_RELAXED( ptr )		READ_ONCE( *( ptr ) )
+#	define	RINGBUF_STORE_RELAXED( ptr, val )	WRITE_ONCE( *( ptr ), ( val ) )
+#	define	RINGBUF_CAS_RELAXED( ptr, oldp, val )	try_cmpxchg_relaxed( ( ptr ), ( oldp ), ( val ) )
+#	define	RINGBUF_READ_FENCE()			smp_rmb()
+#	define	RINGBUF_WRITE_FENCE()			smp_wmb()
+#else
+#	define	RINGBUF_LOAD_ACQUIRE( ptr )		__atomic_load_n( ( ptr ), __ATOMIC_ACQUIRE )
+#	define	RINGBUF_STORE_RELEASE( ptr, val )	__atomic_store_n( ( ptr ), ( val ), __ATOMIC_RELEASE )
+#	define	RINGBUF_LOAD_RELAXED( ptr )		__atomic_load_n( ( ptr ), __ATOMIC_RELAXED )
+#	define	RINGBUF_STORE_RELAXED( ptr, val )	__atomic_store_n( ( ptr ), ( val ), __ATOMIC_RELAXED )
+/// Weak compare-and-swap: on failure `*oldp` is updated with the current value.
+#	define	RINGBUF_CAS_RELAXED( ptr, oldp, val )	\
+		__atomic_compare_exchange_n( ( ptr ), ( oldp ), ( val ), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED )
+/// Orders the element reads before a following index re-check (seqlock-style readers).
+#	define	RINGBUF_READ_FENCE()			__atomic_thread_fence( __ATOMIC_ACQUIRE )
+/// Orders a previous index publication before following element writes (seqlock-style writers).
+#	define	RINGBUF_WRITE_FENCE()			__atomic_thread_fence( __ATOMIC_RELEASE )
+#endif
+
+/** @} end Index publication helpers. */
+
+
+/** Instrumentation counters.
+ *
+ * Opt-in: define `RINGBUF_STATS` before including any ring_buffer*.h header,
+ * otherwise the counters and every update are compiled out.
+ *
+ * Each side only writes its own block, kept next to its own index (so on the
+ * cache line it already owns in the RINGBUF_CACHELINE/RINGBUF_SPSC_CACHED layouts):
+ * `stats_in` by the producer, `stats_out` by the consumer. Updates are relaxed
+ * single-writer stores; `_stats_snapshot` may run anywhere, and is a snapshot.
+ *
+ * \note	Counters are in elements (records on ring_buffer_record.h rings). `high_water`
+ * 	is the highest `_count()` seen by the producer right after a push (SPSC: against
+ * 	its cached `output`, so an upper bound). Not available for MPMC ring-buffers.
+ * \note	Blocking wrappers keep their timeouts in the wait state (ring_buffer_wait.h).
+ * @{ */
+
+/// Counter type (e.g. `uint32_t` on targets without 64-bit atomic accesses).
+#ifndef	RINGBUF_STATS_TYPE
+#	define	RINGBUF_STATS_TYPE	uint64_t
+#endif
+
+typedef	RINGBUF_STATS_TYPE	ringbuf_stat_t;
+
+/// Snapshot exported by `_stats_snapshot` (all zero without `RINGBUF_STATS`).
+struct ring_buffer_stats
+{
+	ringbuf_stat_t	pushes;		///< Elements pushed.
+	ringbuf_stat_t	pops;		///< Elements popped.
+	ringbuf_stat_t	rejected_pushes;	///< Elements refused: full (or push_callback refused).
+	ringbuf_stat_t	empty_polls;	///< Pops attempted on an empty ring-buffer.
+	ringbuf_stat_t	high_water;	///< Highest fill level seen.
+	ringbuf_stat_t	overwritten;	///< Elements dropped by overwriting pushes (ring_buffer_overwrite.h).
+};
+
+#ifdef	RINGBUF_STATS
+
+/// Producer side counters.
+struct ring_buffer_stats_in
+{
+	ringbuf_stat_t	pushes, rejected_pushes, high_water, overwritten;
+};
+
+/// Consumer side counters.
+struct ring_buffer_stats_out
+{
+	ringbuf_stat_t	pops, empty_polls;
+};
+
+#	define	RINGBUF_STATS_IN_FIELDS		struct ring_buffer_stats_in	stats_in;
+#	define	RINGBUF_STATS_OUT_FIELDS	struct ring_buffer_stats_out	stats_out;
+
+/// Add `n` to producer counter `field`.
+#	define	RINGBUF_STAT_IN( rb, field, n )	\
+		RINGBUF_STORE_RELAXED( &( rb )->stats_in.field, ( rb )->stats_in.field + ( n ) )
+/// Add `n` to consumer counter `field`.
+#	define	RINGBUF_STAT_OUT( rb, field, n )	\
+		RINGBUF_STORE_RELAXED( &( rb )->stats_out.field, ( rb )->stats_out.field + ( n ) )
+/// Record fill level `count` for the high-water mark.
+#	define	RINGBUF_STAT_LEVEL( rb, count )	do {	\
+		if ( ( ringbuf_stat_t )( count ) > ( rb )->stats_in.high_water )	\
+			RINGBUF_STORE_RELAXED( &( rb )->stats_in.high_water, ( ringbuf_stat_t )( count ) ); } while ( 0 )
+/// Zero all counters.
+#	define	RINGBUF_STATS_RESET( rb )	do {	\
+		( rb )->stats_in	= ( struct ring_buffer_stats_in ){ 0 };	\
+		( rb )->stats_out	= ( struct ring_buffer_stats_out ){ 0 }; } while ( 0 )
+/// Don't use. Fill snapshot `s` from `rb`.
+#	define	RINGBUF_STATS_READ_( rb, s )	do {	\
+		( s )->pushes		= RINGBUF_LOAD_RELAXED( &( rb )->stats_in.pushes );	\
+		( s )->rejected_pushes	= RINGBUF_LOAD_RELAXED( &( rb )->stats_in.rejected_pushes );	\
+		( s )->high_water	= RINGBUF_LOAD_RELAXED( &( rb )->stats_in.high_water );	\
+		( s )->overwritten	= RINGBUF_LOAD_RELAXED( &( rb )->stats_in.overwritten );	\
+		( s )->pops		= RINGBUF_LOAD_RELAXED( &( rb )->stats_out.pops );	\
+		( s )->empty_polls	= RINGBUF_LOAD_RELAXED( &( rb )->stats_out.empty_polls ); } while ( 0 )
+
+#else
+
+#	define	RINGBUF_STATS_IN_FIELDS
+#	define	RINGBUF_STATS_OUT_FIELDS
+#	define	RINGBUF_STAT_IN( rb, field, n )		do { } while ( 0 )
+#	define	RINGBUF_STAT_OUT( rb, field, n )	do { } while ( 0 )
+#	define	RINGBUF_STAT_LEVEL( rb, count )		do { } while ( 0 )
+#	define	RINGBUF_STATS_RESET( rb )		do { } while ( 0 )
+#	define	RINGBUF_STATS_READ_( rb, s )	\
+		( *( s ) = ( struct ring_buffer_stats ){ 0 } )
+
+#endif
+
+/** @} end Instrumentation counters. */
+
+
+/** Debug checks.
+ *
+ * Opt-in: define `RINGBUF_DEBUG` to check counts handed in by the caller against
+ * the ring-buffer state (e.g. `_commit`/`_consume` of more than `_reserve`/`_peek_span`
+ * can have returned), so misuse of the fast paths is reported where it happens
+ * instead of silently corrupting the indices: `assert` in user space,
+ * `WARN_ON_ONCE` under `__KERNEL__`. Otherwise checks are compiled out.
+ * @{ */
+
+#ifdef	RINGBUF_DEBUG
+#	ifdef __KERNEL__
+#		include <linux/bug.h>
+#		define	RINGBUF_CHECK( cond )	WARN_ON_ONCE( !( cond ) )
+#	else
+#		include <assert.h>
+#		define	RINGBUF_CHECK( cond )	assert( cond )
+#	endif
+#else
+#	define	RINGBUF_CHECK( cond )	do { } while ( 0 )
+#endif
+
+/** @} end Debug checks. */
+
+
+/** Control structure layouts.
+ *
+ * Passed as `LAYOUT` to `ringbuffer_type_def_ex`/`ringbuffer_declare_all_ex`.
+ * Every layout provides the same fields, so all function macros work on any of them.
+ * @{ */
+
+#ifndef	RINGBUF_CACHELINE_SIZE
+#	ifdef __KERNEL__
+#		define	RINGBUF_CACHELINE_SIZE	SMP_CACHE_BYTES
+#	else
+#		define	RINGBUF_CACHELINE_SIZE	64
+#	endif
+#endif
+
+#define	RINGBUF_CACHELINE_ALIGNED	__attribute__( ( aligned( RINGBUF_CACHELINE_SIZE ) ) )
+
+/// Default layout: everything packed together (smallest footprint).
+#define	RINGBUF_PACKED( NAME, TYPE, LEN )	\
+		NAME ## _index_t	input;			\
+		NAME ## _index_t	output;			\
+		TYPE	data_buffer[ LEN ];	\
+		NAME ## _push_callback_t	push_callback;	\
+		NAME ## _push_batch_callback_t	push_batch_callback;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		RINGBUF_STATS_OUT_FIELDS
+
+/** Producer fields, consumer fields and data each on their own cache line(s).
+ *
+ * Avoids false sharing when producer and consumer run on different cores
+ * (ring_buffer_bench `--filter layout/` measures it against RINGBUF_PACKED).
+ */
+#define	RINGBUF_CACHELINE( NAME, TYPE, LEN )	\
+		NAME ## _index_t	input	RINGBUF_CACHELINE_ALIGNED;	\
+		NAME ## _push_callback_t	push_callback;	\
+		NAME ## _push_batch_callback_t	push_batch_callback;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		NAME ## _index_t	output	RINGBUF_CACHELINE_ALIGNED;	\
+		RINGBUF_STATS_OUT_FIELDS	\
+		TYPE	data_buffer[ LEN ]	RINGBUF_CACHELINE_ALIGNED;
+
+/** @} end Control structure layouts. */
+
+
 // --------------------------------------
 /** Define ring buffer control structure.
  *
@@ -134,17 +384,32 @@ typedef	uint32_t	index_t;
  * 			This buffer must be allocated outside
  * 			with the actual data type.
  * \var push_callback	Custom action to perform on element insertion.
+ * \var push_batch_callback	Custom action on each contiguous segment written by
+ * 			bulk pushes (see ring_buffer_bulk.h). Set to NULL by `_init`.
+ * \var stats_in, stats_out	Instrumentation counters (`RINGBUF_STATS` only).
  */
 #define ringbuffer_type_def( NAME, TYPE, LEN, ... )	\
+	ringbuffer_type_def_ex( NAME, TYPE, LEN, RINGBUF_PACKED, index_t, __VA_ARGS__ )
+
+/** Define ring buffer control structure with a given `LAYOUT` (e.g. RINGBUF_CACHELINE)
+ * and `INDEX` type (`uint8_t`, `uint16_t`, `uint32_t` or `uint64_t`).
+ *
+ * Indices are free-running and wrap around naturally, so `LEN` must leave room
+ * for a full count: at most half the `INDEX` range (e.g. 128 for `uint8_t`).
+ * Both rules are checked at compile time.
+ */
+#define ringbuffer_type_def_ex( NAME, TYPE, LEN, LAYOUT, INDEX, ... )	\
+	RINGBUF_LEN_ASSERT( NAME, LEN, INDEX );	\
+	\
 	typedef struct ring_buffer_ ## NAME NAME;	\
+	typedef INDEX NAME ## _index_t;	\
 	typedef bool ( * NAME ## _push_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb, TYPE *data );	\
+	typedef void ( * NAME ## _push_batch_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) TYPE *first, size_t n );	\
 	\
 	struct ring_buffer_ ## NAME	\
 	{					\
-		index_t	input;			\
-		index_t	output;			\
-		TYPE	data_buffer[ LEN ];	\
-		NAME ## _push_callback_t	push_callback;	\
+		LAYOUT( NAME, TYPE, LEN )	\
 	}
 
 
@@ -171,9 +436,16 @@ typedef	uint32_t	index_t;
 #define	ringbuffer_full_decl( NAME, ... )	\
 	bool	NAME ## _full ( DECL_qualif( __VA_ARGS__ ) NAME *rb )
 
+/** Copy the instrumentation counters into `stats` (zeros without `RINGBUF_STATS`). */
+#define	ringbuffer_stats_snapshot_decl( NAME, ... )	\
+	void	NAME ## _stats_snapshot ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct ring_buffer_stats *stats )
+
 // --------------------------------------
 #define ringbuffer_declare_all( NAME, TYPE, LEN, ... )	\
-	ringbuffer_type_def( NAME, TYPE, LEN, __VA_ARGS__ );	\
+	ringbuffer_declare_all_ex( NAME, TYPE, LEN, RINGBUF_PACKED, index_t, __VA_ARGS__ )
+
+#define ringbuffer_declare_all_ex( NAME, TYPE, LEN, LAYOUT, INDEX, ... )	\
+	ringbuffer_type_def_ex( NAME, TYPE, LEN, LAYOUT, INDEX, __VA_ARGS__ );	\
 	\
 	ringbuffer_init_decl( NAME, __VA_ARGS__ );	\
 	\
@@ -187,7 +459,9 @@ typedef	uint32_t	index_t;
 	\
 	ringbuffer_pop_back_decl( NAME, __VA_ARGS__ );	\
 	\
-	ringbuffer_peek_decl( NAME, __VA_ARGS__ )
+	ringbuffer_peek_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_stats_snapshot_decl( NAME, __VA_ARGS__ )
 
 // --------------------------------------
 
@@ -201,20 +475,29 @@ typedef	uint32_t	index_t;
 #define	ringbuffer_init_def( NAME, ... )	\
 	void	NAME ## _init( DECL_qualif( __VA_ARGS__ ) NAME *rb, NAME ## _push_callback_t push_callback )	{\
 		rb->input = rb->output	= 0;	\
-		rb->push_callback	= push_callback; }
+		rb->push_callback	= push_callback;	\
+		rb->push_batch_callback	= NULL;	\
+		RINGBUF_STATS_RESET( rb ); }
 
 #define	ringbuffer_push_front_def( NAME, ... )	\
 	bool	NAME ## _push_front ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )	{\
-		if ( NAME ## _full( rb ) ) return false;	\
+		if ( NAME ## _full( rb ) )	\
+		{ RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; }	\
 		if ( rb->push_callback )	\
-		{ if( !rb->push_callback( rb, data ) ) return false; }	\
+		{ if( !rb->push_callback( rb, data ) )	\
+		  { RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; } }	\
 		else { RINGBUF_CURR_i( rb ) = *data; }	\
-		rb->input++; return true; }
+		rb->input++;	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_LEVEL( rb, NAME ## _count( rb ) );	\
+		return true; }
 
 #define	ringbuffer_pop_back_def( NAME, ... )	\
 	bool	NAME ## _pop_back ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
-		if ( NAME ## _empty( rb ) ) return false;	\
+		if ( NAME ## _empty( rb ) )	\
+		{ RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return false; }	\
 		rb->output++;	/* Just increment since read will be masked. */	\
+		RINGBUF_STAT_OUT( rb, pops, 1 );	\
 		return true; }
 
 #define	ringbuffer_peek_def( NAME, ... )	\
@@ -227,7 +510,8 @@ typedef	uint32_t	index_t;
 
 #define	ringbuffer_count_def( NAME, ... )	\
 	size_t	NAME ## _count ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	\
-	{ return ( rb->input - rb->output ); }
+	{ /* Cast back: narrow indices are promoted to int. */	\
+	  return ( NAME ## _index_t )( rb->input - rb->output ); }
 
 #define	ringbuffer_empty_def( NAME, ... )	\
 	bool	NAME ## _empty ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	\
@@ -235,7 +519,11 @@ typedef	uint32_t	index_t;
 
 #define	ringbuffer_full_def( NAME, ... )	\
 	bool	NAME ## _full ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	\
-	{ return NAME ## _count( rb ) == BUFFER_LEN( NAME ); }
+	{ return NAME ## _count( rb ) == RINGBUF_CAPACITY( rb ); }
+
+#define	ringbuffer_stats_snapshot_def( NAME, ... )	\
+	void	NAME ## _stats_snapshot ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct ring_buffer_stats *stats )	\
+	{ ( void )rb; RINGBUF_STATS_READ_( rb, stats ); }
 
 // --------------------------------------
 #define ringbuffer_define_all( NAME, ... )	\
@@ -251,7 +539,36 @@ typedef	uint32_t	index_t;
 	\
 	ringbuffer_pop_back_def( NAME, __VA_ARGS__ )	\
 	\
-	ringbuffer_peek_def( NAME, __VA_ARGS__ )
+	ringbuffer_peek_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_stats_snapshot_def( NAME, __VA_ARGS__ )
+
+// --------------------------------------
+/** Prefix a `_def` macro with these to emit it with internal linkage, e.g.
+ * `RINGBUF_INLINE ringbuffer_push_n_def( NAME )`.
+ */
+#define	RINGBUF_INLINE		static inline
+#define	RINGBUF_ALWAYS_INLINE	static inline __attribute__( ( always_inline ) )
+
+/** Define all functions `static inline` (in a header, with `ringbuffer_type_def`
+ * instead of `ringbuffer_declare_all`).
+ */
+#define ringbuffer_define_all_inline( NAME, ... )	\
+	RINGBUF_INLINE		ringbuffer_init_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_count_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_empty_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_full_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_push_front_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_pop_back_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_peek_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_stats_snapshot_def( NAME, __VA_ARGS__ )
 
 // --------------------------------------
 
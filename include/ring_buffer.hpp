@@ -0,0 +1,420 @@
+#ifndef	RING_BUFFER_HPP
+#	define	RING_BUFFER_HPP
+
+/** C++17 front-end: `ringbuf::ring_buffer< T, N, IndexT, Policy >`.
+ *
+ * Same model as the C macros (ring_buffer.h): power-of-two capacity, free-running
+ * `IndexT` indices masked on access (see `wrap()`, as RINGBUF_WRAP), and the
+ * same index hand-over as the SPSC/MPMC variants. Elements live in raw in-place
+ * storage: `emplace` constructs them directly in their slot, `try_push( T&& )`
+ * and `try_pop( T& )` move, so non-trivial types are queued without extra copies
+ * or heap allocations, and without `typeof`.
+ *
+ * Policies
+ * --------
+ *
+ * - `ringbuf::spsc`: one producer and one consumer thread, lock-free, with cached
+ *   remote indices (as RINGBUF_SPSC_CACHED).
+ * - `ringbuf::mpmc`: any number of producers and consumers (as ring_buffer_mpmc.h).
+ *   No `peek`.
+ * - `ringbuf::overwrite`: single thread (or externally locked); `emplace` destroys
+ *   the oldest element when full instead of failing (as `_push_overwrite`).
+ *
+ * \code
+	ringbuf::ring_buffer< std::string, 256 >	q;	// uint32_t indices, SPSC.
+
+	q.emplace( 16, 'x' );				// Producer.
+	q.try_push( std::move( line ) );
+
+	std::string	s;
+	while ( q.try_pop( s ) )			// Consumer.
+		handle( s );
+ * \endcode
+ *
+ * \note	`N` \b must be a power of two, at most half the `IndexT` range (checked at compile time).
+ */
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+#ifndef	RINGBUF_CACHELINE_SIZE
+#	define	RINGBUF_CACHELINE_SIZE	64
+#endif
+
+
+namespace ringbuf
+{
+
+/** Policies. @{ */
+
+struct spsc {};
+struct mpmc {};
+struct overwrite {};
+
+/** @} end Policies. */
+
+
+namespace detail
+{
+
+/// Raw, uninitialised storage for one `T`.
+template< class T >
+struct slot
+{
+	alignas( T ) unsigned char	bytes[ sizeof( T ) ];
+
+	T	*get () noexcept	{ return std::launder( reinterpret_cast< T * >( bytes ) ); }
+};
+
+/// Compile-time checks and index helpers shared by every policy.
+template< class T, std::size_t N, class IndexT >
+struct traits
+{
+	static_assert( std::is_unsigned_v< IndexT >, "ring_buffer: IndexT must be an unsigned integer type" );
+	static_assert( N && !( N & ( N - 1 ) ), "ring_buffer: N must be a power of two" );
+	static_assert( N - 1 <= ( std::numeric_limits< IndexT >::max() >> 1 ), "ring_buffer: N too large for IndexT" );
+
+	/// Limits index inside buffer bounds (RINGBUF_WRAP).
+	static constexpr IndexT	wrap ( IndexT index ) noexcept	{ return index & IndexT( N - 1 ); }
+
+	/// Elements between two free-running indices (cast back: narrow indices are promoted to int).
+	static constexpr std::size_t	distance ( IndexT from, IndexT to ) noexcept	{ return IndexT( to - from ); }
+};
+
+template< class T, std::size_t N, class IndexT, class Policy >
+class core;
+
+// --------------------------------------
+/// SPSC: acquire/release hand-over with cached remote indices.
+template< class T, std::size_t N, class IndexT >
+class core< T, N, IndexT, spsc > : protected traits< T, N, IndexT >
+{
+	using	traits< T, N, IndexT >::wrap;
+	using	traits< T, N, IndexT >::distance;
+
+	alignas( RINGBUF_CACHELINE_SIZE ) std::atomic< IndexT >	input_	{ 0 };
+	IndexT	output_cache_	= 0;	///< Producer only.
+	alignas( RINGBUF_CACHELINE_SIZE ) std::atomic< IndexT >	output_	{ 0 };
+	IndexT	input_cache_	= 0;	///< Consumer only.
+	alignas( RINGBUF_CACHELINE_SIZE ) slot< T >	data_buffer_[ N ];
+
+public:
+	~core ()
+	{
+		for ( IndexT i = output_.load( std::memory_order_relaxed ); i != input_.load( std::memory_order_relaxed ); ++i )
+			data_buffer_[ wrap( i ) ].get()->~T();
+	}
+
+	/// Producer: construct an element in place. The index is only published once constructed.
+	template< class... Args >
+	bool	emplace ( Args&&... args )
+	{
+		IndexT	input	= input_.load( std::memory_order_relaxed );
+
+		if ( distance( output_cache_, input ) == N )
+		{
+			output_cache_	= output_.load( std::memory_order_acquire );
+			if ( distance( output_cache_, input ) == N )
+				return false;
+		}
+
+		::new ( static_cast< void * >( data_buffer_[ wrap( input ) ].bytes ) ) T( std::forward< Args >( args )... );
+		input_.store( input + 1, std::memory_order_release );
+
+		return true;
+	}
+
+	/// Consumer: oldest element + `offset`, or nullptr.
+	T	*peek ( std::size_t offset = 0 ) noexcept
+	{
+		IndexT	output	= output_.load( std::memory_order_relaxed );
+
+		if ( distance( output, input_cache_ ) <= offset )
+		{
+			input_cache_	= input_.load( std::memory_order_acquire );
+			if ( distance( output, input_cache_ ) <= offset )
+				return nullptr;
+		}
+
+		return data_buffer_[ wrap( IndexT( output + offset ) ) ].get();
+	}
+
+	/// Consumer: destroy the oldest element.
+	bool	pop () noexcept
+	{
+		T	*p	= peek();
+
+		if ( !p )
+			return false;
+
+		p->~T();
+		output_.store( output_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+
+		return true;
+	}
+
+	/// Consumer: move the oldest element into `out`.
+	bool	try_pop ( T &out )
+	{
+		T	*p	= peek();
+
+		if ( !p )
+			return false;
+
+		out	= std::move( *p );
+		p->~T();
+		output_.store( output_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+
+		return true;
+	}
+
+	std::size_t	size () const noexcept
+	{
+		IndexT	output	= output_.load( std::memory_order_acquire );
+
+		return distance( output, input_.load( std::memory_order_acquire ) );
+	}
+};
+
+// --------------------------------------
+/// MPMC: per-slot sequence numbers, indices claimed with compare-and-swap.
+template< class T, std::size_t N, class IndexT >
+class core< T, N, IndexT, mpmc > : protected traits< T, N, IndexT >
+{
+	using	traits< T, N, IndexT >::wrap;
+	using	signed_t	= std::make_signed_t< IndexT >;
+
+	struct cell
+	{
+		std::atomic< IndexT >	sequence;
+		slot< T >		data;
+	};
+
+	alignas( RINGBUF_CACHELINE_SIZE ) std::atomic< IndexT >	input_	{ 0 };
+	alignas( RINGBUF_CACHELINE_SIZE ) std::atomic< IndexT >	output_	{ 0 };
+	alignas( RINGBUF_CACHELINE_SIZE ) cell	data_buffer_[ N ];
+
+	static signed_t	seq_diff ( IndexT seq, IndexT index ) noexcept	{ return signed_t( IndexT( seq - index ) ); }
+
+	/// Claim the slot at `index` whose sequence reads `index + ready`, or nullptr if none is.
+	cell	*claim ( std::atomic< IndexT > &index, IndexT ready ) noexcept
+	{
+		IndexT	pos	= index.load( std::memory_order_relaxed );
+
+		for ( ;; )
+		{
+			cell		*c	= &data_buffer_[ wrap( pos ) ];
+			signed_t	diff	= seq_diff( c->sequence.load( std::memory_order_acquire ), IndexT( pos + ready ) );
+
+			if ( !diff )
+			{
+				if ( index.compare_exchange_weak( pos, IndexT( pos + 1 ), std::memory_order_relaxed ) )
+					return c;
+			}
+			else if ( diff < 0 )
+				return nullptr;
+			else
+				pos	= index.load( std::memory_order_relaxed );
+		}
+	}
+
+	/// Hand a claimed slot over: the sequence now reads `pos + step`, `pos` being the claimed index.
+	static void	release ( cell *c, IndexT step ) noexcept
+	{
+		c->sequence.store( IndexT( c->sequence.load( std::memory_order_relaxed ) + step ), std::memory_order_release );
+	}
+
+public:
+	core () noexcept
+	{
+		for ( std::size_t i = 0; i < N; ++i )
+			data_buffer_[ i ].sequence.store( IndexT( i ), std::memory_order_relaxed );
+	}
+
+	~core ()
+	{
+		for ( IndexT i = output_.load( std::memory_order_relaxed ); i != input_.load( std::memory_order_relaxed ); ++i )
+			data_buffer_[ wrap( i ) ].data.get()->~T();
+	}
+
+	/** Once a slot is claimed, constructing must not fail (consumers would wait on it
+	 * forever), so throwing constructions are done beforehand and moved in.
+	 */
+	template< class... Args >
+	bool	emplace ( Args&&... args )
+	{
+		if constexpr ( std::is_nothrow_constructible_v< T, Args&&... > )
+		{
+			cell	*c	= claim( input_, 0 );
+
+			if ( !c )
+				return false;
+
+			::new ( static_cast< void * >( c->data.bytes ) ) T( std::forward< Args >( args )... );
+			release( c, 1 );
+
+			return true;
+		}
+		else
+		{
+			static_assert( std::is_nothrow_move_constructible_v< T >,
+				"ring_buffer< mpmc >: T must be nothrow move constructible" );
+
+			return emplace( T( std::forward< Args >( args )... ) );
+		}
+	}
+
+	bool	try_pop ( T &out ) noexcept
+	{
+		static_assert( std::is_nothrow_move_assignable_v< T >, "ring_buffer< mpmc >: T must be nothrow move assignable" );
+
+		cell	*c	= claim( output_, 1 );
+
+		if ( !c )
+			return false;
+
+		out	= std::move( *c->data.get() );
+		c->data.get()->~T();
+		release( c, IndexT( N - 1 ) );	// pos + 1 -> pos + N: free for the next lap.
+
+		return true;
+	}
+
+	bool	pop () noexcept
+	{
+		cell	*c	= claim( output_, 1 );
+
+		if ( !c )
+			return false;
+
+		c->data.get()->~T();
+		release( c, IndexT( N - 1 ) );
+
+		return true;
+	}
+
+	/// Approximate; `output` is read first, so the difference never goes negative.
+	std::size_t	size () const noexcept
+	{
+		IndexT		output	= output_.load( std::memory_order_acquire );
+		std::size_t	count	= IndexT( input_.load( std::memory_order_acquire ) - output );
+
+		return count < N ? count : N;
+	}
+};
+
+// --------------------------------------
+/// Overwrite-oldest, single-threaded (or externally locked).
+template< class T, std::size_t N, class IndexT >
+class core< T, N, IndexT, overwrite > : protected traits< T, N, IndexT >
+{
+	using	traits< T, N, IndexT >::wrap;
+	using	traits< T, N, IndexT >::distance;
+
+	IndexT		input_	= 0;
+	IndexT		output_	= 0;
+	slot< T >	data_buffer_[ N ];
+
+public:
+	~core ()
+	{
+		while ( pop() )
+			;
+	}
+
+	/// Always succeeds: when full, the oldest element is destroyed first.
+	template< class... Args >
+	bool	emplace ( Args&&... args )
+	{
+		if ( size() == N )
+			pop();
+
+		::new ( static_cast< void * >( data_buffer_[ wrap( input_ ) ].bytes ) ) T( std::forward< Args >( args )... );
+		++input_;
+
+		return true;
+	}
+
+	T	*peek ( std::size_t offset = 0 ) noexcept
+	{
+		return size() > offset ? data_buffer_[ wrap( IndexT( output_ + offset ) ) ].get() : nullptr;
+	}
+
+	bool	pop () noexcept
+	{
+		if ( !size() )
+			return false;
+
+		data_buffer_[ wrap( output_++ ) ].get()->~T();
+
+		return true;
+	}
+
+	bool	try_pop ( T &out )
+	{
+		T	*p	= peek();
+
+		if ( !p )
+			return false;
+
+		out	= std::move( *p );
+		p->~T();
+		++output_;
+
+		return true;
+	}
+
+	std::size_t	size () const noexcept	{ return distance( output_, input_ ); }
+};
+
+}	// namespace detail
+
+
+// --------------------------------------
+/** Fixed-capacity ring buffer of `N` elements of `T`.
+ *
+ * \tparam	IndexT	Free-running index type (as `ringbuffer_type_def_ex`).
+ * \tparam	Policy	`ringbuf::spsc`, `ringbuf::mpmc` or `ringbuf::overwrite`.
+ *
+ * Provides `emplace( args... )`, `try_push( const T& )`, `try_push( T&& )`,
+ * `try_pop( T& )`, `pop()`, `size()`, `empty()`, `full()`, and `peek( offset )`
+ * (spsc/overwrite only). Returns false instead of blocking when full/empty.
+ */
+template< class T, std::size_t N, class IndexT = std::uint32_t, class Policy = spsc >
+class ring_buffer : public detail::core< T, N, IndexT, Policy >
+{
+	using	base	= detail::core< T, N, IndexT, Policy >;
+
+public:
+	using	value_type	= T;
+	using	index_type	= IndexT;
+	using	policy_type	= Policy;
+
+	ring_buffer ()	= default;
+	ring_buffer ( const ring_buffer & )		= delete;
+	ring_buffer &operator= ( const ring_buffer & )	= delete;
+
+	/// Element capacity.
+	static constexpr std::size_t	capacity () noexcept	{ return N; }
+
+	/// Limits index inside buffer bounds (RINGBUF_WRAP).
+	static constexpr IndexT	wrap ( IndexT index ) noexcept	{ return index & IndexT( N - 1 ); }
+
+	[[nodiscard]] bool	try_push ( const T &value )	{ return base::emplace( value ); }
+	[[nodiscard]] bool	try_push ( T &&value )		{ return base::emplace( std::move( value ) ); }
+
+	bool	empty () const noexcept	{ return !base::size(); }
+	bool	full () const noexcept	{ return base::size() == N; }
+};
+
+}	// namespace ringbuf
+
+
+#endif	// RING_BUFFER_HPP
@@ -0,0 +1,346 @@
+#ifndef	RING_BUFFER_BULK_H
+#	define	RING_BUFFER_BULK_H
+
+/** Bulk (multi-element) ring buffer operations.
+ *
+ * Work out the available span once, copy it in at most two contiguous chunks
+ * (before and after the RINGBUF_WRAP boundary) and publish the new index once.
+ *
+ * Indices are handed over with acquire/release semantics, so these can be used
+ * on plain (ring_buffer.h) and SPSC (ring_buffer_spsc.h) ring-buffers alike:
+ * `_push_n` from the producer side and `_pop_n` from the consumer side.
+ *
+ * On SPSC ring-buffers, prefer `ringbuffer_spsc_bulk_define_all`: its `_push_n`,
+ * `_pop_n`, `_reserve` and `_peek_span` go through the side's cached remote index
+ * (RINGBUF_SPSC_CACHED), only reloading the shared one when the cache falls short,
+ * and write back what they load, so they mix freely with `_push_front`/`_pop_back`.
+ * (The generic ones always reload, and leave the cache to the single-element
+ * calls' stale-cache check.)
+ *
+ * The span API (`_reserve`/`_commit`, `_peek_span`/`_consume`) hands out direct
+ * pointers into data_buffer instead, so producers (e.g. DMA engines) can write
+ * and consumers (e.g. parsers) can read the ring in place, with no copy:
+ *
+ * \code
+	int	*p1, *p2;
+	size_t	l1, l2;
+	size_t	n = peanuts_reserve( rb, 100, &p1, &l1, &p2, &l2 );
+	// ... fill p1[ 0 .. l1 ) and p2[ 0 .. l2 ) ...
+	peanuts_commit( rb, n );
+ * \endcode
+ *
+ * Bulk pushes (`_push_n`, `_commit`, `_push_string`) call `push_batch_callback`
+ * once per contiguous segment written, after the copy and before publishing,
+ * instead of `push_callback` once per element. To bind a batch callback at
+ * compile time (so it can be inlined and the pointer is never loaded), use the
+ * `_cb_def` forms with the function name as `CB`:
+ *
+ * \code
+	static inline void	frames_crc ( frames *rb, uint8_t *first, size_t n );
+
+	ringbuffer_bulk_define_all_cb( frames, frames_crc )
+ * \endcode
+ *
+ * \note	`push_callback` is \b not invoked by bulk pushes.
+ * \note	With `_cb_def` forms the `push_batch_callback` member is ignored.
+ */
+
+
+#include "ring_buffer.h"
+
+#ifdef __KERNEL__
+#	include <linux/string.h>
+#else
+#	include <string.h>
+#endif
+
+
+/** Bulk helpers. @{ */
+
+/// Elements of the first contiguous chunk of a `n` elements span starting at `index`.
+#define	RINGBUF_SPAN_FIRST( rb, index, n )	\
+	( ( size_t )( n ) < RINGBUF_TO_END( ( rb ), ( index ) ) ? ( size_t )( n ) : RINGBUF_TO_END( ( rb ), ( index ) ) )
+
+/// Don't use. Copy `n` elements from `src` into the ring starting at `index`.
+#define	RINGBUF_COPY_IN_( rb, index, src, n )	do {	\
+	size_t	first_	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) );	\
+	memcpy( ( void * )&( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ], ( src ),	\
+		first_ * sizeof( ( rb )->data_buffer[ 0 ] ) );	\
+	memcpy( ( void * )&( rb )->data_buffer[ 0 ], ( src ) + first_,	\
+		( ( n ) - first_ ) * sizeof( ( rb )->data_buffer[ 0 ] ) ); } while ( 0 )
+
+/// Don't use. Copy `n` elements from the ring starting at `index` into `dest`.
+#define	RINGBUF_COPY_OUT_( rb, index, dest, n )	do {	\
+	size_t	first_	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) );	\
+	memcpy( ( dest ), ( const void * )&( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ],	\
+		first_ * sizeof( ( rb )->data_buffer[ 0 ] ) );	\
+	memcpy( ( dest ) + first_, ( const void * )&( rb )->data_buffer[ 0 ],	\
+		( ( n ) - first_ ) * sizeof( ( rb )->data_buffer[ 0 ] ) ); } while ( 0 )
+
+/// Don't use. Split a `n` elements span starting at `index` in two segments.
+#define	RINGBUF_SPAN_( rb, index, n, ptr1, len1, ptr2, len2 )	do {	\
+	*( len1 )	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) );	\
+	*( len2 )	= ( n ) - *( len1 );	\
+	*( ptr1 )	= &( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ];	\
+	*( ptr2 )	= *( len2 ) ? &( rb )->data_buffer[ 0 ] : NULL; } while ( 0 )
+
+/// Call `CB` once per contiguous segment of a `n` elements span starting at `index`.
+#define	RINGBUF_BATCH_( CB, rb, index, n )	do {	\
+	size_t	first_	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) );	\
+	if ( first_ )	\
+		CB( ( rb ), &( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ], first_ );	\
+	if ( ( n ) > first_ )	\
+		CB( ( rb ), &( rb )->data_buffer[ 0 ], ( n ) - first_ ); } while ( 0 )
+
+/// Default batch `CB`: indirect call through `push_batch_callback`, if set.
+#define	RINGBUF_BATCH_INDIRECT( rb, first, n )	do {	\
+	if ( ( rb )->push_batch_callback )	\
+		( rb )->push_batch_callback( ( rb ), ( first ), ( n ) ); } while ( 0 )
+
+/// Batch `CB` that does nothing.
+#define	RINGBUF_BATCH_NONE( rb, first, n )	do { } while ( 0 )
+
+/** Don't use. SPSC producer: free elements from `input`, at most `want`, into `n`.
+ *
+ * `output_cache` is trusted only if it covers `want` (a cache behind by more than
+ * a lap counts as no free space); otherwise `output` is reloaded into it.
+ */
+#define	RINGBUF_SPSC_FREE_( NAME, rb, input, want, n )	do {	\
+	( n )	= ( NAME ## _index_t )( ( input ) - ( rb )->output_cache );	\
+	( n )	= ( n ) < RINGBUF_CAPACITY( rb ) ? RINGBUF_CAPACITY( rb ) - ( n ) : 0;	\
+	if ( ( n ) < ( want ) )	\
+	{ ( rb )->output_cache	= RINGBUF_LOAD_ACQUIRE( &( rb )->output );	\
+	  ( n )	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( ( input ) - ( rb )->output_cache ); }	\
+	if ( ( n ) > ( want ) ) ( n ) = ( want ); } while ( 0 )
+
+/** Don't use. SPSC consumer: used elements from `output`, at most `want`, into `n`.
+ *
+ * `input_cache` is trusted only if it covers `want` (a cache behind `output`
+ * counts as empty); otherwise `input` is reloaded into it.
+ */
+#define	RINGBUF_SPSC_USED_( NAME, rb, output, want, n )	do {	\
+	( n )	= ( NAME ## _index_t )( ( rb )->input_cache - ( output ) );	\
+	if ( ( n ) > RINGBUF_CAPACITY( rb ) ) ( n ) = 0;	\
+	if ( ( n ) < ( want ) )	\
+	{ ( rb )->input_cache	= RINGBUF_LOAD_ACQUIRE( &( rb )->input );	\
+	  ( n )	= ( NAME ## _index_t )( ( rb )->input_cache - ( output ) ); }	\
+	if ( ( n ) > ( want ) ) ( n ) = ( want ); } while ( 0 )
+
+/** @} end Bulk helpers. */
+
+
+// --------------------------------------
+/** Bulk ring buffer function declaration macros. @{ */
+
+/** Push up to `len` elements from `src`. Returns the number of elements pushed. */
+#define	ringbuffer_push_n_decl( NAME, ... )	\
+	size_t	NAME ## _push_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )
+
+/** Pop up to `limit` elements into `dest`. Returns the number of elements popped. */
+#define	ringbuffer_pop_n_decl( NAME, ... )	\
+	size_t	NAME ## _pop_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )
+
+/** Reserve up to `n` free elements for in-place writing.
+ *
+ * \param	ptr1, len1	First segment (up to the wrap point).
+ * \param	ptr2, len2	Second segment (from the start of data_buffer), or NULL/0.
+ * \return	Elements reserved (`len1 + len2`), limited by the free space.
+ */
+#define	ringbuffer_reserve_decl( NAME, ... )	\
+	size_t	NAME ## _reserve ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )
+
+/** Publish `n` elements written after `_reserve`.
+ *
+ * \note	`n` \b must not exceed the amount returned by the last `_reserve`.
+ */
+#define	ringbuffer_commit_decl( NAME, ... )	\
+	void	NAME ## _commit ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n )
+
+/** Get up to `n` used elements for in-place reading (same segments as `_reserve`). */
+#define	ringbuffer_peek_span_decl( NAME, ... )	\
+	size_t	NAME ## _peek_span ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )
+
+/** Release `n` elements read after `_peek_span`.
+ *
+ * \note	`n` \b must not exceed the amount returned by the last `_peek_span`.
+ */
+#define	ringbuffer_consume_decl( NAME, ... )	\
+	void	NAME ## _consume ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n )
+
+// --------------------------------------
+#define ringbuffer_bulk_declare_all( NAME, ... )	\
+	ringbuffer_push_n_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_n_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_reserve_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_commit_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_span_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_consume_decl( NAME, __VA_ARGS__ )
+
+/** @} end Bulk ring buffer function declaration macros. */
+
+
+// --------------------------------------
+/** Bulk ring buffer function definition macros. @{ */
+
+#define	ringbuffer_push_n_def( NAME, ... )	\
+	ringbuffer_push_n_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_push_n_cb_def( NAME, CB, ... )	\
+	size_t	NAME ## _push_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	n	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+		if ( n > len ) n = len;		/* Free space vs. source length. */	\
+		RINGBUF_COPY_IN_( rb, input, src, n );	\
+		RINGBUF_BATCH_( CB, rb, input, n );	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + n );	\
+		RINGBUF_STAT_IN( rb, pushes, n );	\
+		RINGBUF_STAT_IN( rb, rejected_pushes, len - n );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + n - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+		return n; }
+
+#define	ringbuffer_pop_n_def( NAME, ... )	\
+	size_t	NAME ## _pop_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	n	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output );	\
+		if ( n > limit ) n = limit;	/* Used space vs. dest buffer length. */	\
+		RINGBUF_COPY_OUT_( rb, output, dest, n );	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + n );	\
+		RINGBUF_STAT_OUT( rb, pops, n );	\
+		if ( !n ) RINGBUF_STAT_OUT( rb, empty_polls, 1 );	\
+		return n; }
+
+#define	ringbuffer_reserve_def( NAME, ... )	\
+	size_t	NAME ## _reserve ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	avail	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+		if ( n > avail ) n = avail;	\
+		RINGBUF_SPAN_( rb, input, n, ptr1, len1, ptr2, len2 );	\
+		return n; }
+
+#define	ringbuffer_commit_def( NAME, ... )	\
+	ringbuffer_commit_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_commit_cb_def( NAME, CB, ... )	\
+	void	NAME ## _commit ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n )	\
+	{ NAME ## _index_t input = rb->input;	\
+	  RINGBUF_CHECK( n <= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+	  RINGBUF_BATCH_( CB, rb, input, n );	\
+	  RINGBUF_STORE_RELEASE( &rb->input, input + n );	\
+	  RINGBUF_STAT_IN( rb, pushes, n );	\
+	  RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + n - RINGBUF_LOAD_RELAXED( &rb->output ) ) ); }
+
+#define	ringbuffer_peek_span_def( NAME, ... )	\
+	size_t	NAME ## _peek_span ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	avail	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output );	\
+		if ( n > avail ) n = avail;	\
+		RINGBUF_SPAN_( rb, output, n, ptr1, len1, ptr2, len2 );	\
+		return n; }
+
+#define	ringbuffer_consume_def( NAME, ... )	\
+	void	NAME ## _consume ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n )	\
+	{ RINGBUF_CHECK( n <= ( NAME ## _index_t )( RINGBUF_LOAD_RELAXED( &rb->input ) - rb->output ) );	\
+	  RINGBUF_STORE_RELEASE( &rb->output, rb->output + n );	\
+	  RINGBUF_STAT_OUT( rb, pops, n ); }
+
+// --------------------------------------
+/** SPSC forms: as above, through the cached remote index (see RINGBUF_SPSC_FREE_/RINGBUF_SPSC_USED_). */
+
+#define	ringbuffer_spsc_push_n_def( NAME, ... )	\
+	ringbuffer_spsc_push_n_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_spsc_push_n_cb_def( NAME, CB, ... )	\
+	size_t	NAME ## _push_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	n;	\
+		RINGBUF_SPSC_FREE_( NAME, rb, input, len, n );	\
+		RINGBUF_COPY_IN_( rb, input, src, n );	\
+		RINGBUF_BATCH_( CB, rb, input, n );	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + n );	\
+		RINGBUF_STAT_IN( rb, pushes, n );	\
+		RINGBUF_STAT_IN( rb, rejected_pushes, len - n );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + n - rb->output_cache ) );	\
+		return n; }
+
+#define	ringbuffer_spsc_pop_n_def( NAME, ... )	\
+	size_t	NAME ## _pop_n ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	n;	\
+		RINGBUF_SPSC_USED_( NAME, rb, output, limit, n );	\
+		RINGBUF_COPY_OUT_( rb, output, dest, n );	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + n );	\
+		RINGBUF_STAT_OUT( rb, pops, n );	\
+		if ( !n ) RINGBUF_STAT_OUT( rb, empty_polls, 1 );	\
+		return n; }
+
+#define	ringbuffer_spsc_reserve_def( NAME, ... )	\
+	size_t	NAME ## _reserve ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	avail;	\
+		RINGBUF_SPSC_FREE_( NAME, rb, input, n, avail );	\
+		RINGBUF_SPAN_( rb, input, avail, ptr1, len1, ptr2, len2 );	\
+		return avail; }
+
+#define	ringbuffer_spsc_peek_span_def( NAME, ... )	\
+	size_t	NAME ## _peek_span ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t n,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr1, size_t *len1,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr2, size_t *len2 )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	avail;	\
+		RINGBUF_SPSC_USED_( NAME, rb, output, n, avail );	\
+		RINGBUF_SPAN_( rb, output, avail, ptr1, len1, ptr2, len2 );	\
+		return avail; }
+
+// --------------------------------------
+#define ringbuffer_bulk_define_all( NAME, ... )	\
+	ringbuffer_bulk_define_all_cb( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define ringbuffer_bulk_define_all_cb( NAME, CB, ... )	\
+	ringbuffer_push_n_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_pop_n_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_reserve_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_commit_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_peek_span_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_consume_def( NAME, __VA_ARGS__ )
+
+/// SPSC ring-buffers (ring_buffer_spsc.h): same functions, through the cached remote indices.
+#define ringbuffer_spsc_bulk_define_all( NAME, ... )	\
+	ringbuffer_spsc_bulk_define_all_cb( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define ringbuffer_spsc_bulk_define_all_cb( NAME, CB, ... )	\
+	ringbuffer_spsc_push_n_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_pop_n_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_reserve_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_commit_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_peek_span_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_consume_def( NAME, __VA_ARGS__ )
+
+/** @} end Bulk ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_BULK_H
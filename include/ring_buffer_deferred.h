@@ -0,0 +1,229 @@
+#ifndef	RING_BUFFER_DEFERRED_H
+#	define	RING_BUFFER_DEFERRED_H
+
+/** Deferred (batched) index publication for plain, SPSC and runtime-sized ring buffers.
+ *
+ * Wraps an existing ring-buffer type `RING` with a private cursor per side. The
+ * `_deferred` pushes and pops only move their side's cursor; the shared index
+ * (`input` or `output`) is published every `every_in`/`every_out` elements, or
+ * on demand with `_publish_input`/`_publish_output`. Each publication is a
+ * single store that invalidates the other side's copy of the index, instead of
+ * one per element or per small message (Disruptor/FastFlow-style batching).
+ *
+ * Each side also keeps its own cached copy of the other side's index, and only
+ * reloads it when that copy says the ring is full (producer) or empty (consumer).
+ *
+ * \code
+	ringbuffer_spsc_declare_all( msgs, uint8_t, 4096 );
+	ringbuffer_spsc_define_all( msgs )
+
+	ringbuffer_deferred_declare_all( msgs_d, msgs );
+	ringbuffer_deferred_define_all( msgs_d, msgs )
+
+	msgs_d_init( &q, 256, 64 );		// Publish every 256 pushed, 64 popped.
+
+	// Producer:
+	msgs_d_push_n_deferred( &q, hdr, sizeof( hdr ) );
+	msgs_d_push_n_deferred( &q, body, len );
+	if ( idle )
+		msgs_d_publish_input( &q );
+
+	// Consumer:
+	while ( msgs_d_pop_n_deferred( &q, buf, sizeof( buf ) ) ) ...
+	msgs_d_publish_output( &q );		// Before waiting for more.
+ * \endcode
+ *
+ * \note	Unpublished elements are invisible to the other side: a producer must
+ * 	publish before going idle, and a consumer before waiting for space to free up,
+ * 	or both sides may wait forever.
+ * \note	Each side uses either its `_deferred` functions or the plain `RING` ones
+ * 	(on `&q.ring`), never both. `push_callback`/`push_batch_callback` are not invoked.
+ */
+
+
+#include "ring_buffer_bulk.h"
+
+
+// --------------------------------------
+/** Define deferred-publication wrapper structure.
+ *
+ * \var ring		Wrapped ring-buffer.
+ * \var in		Producer side (own cache line).
+ * \var out		Consumer side (own cache line).
+ * \var cursor		Side's private index: elements up to it are written (`in`)
+ * 	or read (`out`), but only published up to the ring's index.
+ * \var remote		Side's last seen index of the other side.
+ * \var pending		Unpublished elements.
+ * \var every		Publish once `pending` reaches this (0: on demand only).
+ */
+#define ringbuffer_deferred_type_def( NAME, RING )	\
+	typedef struct ring_buffer_deferred_ ## NAME	\
+	{					\
+		RING	ring;	\
+		struct	\
+		{	\
+			RING ## _index_t	cursor	RINGBUF_CACHELINE_ALIGNED;	\
+			RING ## _index_t	remote;	\
+			unsigned	pending;	\
+			unsigned	every;	\
+		}	in, out;	\
+	} NAME
+
+
+// --------------------------------------
+/** Deferred-publication declaration macros. @{ */
+
+/** Reset the ring-buffer (no callbacks) and both cursors. */
+#define	ringbuffer_deferred_init_decl( NAME, RING )	\
+	void	NAME ## _init ( NAME *d, unsigned every_in, unsigned every_out )
+
+/** Write `*data` at the producer cursor. Returns false if full (as far as published pops tell). */
+#define	ringbuffer_push_deferred_decl( NAME, RING )	\
+	bool	NAME ## _push_deferred ( NAME *d, DATA_TYPE( RING ) *data )
+
+/** Write up to `len` elements from `src` at the producer cursor. Returns the number written. */
+#define	ringbuffer_push_n_deferred_decl( NAME, RING )	\
+	size_t	NAME ## _push_n_deferred ( NAME *d, const DATA_TYPE( RING ) *src, size_t len )
+
+/** Publish every element written so far (producer side). */
+#define	ringbuffer_publish_input_decl( NAME, RING )	\
+	void	NAME ## _publish_input ( NAME *d )
+
+/** Read the element at the consumer cursor into `*data`. Returns false if empty (as far as published pushes tell). */
+#define	ringbuffer_pop_deferred_decl( NAME, RING )	\
+	bool	NAME ## _pop_deferred ( NAME *d, DATA_TYPE( RING ) *data )
+
+/** Read up to `limit` elements at the consumer cursor into `dest`. Returns the number read. */
+#define	ringbuffer_pop_n_deferred_decl( NAME, RING )	\
+	size_t	NAME ## _pop_n_deferred ( NAME *d, DATA_TYPE( RING ) *dest, size_t limit )
+
+/** Release every element read so far (consumer side). */
+#define	ringbuffer_publish_output_decl( NAME, RING )	\
+	void	NAME ## _publish_output ( NAME *d )
+
+// --------------------------------------
+#define ringbuffer_deferred_declare_all( NAME, RING )	\
+	ringbuffer_deferred_type_def( NAME, RING );	\
+	\
+	ringbuffer_deferred_init_decl( NAME, RING );	\
+	\
+	ringbuffer_push_deferred_decl( NAME, RING );	\
+	\
+	ringbuffer_push_n_deferred_decl( NAME, RING );	\
+	\
+	ringbuffer_publish_input_decl( NAME, RING );	\
+	\
+	ringbuffer_pop_deferred_decl( NAME, RING );	\
+	\
+	ringbuffer_pop_n_deferred_decl( NAME, RING );	\
+	\
+	ringbuffer_publish_output_decl( NAME, RING )
+
+/** @} end Deferred-publication declaration macros. */
+
+
+// --------------------------------------
+/** Deferred-publication function definition macros. @{ */
+
+#define	ringbuffer_deferred_init_def( NAME, RING )	\
+	void	NAME ## _init ( NAME *d, unsigned every_in, unsigned every_out )	{\
+		RING ## _init( &d->ring, NULL );	\
+		d->in.cursor = d->in.remote	= d->ring.input;	\
+		d->out.cursor = d->out.remote	= d->ring.output;	\
+		d->in.pending = d->out.pending	= 0;	\
+		d->in.every	= every_in;	\
+		d->out.every	= every_out; }
+
+#define	ringbuffer_push_deferred_def( NAME, RING )	\
+	bool	NAME ## _push_deferred ( NAME *d, DATA_TYPE( RING ) *data )	{\
+		RING ## _index_t input	= d->in.cursor;	\
+		if ( ( RING ## _index_t )( input - d->in.remote ) == RINGBUF_CAPACITY( &d->ring ) )	\
+		{ d->in.remote	= RINGBUF_LOAD_ACQUIRE( &d->ring.output );	\
+		  if ( ( RING ## _index_t )( input - d->in.remote ) == RINGBUF_CAPACITY( &d->ring ) )	\
+		  { RINGBUF_STAT_IN( &d->ring, rejected_pushes, 1 ); return false; } }	\
+		d->ring.data_buffer[ RINGBUF_WRAP( &d->ring, input ) ]	= *data;	\
+		d->in.cursor	= input + 1;	\
+		if ( ++d->in.pending >= d->in.every && d->in.every ) NAME ## _publish_input( d );	\
+		return true; }
+
+#define	ringbuffer_push_n_deferred_def( NAME, RING )	\
+	size_t	NAME ## _push_n_deferred ( NAME *d, const DATA_TYPE( RING ) *src, size_t len )	{\
+		RING ## _index_t input	= d->in.cursor;	\
+		size_t	n	= RINGBUF_CAPACITY( &d->ring ) - ( RING ## _index_t )( input - d->in.remote );	\
+		if ( n < len )	\
+		{ d->in.remote	= RINGBUF_LOAD_ACQUIRE( &d->ring.output );	\
+		  n	= RINGBUF_CAPACITY( &d->ring ) - ( RING ## _index_t )( input - d->in.remote );	\
+		  if ( n > len ) n = len; }	\
+		else	\
+		  n	= len;	\
+		RINGBUF_COPY_IN_( &d->ring, input, src, n );	\
+		RINGBUF_STAT_IN( &d->ring, rejected_pushes, len - n );	\
+		d->in.cursor	= input + n;	\
+		d->in.pending	+= n;	\
+		if ( d->in.every && d->in.pending >= d->in.every ) NAME ## _publish_input( d );	\
+		return n; }
+
+#define	ringbuffer_publish_input_def( NAME, RING )	\
+	void	NAME ## _publish_input ( NAME *d )	{\
+		if ( !d->in.pending ) return;	\
+		RINGBUF_STORE_RELEASE( &d->ring.input, d->in.cursor );	\
+		RINGBUF_STAT_IN( &d->ring, pushes, d->in.pending );	\
+		RINGBUF_STAT_LEVEL( &d->ring, ( RING ## _index_t )( d->in.cursor - d->in.remote ) );	\
+		d->in.pending	= 0; }
+
+#define	ringbuffer_pop_deferred_def( NAME, RING )	\
+	bool	NAME ## _pop_deferred ( NAME *d, DATA_TYPE( RING ) *data )	{\
+		RING ## _index_t output	= d->out.cursor;	\
+		if ( output == d->out.remote )	\
+		{ d->out.remote	= RINGBUF_LOAD_ACQUIRE( &d->ring.input );	\
+		  if ( output == d->out.remote )	\
+		  { RINGBUF_STAT_OUT( &d->ring, empty_polls, 1 ); return false; } }	\
+		*data	= d->ring.data_buffer[ RINGBUF_WRAP( &d->ring, output ) ];	\
+		d->out.cursor	= output + 1;	\
+		if ( ++d->out.pending >= d->out.every && d->out.every ) NAME ## _publish_output( d );	\
+		return true; }
+
+#define	ringbuffer_pop_n_deferred_def( NAME, RING )	\
+	size_t	NAME ## _pop_n_deferred ( NAME *d, DATA_TYPE( RING ) *dest, size_t limit )	{\
+		RING ## _index_t output	= d->out.cursor;	\
+		size_t	n	= ( RING ## _index_t )( d->out.remote - output );	\
+		if ( n < limit )	\
+		{ d->out.remote	= RINGBUF_LOAD_ACQUIRE( &d->ring.input );	\
+		  n	= ( RING ## _index_t )( d->out.remote - output );	\
+		  if ( n > limit ) n = limit; }	\
+		else	\
+		  n	= limit;	\
+		RINGBUF_COPY_OUT_( &d->ring, output, dest, n );	\
+		if ( !n ) RINGBUF_STAT_OUT( &d->ring, empty_polls, 1 );	\
+		d->out.cursor	= output + n;	\
+		d->out.pending	+= n;	\
+		if ( d->out.every && d->out.pending >= d->out.every ) NAME ## _publish_output( d );	\
+		return n; }
+
+#define	ringbuffer_publish_output_def( NAME, RING )	\
+	void	NAME ## _publish_output ( NAME *d )	{\
+		if ( !d->out.pending ) return;	\
+		RINGBUF_STORE_RELEASE( &d->ring.output, d->out.cursor );	\
+		RINGBUF_STAT_OUT( &d->ring, pops, d->out.pending );	\
+		d->out.pending	= 0; }
+
+// --------------------------------------
+#define ringbuffer_deferred_define_all( NAME, RING )	\
+	ringbuffer_deferred_init_def( NAME, RING )	\
+	\
+	ringbuffer_publish_input_def( NAME, RING )	\
+	\
+	ringbuffer_push_deferred_def( NAME, RING )	\
+	\
+	ringbuffer_push_n_deferred_def( NAME, RING )	\
+	\
+	ringbuffer_publish_output_def( NAME, RING )	\
+	\
+	ringbuffer_pop_deferred_def( NAME, RING )	\
+	\
+	ringbuffer_pop_n_deferred_def( NAME, RING )
+
+/** @} end Deferred-publication function definition macros. */
+
+
+#endif	// RING_BUFFER_DEFERRED_H
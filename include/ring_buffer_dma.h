@@ -0,0 +1,278 @@
+#ifndef	RING_BUFFER_DMA_H
+#	define	RING_BUFFER_DMA_H
+
+/** DMA-coherent runtime-sized ring buffers for kernel drivers (`__KERNEL__` only).
+ *
+ * data_buffer comes from dma_alloc_coherent() (page, hence cache-line, aligned)
+ * and the free/used spans are described as scatterlists, kfifo_dma_*-style, so a
+ * peripheral writes into (or reads from) the ring directly and the driver only
+ * commits indices, e.g. in its IRQ handler:
+ *
+ * \code
+	ringbuffer_dma_declare_all( rx, u8 );
+	ringbuffer_dma_define_all( rx )
+
+	ret = rx_dma_alloc( &priv->rx, dev, 4096, GFP_KERNEL );
+
+	// Start a transfer:
+	struct scatterlist	sg[ 2 ];
+	unsigned int	nents = rx_dma_in_prepare( &priv->rx, sg, ARRAY_SIZE( sg ), burst );
+	if ( nents )
+		start_hw( sg, nents );		// sg_dma_address()/sg_dma_len() are set.
+
+	// IRQ handler:
+	rx_dma_in_finish( &priv->rx, hw_bytes_done( priv ) );
+ * \endcode
+ *
+ * \note	The scatterlist entries already carry bus addresses of coherent memory:
+ * 	do \b not dma_map_sg() them, and don't use their page/offset fields.
+ * \note	Same function set as ring_buffer_dynamic.h otherwise, with the ring_buffer_spsc.h
+ * 	definitions: indices are handed over with acquire/release semantics, so the
+ * 	producer side (`_push_front`, `_dma_in_*`) and the consumer side (`_pop_back`,
+ * 	`_peek`, `_dma_out_*`) may run concurrently, e.g. IRQ handler and driver thread.
+ */
+
+
+#ifndef __KERNEL__
+#	error	"ring_buffer_dma.h is kernel only."
+#endif
+
+#include <linux/dma-mapping.h>
+#include <linux/scatterlist.h>
+#include <linux/errno.h>
+
+#include "ring_buffer_dynamic.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+
+
+/** DMA helpers. @{ */
+
+/** Fill `sgl` (`nents` entries) with the segments of a span, starting `off1` bytes into the buffer at `base`.
+ *
+ * \return	Entries used (0, 1 or 2, limited by `nents`).
+ */
+static inline unsigned int	ring_buffer_dma_sg ( struct scatterlist *sgl, int nents, dma_addr_t base,
+	size_t off1, size_t len1, size_t len2 )
+{
+	unsigned int	n	= 0;
+
+	if ( nents <= 0 || !len1 )
+		return 0;
+
+	sg_init_table( sgl, nents );
+
+	sg_dma_address( &sgl[ 0 ] )	= base + off1;
+	sg_dma_len( &sgl[ 0 ] )		= sgl[ 0 ].length	= len1;
+	n	= 1;
+
+	if ( len2 && nents > 1 )
+	{
+		sg_dma_address( &sgl[ 1 ] )	= base;
+		sg_dma_len( &sgl[ 1 ] )		= sgl[ 1 ].length	= len2;
+		n	= 2;
+	}
+
+	sg_mark_end( &sgl[ n - 1 ] );
+
+	return n;
+}
+
+/** @} end DMA helpers. */
+
+
+// --------------------------------------
+/** Define DMA-coherent ring buffer control structure.
+ *
+ * As ringbuffer_dyn_type_def, plus:
+ *
+ * \var output_cache	Producer's last seen `output` (see RINGBUF_SPSC_CACHED).
+ * \var input_cache	Consumer's last seen `input`.
+ * \var dev		Device the storage was allocated for.
+ * \var dma_handle	Bus address of data_buffer[ 0 ].
+ */
+#define ringbuffer_dma_type_def( NAME, TYPE, ... )	\
+	typedef struct ring_buffer_ ## NAME NAME;	\
+	typedef index_t NAME ## _index_t;	\
+	typedef bool ( * NAME ## _push_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb, TYPE *data );	\
+	typedef void ( * NAME ## _push_batch_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) TYPE *first, size_t n );	\
+	\
+	struct ring_buffer_ ## NAME	\
+	{					\
+		struct ring_buffer_storage	storage;	\
+		NAME ## _index_t	input;	\
+		NAME ## _index_t	output_cache;	\
+		NAME ## _index_t	output;	\
+		NAME ## _index_t	input_cache;	\
+		TYPE	*data_buffer;		\
+		NAME ## _push_callback_t	push_callback;	\
+		NAME ## _push_batch_callback_t	push_batch_callback;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		RINGBUF_STATS_OUT_FIELDS	\
+		struct device	*dev;	\
+		dma_addr_t	dma_handle;	\
+	}
+
+
+// --------------------------------------
+/** DMA ring buffer declaration macros. @{ */
+
+/** Allocate coherent storage for `len` elements (power of two) and reset the ring-buffer.
+ *
+ * \return	0, -EINVAL or -ENOMEM.
+ */
+#define	ringbuffer_dma_alloc_decl( NAME, ... )	\
+	int	NAME ## _dma_alloc ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct device *dev, size_t len, gfp_t gfp )
+
+#define	ringbuffer_dma_free_decl( NAME, ... )	\
+	void	NAME ## _dma_free ( DECL_qualif( __VA_ARGS__ ) NAME *rb )
+
+/** Describe up to `len` free elements in `sgl` for the device to write.
+ *
+ * \return	Scatterlist entries used; 0 if the ring-buffer is full.
+ */
+#define	ringbuffer_dma_in_prepare_decl( NAME, ... )	\
+	unsigned int	NAME ## _dma_in_prepare ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		struct scatterlist *sgl, int nents, size_t len )
+
+/** Publish `len` elements written by the device (at most what was prepared). */
+#define	ringbuffer_dma_in_finish_decl( NAME, ... )	\
+	void	NAME ## _dma_in_finish ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )
+
+/** Describe up to `len` used elements in `sgl` for the device to read.
+ *
+ * \return	Scatterlist entries used; 0 if the ring-buffer is empty.
+ */
+#define	ringbuffer_dma_out_prepare_decl( NAME, ... )	\
+	unsigned int	NAME ## _dma_out_prepare ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		struct scatterlist *sgl, int nents, size_t len )
+
+/** Release `len` elements read by the device (at most what was prepared). */
+#define	ringbuffer_dma_out_finish_decl( NAME, ... )	\
+	void	NAME ## _dma_out_finish ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )
+
+// --------------------------------------
+#define ringbuffer_dma_declare_all( NAME, TYPE, ... )	\
+	ringbuffer_dma_type_def( NAME, TYPE, __VA_ARGS__ );	\
+	\
+	ringbuffer_init_storage_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_init_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_count_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_empty_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_full_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_push_front_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_back_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_stats_snapshot_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_alloc_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_free_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_in_prepare_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_in_finish_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_out_prepare_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_dma_out_finish_decl( NAME, __VA_ARGS__ )
+
+/** @} end DMA ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** DMA ring buffer function definition macros. @{ */
+
+#define	ringbuffer_dma_alloc_def( NAME, ... )	\
+	int	NAME ## _dma_alloc ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct device *dev, size_t len, gfp_t gfp )	{\
+		DATA_TYPE( NAME )	*ptr;	\
+		dma_addr_t	handle;	\
+		if ( !RINGBUF_LEN_VALID( NAME, len ) ) return -EINVAL;	\
+		if ( !( ptr = dma_alloc_coherent( dev, RINGBUF_STORAGE_SIZE( NAME, len ), &handle, gfp ) ) )	\
+			return -ENOMEM;	\
+		NAME ## _init_storage( rb, ptr, len );	\
+		rb->output_cache = rb->input_cache = 0;	\
+		rb->dev		= dev;	\
+		rb->dma_handle	= handle;	\
+		return 0; }
+
+#define	ringbuffer_dma_free_def( NAME, ... )	\
+	void	NAME ## _dma_free ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
+		if ( rb->data_buffer )	\
+			dma_free_coherent( rb->dev, RINGBUF_STORAGE_SIZE( NAME, RINGBUF_CAPACITY( rb ) ),	\
+				( void * )rb->data_buffer, rb->dma_handle );	\
+		rb->data_buffer		= NULL;	\
+		rb->storage.mask	= rb->storage.linear = 0; }
+
+#define	ringbuffer_dma_in_prepare_def( NAME, ... )	\
+	unsigned int	NAME ## _dma_in_prepare ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		struct scatterlist *sgl, int nents, size_t len )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	n, first;	\
+		RINGBUF_SPSC_FREE_( NAME, rb, input, len, n );	\
+		first	= RINGBUF_SPAN_FIRST( rb, input, n );	\
+		return ring_buffer_dma_sg( sgl, nents, rb->dma_handle,	\
+			RINGBUF_WRAP( rb, input ) * sizeof( DATA_TYPE( NAME ) ),	\
+			first * sizeof( DATA_TYPE( NAME ) ), ( n - first ) * sizeof( DATA_TYPE( NAME ) ) ); }
+
+#define	ringbuffer_dma_in_finish_def( NAME, ... )	\
+	ringbuffer_dma_in_finish_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+/** Same as `_commit`: `push_batch_callback` (or `CB`) sees the segments, then `input` is released. */
+#define	ringbuffer_dma_in_finish_cb_def( NAME, CB, ... )	\
+	void	NAME ## _dma_in_finish ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )	\
+	{ NAME ## _index_t input = rb->input;	\
+	  RINGBUF_CHECK( len <= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+	  RINGBUF_BATCH_( CB, rb, input, len );	\
+	  RINGBUF_STORE_RELEASE( &rb->input, input + len );	\
+	  RINGBUF_STAT_IN( rb, pushes, len ); }
+
+#define	ringbuffer_dma_out_prepare_def( NAME, ... )	\
+	unsigned int	NAME ## _dma_out_prepare ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		struct scatterlist *sgl, int nents, size_t len )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	n, first;	\
+		RINGBUF_SPSC_USED_( NAME, rb, output, len, n );	\
+		first	= RINGBUF_SPAN_FIRST( rb, output, n );	\
+		return ring_buffer_dma_sg( sgl, nents, rb->dma_handle,	\
+			RINGBUF_WRAP( rb, output ) * sizeof( DATA_TYPE( NAME ) ),	\
+			first * sizeof( DATA_TYPE( NAME ) ), ( n - first ) * sizeof( DATA_TYPE( NAME ) ) ); }
+
+#define	ringbuffer_dma_out_finish_def( NAME, ... )	\
+	void	NAME ## _dma_out_finish ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )	\
+	{ RINGBUF_CHECK( len <= ( NAME ## _index_t )( RINGBUF_LOAD_RELAXED( &rb->input ) - rb->output ) );	\
+	  RINGBUF_STORE_RELEASE( &rb->output, rb->output + len );	\
+	  RINGBUF_STAT_OUT( rb, pops, len ); }
+
+// --------------------------------------
+/** Storage helpers from ring_buffer_dynamic.h, element functions from ring_buffer_spsc.h. */
+#define ringbuffer_dma_define_all( NAME, ... )	\
+	ringbuffer_init_storage_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_define_all( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_alloc_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_free_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_in_prepare_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_in_finish_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_out_prepare_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_dma_out_finish_def( NAME, __VA_ARGS__ )
+
+/** @} end DMA ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_DMA_H
@@ -0,0 +1,141 @@
+#ifndef	RING_BUFFER_DYNAMIC_H
+#	define	RING_BUFFER_DYNAMIC_H
+
+/** Runtime-sized ring buffer with caller-provided storage.
+ *
+ * Same function set as ring_buffer.h (and the bulk/string extensions), but
+ * `data_buffer` is a pointer to storage handed in at runtime, and the index mask
+ * is kept in the control structure. RINGBUF_WRAP/RINGBUF_CAPACITY pick the
+ * runtime mask automatically, so every function macro works unchanged.
+ *
+ * \note	Storage length \b must be a power of two, at most half the index range
+ * 	(see RINGBUF_LEN_VALID).
+ * \note	BUFFER_LEN( NAME ) is a compile-time helper and does \b not apply here:
+ * 	use RINGBUF_CAPACITY( rb ) instead.
+ *
+ * Usage
+ * -----
+ *
+ * Use `ringbuffer_dyn_declare_all( NAME, TYPE )`/`ringbuffer_dyn_define_all( NAME )`
+ * as with ring_buffer.h, then attach storage before use:
+ *
+ * \code
+	ringbuffer_dyn_declare_all( samples, int );
+	ringbuffer_dyn_define_all( samples )
+
+	samples	rb;
+	int	*mem = arena_alloc( arena, RINGBUF_STORAGE_SIZE( samples, cfg_len ) );
+
+	if ( !samples_init_storage( &rb, mem, cfg_len ) )
+		return -EINVAL;
+	samples_init( &rb, NULL );	// Optional: set push_callback.
+ * \endcode
+ */
+
+
+#include "ring_buffer.h"
+
+
+/// Bytes of storage needed for `len` elements (e.g. for arena allocation).
+#define	RINGBUF_STORAGE_SIZE( NAME, len )	( ( size_t )( len ) * sizeof( DATA_TYPE( NAME ) ) )
+
+/** True if `len` is a valid storage length for `NAME`: the runtime RINGBUF_LEN_ASSERT.
+ *
+ * Non-zero power of two, and at most half the index range, so free-running
+ * indices can still tell a full ring from an empty one.
+ */
+#define	RINGBUF_LEN_VALID( NAME, len )	\
+	( ( len ) && !( ( len ) & ( ( len ) - 1 ) )	\
+	  && ( unsigned long long )( len ) - 1 <= ( ( unsigned long long )( NAME ## _index_t )~( NAME ## _index_t )0 >> 1 ) )
+
+
+// --------------------------------------
+/** Define runtime-sized ring buffer control structure.
+ *
+ * \var storage		Runtime mask and linear span. Must be the first member (see RINGBUF_MASK).
+ * \var input		Input index in data_buffer.
+ * \var output		Output index in data_buffer.
+ * \var data_buffer	Caller-provided storage.
+ * \var push_callback	Custom action to perform on element insertion.
+ * \var push_batch_callback	Custom action on each segment written by bulk pushes.
+ * \var stats_in, stats_out	Instrumentation counters (`RINGBUF_STATS` only).
+ */
+#define ringbuffer_dyn_type_def( NAME, TYPE, ... )	\
+	typedef struct ring_buffer_ ## NAME NAME;	\
+	typedef index_t NAME ## _index_t;	\
+	typedef bool ( * NAME ## _push_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb, TYPE *data );	\
+	typedef void ( * NAME ## _push_batch_callback_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) TYPE *first, size_t n );	\
+	\
+	struct ring_buffer_ ## NAME	\
+	{					\
+		struct ring_buffer_storage	storage;	\
+		NAME ## _index_t	input;	\
+		NAME ## _index_t	output;	\
+		TYPE	*data_buffer;		\
+		NAME ## _push_callback_t	push_callback;	\
+		NAME ## _push_batch_callback_t	push_batch_callback;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		RINGBUF_STATS_OUT_FIELDS	\
+	}
+
+
+// --------------------------------------
+/** Runtime-sized ring buffer declaration macros. @{ */
+
+/** Attach `len` elements of storage at `ptr` and reset the ring-buffer.
+ *
+ * \return	false if `len` is not a power of two or too large for the index type
+ * 	(the ring-buffer is left untouched).
+ */
+#define	ringbuffer_init_storage_decl( NAME, ... )	\
+	bool	NAME ## _init_storage( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *ptr, size_t len )
+
+#define ringbuffer_dyn_declare_all( NAME, TYPE, ... )	\
+	ringbuffer_dyn_type_def( NAME, TYPE, __VA_ARGS__ );	\
+	\
+	ringbuffer_init_storage_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_init_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_count_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_empty_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_full_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_push_front_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_back_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_stats_snapshot_decl( NAME, __VA_ARGS__ )
+
+/** @} end Runtime-sized ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Runtime-sized ring buffer function definition macros. @{ */
+
+#define	ringbuffer_init_storage_def( NAME, ... )	\
+	bool	NAME ## _init_storage( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *ptr, size_t len )	{\
+		if ( !RINGBUF_LEN_VALID( NAME, len ) ) return false;	\
+		rb->storage.mask	= len - 1;	\
+		rb->storage.linear	= len;	\
+		rb->data_buffer		= ptr;	\
+		rb->input = rb->output	= 0;	\
+		rb->push_callback	= NULL;	\
+		rb->push_batch_callback	= NULL;	\
+		RINGBUF_STATS_RESET( rb );	\
+		return true; }
+
+#define ringbuffer_dyn_define_all( NAME, ... )	\
+	ringbuffer_init_storage_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_define_all( NAME, __VA_ARGS__ )
+
+/** @} end Runtime-sized ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_DYNAMIC_H
@@ -0,0 +1,230 @@
+#ifndef	RING_BUFFER_GROUP_H
+#	define	RING_BUFFER_GROUP_H
+
+/** Sharded ring group: one SPSC ring-buffer per producer, work-stealing consumers.
+ *
+ * Instead of one MPMC queue every producer contends on, each producer (e.g. per
+ * core) owns shard `i` and pushes with the plain SPSC functions, never sharing a
+ * cache line with another producer. Consumers drain their home shards in
+ * round-robin with batch pops and, when idle, steal half of the fullest other
+ * shard's pending span. Delivery stays FIFO per shard within each batch (near-FIFO
+ * per source overall, since owner and stealer batches may interleave).
+ *
+ * \code
+	ringbuffer_spsc_declare_all( ev_ring, struct event, 1024 );
+	ringbuffer_spsc_define_all( ev_ring )
+	ringbuffer_spsc_bulk_define_all( ev_ring )	// `_pop_n` is required.
+
+	ringbuffer_group_declare_all( events, ev_ring, NR_CPUS );
+	ringbuffer_group_define_all( events, ev_ring )
+
+	events_init( &g );
+
+	// Producer on CPU `cpu`:
+	ev_ring_push_front( RINGBUF_GROUP_SHARD( &g, cpu ), &ev );
+
+	// Consumer `k` of `m`, owning a slice of the shards:
+	struct ring_buffer_group_cursor	c;
+	ring_buffer_group_cursor_init( &c, k * NR_CPUS / m, NR_CPUS / m, 32 );
+
+	while ( run )
+	{
+		size_t	n	= events_drain( &g, &c, batch, ARRAY_COUNT( batch ) );
+		if ( !n ) n	= events_steal( &g, &c, batch, ARRAY_COUNT( batch ) );
+		dispatch( batch, n );
+	}
+ * \endcode
+ *
+ * \note	The consumer side of each shard is serialised by a per-shard try-lock
+ * 	(one atomic per batch, skipped for empty shards): nobody ever spins on it, a
+ * 	busy shard is just passed over. Producers never touch it.
+ * \note	Never call `RING_pop_back`/`_pop_n`/`_peek` on a shard directly while any
+ * 	consumer may use the group.
+ */
+
+
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+
+#ifdef __KERNEL__
+#	include <linux/spinlock.h>
+#endif
+
+
+/** Ring group helpers. @{ */
+
+#ifdef __KERNEL__
+typedef	spinlock_t	ring_buffer_group_lock_t;
+
+#	define	ring_buffer_group_lock_init( l )	spin_lock_init( l )
+#	define	ring_buffer_group_trylock( l )		spin_trylock( l )
+#	define	ring_buffer_group_unlock( l )		spin_unlock( l )
+#else
+typedef	uint32_t	ring_buffer_group_lock_t;
+
+#	define	ring_buffer_group_lock_init( l )	RINGBUF_STORE_RELAXED( ( l ), 0 )
+/// Test before exchanging, so a held lock costs a shared read only.
+#	define	ring_buffer_group_trylock( l )	\
+		( !RINGBUF_LOAD_RELAXED( l ) && !__atomic_exchange_n( ( l ), 1, __ATOMIC_ACQUIRE ) )
+#	define	ring_buffer_group_unlock( l )		RINGBUF_STORE_RELEASE( ( l ), 0 )
+#endif
+
+/** Consumer-private round-robin state.
+ *
+ * \var next	Next home shard to visit, relative to `first`.
+ * \var first	First home shard.
+ * \var count	Home shards (`first .. first + count - 1`).
+ * \var batch	Most elements popped from a shard per visit.
+ */
+struct ring_buffer_group_cursor
+{
+	unsigned	next;
+	unsigned	first;
+	unsigned	count;
+	size_t		batch;
+};
+
+static inline void	ring_buffer_group_cursor_init ( struct ring_buffer_group_cursor *c,
+	unsigned first, unsigned count, size_t batch )
+{
+	c->next		= 0;
+	c->first	= first;
+	c->count	= count;
+	c->batch	= batch ? batch : SIZE_MAX;
+}
+
+/// Get the number of shards of a group.
+#define	RINGBUF_GROUP_SHARDS( g )	ARRAY_COUNT( ( g )->shard )
+
+/// Get shard `i` ring-buffer (for its producer).
+#define	RINGBUF_GROUP_SHARD( g, i )	( &( g )->shard[ ( i ) ].ring )
+
+/** @} end Ring group helpers. */
+
+
+// --------------------------------------
+/** Define ring group control structure.
+ *
+ * \var shard	Per-producer SPSC ring-buffer (`RING`) and its consumer try-lock,
+ * 	each on its own cache lines.
+ */
+#define ringbuffer_group_type_def( NAME, RING, SHARDS )	\
+	typedef struct ring_buffer_group_ ## NAME NAME;	\
+	\
+	struct ring_buffer_group_ ## NAME	\
+	{					\
+		struct	\
+		{	\
+			RING	ring	RINGBUF_CACHELINE_ALIGNED;	\
+			ring_buffer_group_lock_t	lock	RINGBUF_CACHELINE_ALIGNED;	\
+		}	shard[ SHARDS ];	\
+	}
+
+
+// --------------------------------------
+/** Ring group declaration macros. @{ */
+
+/** Reset every shard (no callbacks). */
+#define	ringbuffer_group_init_decl( NAME, RING )	\
+	void	NAME ## _init ( NAME *g )
+
+/** Pop up to `limit` elements from the home shards in round-robin, at most `c->batch` per shard.
+ *
+ * One pass at most: each home shard is visited once, resuming after the last one visited.
+ * \return	Elements popped into `dest`.
+ */
+#define	ringbuffer_group_drain_decl( NAME, RING )	\
+	size_t	NAME ## _drain ( NAME *g, struct ring_buffer_group_cursor *c,	\
+		DATA_TYPE( RING ) *dest, size_t limit )
+
+/** Pop half (rounded up, at most `limit`) of the fullest non-home shard's pending elements.
+ *
+ * \return	Elements stolen into `dest` (0 if all others are empty or the victim is busy).
+ */
+#define	ringbuffer_group_steal_decl( NAME, RING )	\
+	size_t	NAME ## _steal ( NAME *g, struct ring_buffer_group_cursor *c,	\
+		DATA_TYPE( RING ) *dest, size_t limit )
+
+/** Pending elements over all shards. Just a snapshot. */
+#define	ringbuffer_group_count_decl( NAME, RING )	\
+	size_t	NAME ## _count ( NAME *g )
+
+// --------------------------------------
+#define ringbuffer_group_declare_all( NAME, RING, SHARDS )	\
+	ringbuffer_group_type_def( NAME, RING, SHARDS );	\
+	\
+	ringbuffer_group_init_decl( NAME, RING );	\
+	\
+	ringbuffer_group_drain_decl( NAME, RING );	\
+	\
+	ringbuffer_group_steal_decl( NAME, RING );	\
+	\
+	ringbuffer_group_count_decl( NAME, RING )
+
+/** @} end Ring group declaration macros. */
+
+
+// --------------------------------------
+/** Ring group function definition macros. @{ */
+
+#define	ringbuffer_group_init_def( NAME, RING )	\
+	void	NAME ## _init ( NAME *g )	{\
+		size_t	i;	\
+		for ( i = 0; i < RINGBUF_GROUP_SHARDS( g ); i++ )	\
+		{ RING ## _init( &g->shard[ i ].ring, NULL );	\
+		  ring_buffer_group_lock_init( &g->shard[ i ].lock ); } }
+
+#define	ringbuffer_group_drain_def( NAME, RING )	\
+	size_t	NAME ## _drain ( NAME *g, struct ring_buffer_group_cursor *c,	\
+		DATA_TYPE( RING ) *dest, size_t limit )	{\
+		size_t	done	= 0, want;	\
+		unsigned	i, s;	\
+		for ( i = 0; i < c->count && done < limit; i++ )	\
+		{ s	= c->first + c->next;	\
+		  if ( ++c->next == c->count ) c->next = 0;	\
+		  if ( RING ## _empty( &g->shard[ s ].ring ) || !ring_buffer_group_trylock( &g->shard[ s ].lock ) )	\
+			continue;	\
+		  want	= limit - done;	\
+		  if ( want > c->batch ) want = c->batch;	\
+		  done	+= RING ## _pop_n( &g->shard[ s ].ring, dest + done, want );	\
+		  ring_buffer_group_unlock( &g->shard[ s ].lock ); }	\
+		return done; }
+
+/** Victim choice is a snapshot; the amount is re-read under the victim's lock. */
+#define	ringbuffer_group_steal_def( NAME, RING )	\
+	size_t	NAME ## _steal ( NAME *g, struct ring_buffer_group_cursor *c,	\
+		DATA_TYPE( RING ) *dest, size_t limit )	{\
+		size_t	best	= 0, n;	\
+		unsigned	i, v	= 0;	\
+		for ( i = 0; i < RINGBUF_GROUP_SHARDS( g ); i++ )	\
+		{ if ( ( unsigned )( i - c->first ) < c->count ) continue;	/* Home shard. */	\
+		  if ( ( n = RING ## _count( &g->shard[ i ].ring ) ) > best ) { best = n; v = i; } }	\
+		if ( !best || !ring_buffer_group_trylock( &g->shard[ v ].lock ) )	\
+			return 0;	\
+		n	= ( RING ## _count( &g->shard[ v ].ring ) + 1 ) / 2;	\
+		if ( n > limit ) n = limit;	\
+		n	= RING ## _pop_n( &g->shard[ v ].ring, dest, n );	\
+		ring_buffer_group_unlock( &g->shard[ v ].lock );	\
+		return n; }
+
+#define	ringbuffer_group_count_def( NAME, RING )	\
+	size_t	NAME ## _count ( NAME *g )	{\
+		size_t	i, n	= 0;	\
+		for ( i = 0; i < RINGBUF_GROUP_SHARDS( g ); i++ )	\
+			n	+= RING ## _count( &g->shard[ i ].ring );	\
+		return n; }
+
+// --------------------------------------
+#define ringbuffer_group_define_all( NAME, RING )	\
+	ringbuffer_group_init_def( NAME, RING )	\
+	\
+	ringbuffer_group_drain_def( NAME, RING )	\
+	\
+	ringbuffer_group_steal_def( NAME, RING )	\
+	\
+	ringbuffer_group_count_def( NAME, RING )
+
+/** @} end Ring group function definition macros. */
+
+
+#endif	// RING_BUFFER_GROUP_H
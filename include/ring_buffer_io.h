@@ -0,0 +1,261 @@
+#ifndef	RING_BUFFER_IO_H
+#	define	RING_BUFFER_IO_H
+
+/** Vectored I/O straight into/out of byte ring buffers.
+ *
+ * The free (or used) span is split around the RINGBUF_WRAP boundary into at most
+ * two segments, handed to a single system call, and the index is published once
+ * for whatever was transferred: one syscall per batch and no bounce buffer.
+ *
+ * User space: `_read_fd`/`_write_fd` (readv/writev) and `_recv_fd`/`_send_fd`
+ * (recvmsg/sendmsg, with `MSG_*` flags) on any file descriptor.
+ * Kernel: `_from_user`/`_to_user` (copy_from_user/copy_to_user), e.g. for the
+ * write()/read() handlers of a char driver.
+ *
+ * All return the number of bytes moved, or a negative errno: -ENOBUFS when
+ * reading into a full ring-buffer, the syscall `-errno`, or -EFAULT.
+ *
+ * \code
+	ringbuffer_spsc_declare_all( rx, uint8_t, 65536 );
+	ringbuffer_spsc_define_all( rx )
+	ringbuffer_io_declare_all( rx );
+	ringbuffer_io_define_all( rx )
+
+	ssize_t	got = rx_read_fd( rb, sock, SIZE_MAX );
+ * \endcode
+ *
+ * \note	Byte (`uint8_t`/`char`) ring-buffers only.
+ * \note	Reads call `push_batch_callback` like the bulk pushes (see ring_buffer_bulk.h);
+ * 	the `_cb_def` forms bind `CB` at compile time.
+ * \note	With `RINGBUF_STATS`, bytes moved count as `pushes`/`pops` and drains of an
+ * 	empty ring as `empty_polls`. Reads into a full ring (-ENOBUFS) don't count
+ * 	`rejected_pushes`: nothing was taken from the source.
+ */
+
+
+#include "ring_buffer.h"
+#include "ring_buffer_bulk.h"
+
+#ifdef __KERNEL__
+#	include <linux/uaccess.h>
+#	include <linux/errno.h>
+#else
+#	include <errno.h>
+#	include <sys/types.h>
+#	include <sys/uio.h>
+#	include <sys/socket.h>
+#endif
+
+
+/** I/O helpers. @{ */
+
+/// Don't use. Fail the build for non-byte ring-buffers.
+#define	RINGBUF_IO_BYTES_( NAME )	\
+	_Static_assert( sizeof( DATA_TYPE( NAME ) ) == 1, #NAME " is not a byte ring-buffer" )
+
+#ifndef __KERNEL__
+
+/// Don't use. Fill `iov` with the (up to two) segments of a `n` bytes span at `index`; returns the segment count.
+#define	RINGBUF_IOV_( rb, index, n, iov )	(	\
+	( iov )[ 0 ].iov_base	= ( void * )&( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ],	\
+	( iov )[ 0 ].iov_len	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) ),	\
+	( iov )[ 1 ].iov_base	= ( void * )&( rb )->data_buffer[ 0 ],	\
+	( iov )[ 1 ].iov_len	= ( n ) - ( iov )[ 0 ].iov_len,	\
+	( iov )[ 1 ].iov_len ? 2 : 1 )
+
+#endif
+
+/** @} end I/O helpers. */
+
+
+// --------------------------------------
+/** Vectored I/O declaration macros. @{ */
+
+#ifdef __KERNEL__
+
+/** Copy up to `max` bytes from user space `buf` into the ring-buffer. */
+#define	ringbuffer_from_user_decl( NAME, ... )	\
+	ssize_t	NAME ## _from_user ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const char __user *buf, size_t max )
+
+/** Copy up to `max` bytes from the ring-buffer to user space `buf`. */
+#define	ringbuffer_to_user_decl( NAME, ... )	\
+	ssize_t	NAME ## _to_user ( DECL_qualif( __VA_ARGS__ ) NAME *rb, char __user *buf, size_t max )
+
+#define ringbuffer_io_declare_all( NAME, ... )	\
+	ringbuffer_from_user_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_to_user_decl( NAME, __VA_ARGS__ )
+
+#else
+
+/** readv() up to `max` bytes from `fd` into the ring-buffer. */
+#define	ringbuffer_read_fd_decl( NAME, ... )	\
+	ssize_t	NAME ## _read_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max )
+
+/** writev() up to `max` bytes from the ring-buffer to `fd`. */
+#define	ringbuffer_write_fd_decl( NAME, ... )	\
+	ssize_t	NAME ## _write_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max )
+
+/** recvmsg() up to `max` bytes from socket `fd` into the ring-buffer. */
+#define	ringbuffer_recv_fd_decl( NAME, ... )	\
+	ssize_t	NAME ## _recv_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max, int flags )
+
+/** sendmsg() up to `max` bytes from the ring-buffer to socket `fd`. */
+#define	ringbuffer_send_fd_decl( NAME, ... )	\
+	ssize_t	NAME ## _send_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max, int flags )
+
+#define ringbuffer_io_declare_all( NAME, ... )	\
+	ringbuffer_read_fd_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_write_fd_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_recv_fd_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_send_fd_decl( NAME, __VA_ARGS__ )
+
+#endif
+
+/** @} end Vectored I/O declaration macros. */
+
+
+// --------------------------------------
+/** Vectored I/O definition macros. @{ */
+
+#ifdef __KERNEL__
+
+/** copy_from_user() returns the bytes left over, so each segment commits what actually arrived. */
+#define	ringbuffer_from_user_def( NAME, ... )	\
+	ringbuffer_from_user_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_from_user_cb_def( NAME, CB, ... )	\
+	ssize_t	NAME ## _from_user ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const char __user *buf, size_t max )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	n	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) ), first, done;	\
+		RINGBUF_IO_BYTES_( NAME );	\
+		if ( n > max ) n = max;	\
+		if ( !n ) return -ENOBUFS;	\
+		first	= RINGBUF_SPAN_FIRST( rb, input, n );	\
+		done	= first - copy_from_user( ( void * )&rb->data_buffer[ RINGBUF_WRAP( rb, input ) ], buf, first );	\
+		if ( done == first && n > first )	\
+			done	+= ( n - first ) - copy_from_user( ( void * )&rb->data_buffer[ 0 ], buf + first, n - first );	\
+		if ( !done ) return -EFAULT;	\
+		RINGBUF_BATCH_( CB, rb, input, done );	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + done );	\
+		RINGBUF_STAT_IN( rb, pushes, done );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + done - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+		return ( ssize_t )done; }
+
+#define	ringbuffer_to_user_def( NAME, ... )	\
+	ssize_t	NAME ## _to_user ( DECL_qualif( __VA_ARGS__ ) NAME *rb, char __user *buf, size_t max )	{\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	n	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output ), first, done;	\
+		RINGBUF_IO_BYTES_( NAME );	\
+		if ( n > max ) n = max;	\
+		if ( !n ) { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return 0; }	\
+		first	= RINGBUF_SPAN_FIRST( rb, output, n );	\
+		done	= first - copy_to_user( buf, ( const void * )&rb->data_buffer[ RINGBUF_WRAP( rb, output ) ], first );	\
+		if ( done == first && n > first )	\
+			done	+= ( n - first ) - copy_to_user( buf + first, ( const void * )&rb->data_buffer[ 0 ], n - first );	\
+		if ( !done ) return -EFAULT;	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + done );	\
+		RINGBUF_STAT_OUT( rb, pops, done );	\
+		return ( ssize_t )done; }
+
+// --------------------------------------
+#define ringbuffer_io_define_all( NAME, ... )	\
+	ringbuffer_from_user_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_to_user_def( NAME, __VA_ARGS__ )
+
+#define ringbuffer_io_define_all_cb( NAME, CB, ... )	\
+	ringbuffer_from_user_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_to_user_def( NAME, __VA_ARGS__ )
+
+#else
+
+/// Don't use. Body of the fill side: `CALL` transfers into `iov`/`cnt_`, returning bytes or -1.
+#define	RINGBUF_IO_IN_( NAME, CB, rb, max, CALL )	\
+	NAME ## _index_t input	= rb->input;	\
+	size_t	n	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+	struct iovec	iov[ 2 ];	\
+	int	cnt_;	\
+	ssize_t	got;	\
+	RINGBUF_IO_BYTES_( NAME );	\
+	if ( n > max ) n = max;	\
+	if ( !n ) return -ENOBUFS;	\
+	cnt_	= RINGBUF_IOV_( rb, input, n, iov );	\
+	if ( ( got = ( CALL ) ) < 0 ) return -errno;	\
+	RINGBUF_BATCH_( CB, rb, input, ( size_t )got );	\
+	RINGBUF_STORE_RELEASE( &rb->input, input + ( size_t )got );	\
+	RINGBUF_STAT_IN( rb, pushes, ( size_t )got );	\
+	RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + ( size_t )got - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+	return got;
+
+/// Don't use. Body of the drain side: `CALL` transfers from `iov`/`cnt_`, returning bytes or -1.
+#define	RINGBUF_IO_OUT_( NAME, rb, max, CALL )	\
+	NAME ## _index_t output	= rb->output;	\
+	size_t	n	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output );	\
+	struct iovec	iov[ 2 ];	\
+	int	cnt_;	\
+	ssize_t	put;	\
+	RINGBUF_IO_BYTES_( NAME );	\
+	if ( n > max ) n = max;	\
+	if ( !n ) { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return 0; }	\
+	cnt_	= RINGBUF_IOV_( rb, output, n, iov );	\
+	if ( ( put = ( CALL ) ) < 0 ) return -errno;	\
+	RINGBUF_STORE_RELEASE( &rb->output, output + ( size_t )put );	\
+	RINGBUF_STAT_OUT( rb, pops, ( size_t )put );	\
+	return put;
+
+/// Don't use. `struct msghdr` over `iov`/`cnt_`.
+#define	RINGBUF_MSGHDR_( iov, cnt )	\
+	&( struct msghdr ){ .msg_iov = ( iov ), .msg_iovlen = ( size_t )( cnt ) }
+
+#define	ringbuffer_read_fd_def( NAME, ... )	\
+	ringbuffer_read_fd_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_read_fd_cb_def( NAME, CB, ... )	\
+	ssize_t	NAME ## _read_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max )	{\
+		RINGBUF_IO_IN_( NAME, CB, rb, max, readv( fd, iov, cnt_ ) ) }
+
+#define	ringbuffer_write_fd_def( NAME, ... )	\
+	ssize_t	NAME ## _write_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max )	{\
+		RINGBUF_IO_OUT_( NAME, rb, max, writev( fd, iov, cnt_ ) ) }
+
+#define	ringbuffer_recv_fd_def( NAME, ... )	\
+	ringbuffer_recv_fd_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_recv_fd_cb_def( NAME, CB, ... )	\
+	ssize_t	NAME ## _recv_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max, int flags )	{\
+		RINGBUF_IO_IN_( NAME, CB, rb, max, recvmsg( fd, RINGBUF_MSGHDR_( iov, cnt_ ), flags ) ) }
+
+#define	ringbuffer_send_fd_def( NAME, ... )	\
+	ssize_t	NAME ## _send_fd ( DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, size_t max, int flags )	{\
+		RINGBUF_IO_OUT_( NAME, rb, max, sendmsg( fd, RINGBUF_MSGHDR_( iov, cnt_ ), flags ) ) }
+
+// --------------------------------------
+#define ringbuffer_io_define_all( NAME, ... )	\
+	ringbuffer_read_fd_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_write_fd_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_recv_fd_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_send_fd_def( NAME, __VA_ARGS__ )
+
+#define ringbuffer_io_define_all_cb( NAME, CB, ... )	\
+	ringbuffer_read_fd_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_write_fd_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_recv_fd_cb_def( NAME, CB, __VA_ARGS__ )	\
+	\
+	ringbuffer_send_fd_def( NAME, __VA_ARGS__ )
+
+#endif
+
+/** @} end Vectored I/O definition macros. */
+
+
+#endif	// RING_BUFFER_IO_H
@@ -0,0 +1,172 @@
+#ifndef	RING_BUFFER_MIRROR_H
+#	define	RING_BUFFER_MIRROR_H
+
+/** Virtual-memory mirrored storage for runtime-sized ring buffers (user space only).
+ *
+ * The same physical pages are mapped twice back-to-back, so data_buffer[ i ] and
+ * data_buffer[ i + capacity ] alias each other. RINGBUF_LINEAR then reports twice
+ * the capacity, and every span starting inside the ring is contiguous:
+ * `_reserve`/`_peek_span` always return a single segment (`ptr2` is NULL) and the
+ * bulk copies never split, so decoders can run directly on ring memory.
+ *
+ * \note	Works on ring-buffers generated with ring_buffer_dynamic.h.
+ * \note	Length \b must be a power of two and `len * sizeof( TYPE )` a multiple
+ * 	of the page size.
+ *
+ * \code
+	ringbuffer_dyn_declare_all( frames, uint8_t );
+	ringbuffer_dyn_define_all( frames )
+	ringbuffer_mirror_declare_all( frames );
+	ringbuffer_mirror_define_all( frames )
+
+	if ( !frames_init_mirror( &rb, 1 << 16 ) )
+		return -1;
+	// ...
+	frames_free_mirror( &rb );
+ * \endcode
+ */
+
+
+#ifdef __KERNEL__
+#	error	"ring_buffer_mirror.h is user space only."
+#endif
+
+#ifndef	_GNU_SOURCE
+#	define	_GNU_SOURCE	// memfd_create, if nothing included <features.h> yet.
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "ring_buffer_dynamic.h"
+
+
+/** Mirror mapping helpers. @{ */
+
+/** Don't use. Anonymous shared-memory file: a memfd if `memfd_create` is declared
+ * (`_GNU_SOURCE` in effect where the system headers were first included), else a
+ * POSIX segment unlinked as soon as it is open.
+ *
+ * \return	File descriptor, or -1 (errno set).
+ */
+static inline int	ring_buffer_mirror_fd_ ( void )
+{
+#ifdef	MFD_CLOEXEC
+	return memfd_create( "ring_buffer", MFD_CLOEXEC );
+#else
+	static unsigned	seq;
+	char	name[ 48 ];
+	int	fd, tries;
+
+	for ( tries = 0; tries < 16; ++tries )
+	{
+		snprintf( name, sizeof( name ), "/ring_buffer.%ld.%u", ( long )getpid(),
+			__atomic_fetch_add( &seq, 1, __ATOMIC_RELAXED ) );
+		if ( ( fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600 ) ) >= 0 )
+		{
+			shm_unlink( name );
+			return fd;
+		}
+		if ( errno != EEXIST )
+			break;
+	}
+
+	return -1;
+#endif
+}
+
+/** Map `bytes` of shared memory twice back-to-back.
+ *
+ * \return	Base of the 2 * `bytes` mapping, or NULL on failure.
+ */
+static inline void	*ring_buffer_mirror_map ( size_t bytes )
+{
+	long	page	= sysconf( _SC_PAGESIZE );
+	char	*base;
+	int	fd;
+
+	if ( !bytes || page <= 0 || bytes % ( size_t )page )
+		return NULL;
+
+	if ( ( fd = ring_buffer_mirror_fd_() ) < 0 )
+		return NULL;
+
+	/* Reserve the whole window first, then pin both halves on the same pages. */
+	base = ( ftruncate( fd, ( off_t )bytes ) == 0 )
+		? mmap( NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 )
+		: MAP_FAILED;
+
+	if ( base != MAP_FAILED
+		&& ( mmap( base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED
+		  || mmap( base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ) )
+	{
+		munmap( base, 2 * bytes );
+		base = MAP_FAILED;
+	}
+
+	close( fd );	// The mappings keep the pages alive.
+
+	return base == MAP_FAILED ? NULL : base;
+}
+
+static inline void	ring_buffer_mirror_unmap ( void *base, size_t bytes )
+{
+	if ( base )
+		munmap( base, 2 * bytes );
+}
+
+/** @} end Mirror mapping helpers. */
+
+
+// --------------------------------------
+/** Mirrored ring buffer declaration macros. @{ */
+
+/** Map mirrored storage for `len` elements and reset the ring-buffer.
+ *
+ * \return	false if `len` does not meet the size rules or the mapping fails.
+ */
+#define	ringbuffer_init_mirror_decl( NAME, ... )	\
+	bool	NAME ## _init_mirror ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )
+
+/** Unmap storage set up by `_init_mirror`. */
+#define	ringbuffer_free_mirror_decl( NAME, ... )	\
+	void	NAME ## _free_mirror ( DECL_qualif( __VA_ARGS__ ) NAME *rb )
+
+#define ringbuffer_mirror_declare_all( NAME, ... )	\
+	ringbuffer_init_mirror_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_free_mirror_decl( NAME, __VA_ARGS__ )
+
+/** @} end Mirrored ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Mirrored ring buffer function definition macros. @{ */
+
+#define	ringbuffer_init_mirror_def( NAME, ... )	\
+	bool	NAME ## _init_mirror ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t len )	{\
+		DATA_TYPE( NAME )	*ptr;	\
+		if ( !RINGBUF_LEN_VALID( NAME, len ) ) return false;	\
+		if ( !( ptr = ring_buffer_mirror_map( RINGBUF_STORAGE_SIZE( NAME, len ) ) ) ) return false;	\
+		NAME ## _init_storage( rb, ptr, len );	\
+		rb->storage.linear	= 2 * len;	/* Both halves are addressable. */	\
+		return true; }
+
+#define	ringbuffer_free_mirror_def( NAME, ... )	\
+	void	NAME ## _free_mirror ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
+		ring_buffer_mirror_unmap( ( void * )rb->data_buffer, RINGBUF_STORAGE_SIZE( NAME, RINGBUF_CAPACITY( rb ) ) );	\
+		rb->data_buffer		= NULL;	\
+		rb->storage.mask	= rb->storage.linear = 0; }
+
+#define ringbuffer_mirror_define_all( NAME, ... )	\
+	ringbuffer_init_mirror_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_free_mirror_def( NAME, __VA_ARGS__ )
+
+/** @} end Mirrored ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_MIRROR_H
@@ -0,0 +1,186 @@
+#ifndef	RING_BUFFER_MPMC_H
+#	define	RING_BUFFER_MPMC_H
+
+/** Multi-producer/multi-consumer bounded lock-free queue.
+ *
+ * Vyukov-style: each slot of data_buffer carries a sequence number that tells
+ * whether it is free for the producer at `input` or ready for the consumer at
+ * `output`, and both indices are claimed with compare-and-swap, so any number
+ * of producers and consumers may run concurrently without a global lock.
+ *
+ * Usage
+ * -----
+ *
+ * As ring_buffer.h, with `ringbuffer_mpmc_declare_all( NAME, TYPE, LEN )` and
+ * `ringbuffer_mpmc_define_all( NAME )`. The generated functions differ slightly:
+ *
+ * \code
+	void		peanuts_init ( peanuts *rb );
+	bool		peanuts_push_front ( peanuts *rb, int *data );
+	bool		peanuts_pop_back ( peanuts *rb, int *data );	// Copies out the popped element.
+	int *		peanuts_peek ( peanuts *rb, index_t offset );	// Approximate.
+	size_t		peanuts_count ( peanuts *rb );			// Approximate.
+	bool		peanuts_empty ( peanuts *rb );			// Approximate.
+	bool		peanuts_full ( peanuts *rb );			// Approximate.
+ * \endcode
+ *
+ * \note	There is no `push_callback`: producers write their slot concurrently.
+ * \note	`_peek` returns an element that was ready at the time of the call; another
+ * 	consumer may pop (and a producer reuse) it at any time afterwards, so it is
+ * 	only meaningful when consumers are otherwise coordinated.
+ */
+
+
+#include "ring_buffer.h"
+
+
+/** MPMC helpers. @{ */
+
+/// Don't use. Signed distance between a slot sequence and an index.
+#define	RINGBUF_SEQ_DIFF_( seq, index )	( ( int32_t )( index_t )( ( seq ) - ( index ) ) )
+
+/// Get MPMC buffer element type.
+#define	MPMC_DATA_TYPE( NAME )	NAME ## _data_t
+
+/** @} end MPMC helpers. */
+
+
+// --------------------------------------
+/** Define MPMC ring buffer control structure.
+ *
+ * \var input		Next index to be claimed by a producer.
+ * \var output		Next index to be claimed by a consumer.
+ * \var data_buffer	Slots: `sequence` plus the element itself (`data`).
+ */
+#define ringbuffer_mpmc_type_def( NAME, TYPE, LEN, ... )	\
+	RINGBUF_LEN_ASSERT( NAME, LEN, index_t );	\
+	\
+	typedef struct ring_buffer_ ## NAME NAME;	\
+	typedef TYPE NAME ## _data_t;	\
+	\
+	struct ring_buffer_ ## NAME	\
+	{					\
+		index_t	input	RINGBUF_CACHELINE_ALIGNED;	\
+		index_t	output	RINGBUF_CACHELINE_ALIGNED;	\
+		struct	\
+		{	\
+			index_t	sequence;	\
+			TYPE	data;		\
+		}	data_buffer[ LEN ]	RINGBUF_CACHELINE_ALIGNED;	\
+	}
+
+
+// --------------------------------------
+/** MPMC ring buffer function declaration macros. @{ */
+
+#define	ringbuffer_mpmc_init_decl( NAME, ... )	\
+	void	NAME ## _init( DECL_qualif( __VA_ARGS__ ) NAME *rb )
+
+#define	ringbuffer_mpmc_push_front_decl( NAME, ... )	\
+	bool	NAME ## _push_front ( DECL_qualif( __VA_ARGS__ ) NAME *rb, MPMC_DATA_TYPE( NAME ) *data )
+
+#define	ringbuffer_mpmc_pop_back_decl( NAME, ... )	\
+	bool	NAME ## _pop_back ( DECL_qualif( __VA_ARGS__ ) NAME *rb, MPMC_DATA_TYPE( NAME ) *data )
+
+#define	ringbuffer_mpmc_peek_decl( NAME, ... )	\
+	DECL_qualif( __VA_ARGS__ ) MPMC_DATA_TYPE( NAME )	*NAME ## _peek ( DECL_qualif( __VA_ARGS__ ) NAME *rb, index_t offset )
+
+// --------------------------------------
+#define ringbuffer_mpmc_declare_all( NAME, TYPE, LEN, ... )	\
+	ringbuffer_mpmc_type_def( NAME, TYPE, LEN, __VA_ARGS__ );	\
+	\
+	ringbuffer_mpmc_init_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_count_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_empty_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_full_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_mpmc_push_front_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_mpmc_pop_back_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_mpmc_peek_decl( NAME, __VA_ARGS__ )
+
+/** @} end MPMC ring buffer function declaration macros. */
+
+
+// --------------------------------------
+/** MPMC ring buffer function definition macros. @{ */
+
+#define	ringbuffer_mpmc_init_def( NAME, ... )	\
+	void	NAME ## _init( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
+		index_t i;	\
+		for ( i = 0; i < BUFFER_LEN( NAME ); ++i )	\
+			RINGBUF_STORE_RELEASE( &rb->data_buffer[ i ].sequence, i );	\
+		RINGBUF_STORE_RELEASE( &rb->output, 0 );	\
+		RINGBUF_STORE_RELEASE( &rb->input, 0 ); }
+
+/** Claim the slot at `input` once its sequence says it is free, then publish it. */
+#define	ringbuffer_mpmc_push_front_def( NAME, ... )	\
+	bool	NAME ## _push_front ( DECL_qualif( __VA_ARGS__ ) NAME *rb, MPMC_DATA_TYPE( NAME ) *data )	{\
+		index_t	pos = RINGBUF_LOAD_RELAXED( &rb->input ), seq;	\
+		for ( ;; )	{	\
+			seq = RINGBUF_LOAD_ACQUIRE( &rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].sequence );	\
+			if ( 0 == RINGBUF_SEQ_DIFF_( seq, pos ) )	\
+			{ if ( RINGBUF_CAS_RELAXED( &rb->input, &pos, pos + 1 ) ) break; }	\
+			else if ( RINGBUF_SEQ_DIFF_( seq, pos ) < 0 )	\
+				return false;	/* Slot not consumed yet: full. */	\
+			else	\
+				pos = RINGBUF_LOAD_RELAXED( &rb->input ); }	\
+		rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].data = *data;	\
+		RINGBUF_STORE_RELEASE( &rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].sequence, pos + 1 );	\
+		return true; }
+
+/** Claim the slot at `output` once its sequence says it is ready, copy it out and recycle it. */
+#define	ringbuffer_mpmc_pop_back_def( NAME, ... )	\
+	bool	NAME ## _pop_back ( DECL_qualif( __VA_ARGS__ ) NAME *rb, MPMC_DATA_TYPE( NAME ) *data )	{\
+		index_t	pos = RINGBUF_LOAD_RELAXED( &rb->output ), seq;	\
+		for ( ;; )	{	\
+			seq = RINGBUF_LOAD_ACQUIRE( &rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].sequence );	\
+			if ( 0 == RINGBUF_SEQ_DIFF_( seq, pos + 1 ) )	\
+			{ if ( RINGBUF_CAS_RELAXED( &rb->output, &pos, pos + 1 ) ) break; }	\
+			else if ( RINGBUF_SEQ_DIFF_( seq, pos + 1 ) < 0 )	\
+				return false;	/* Slot not produced yet: empty. */	\
+			else	\
+				pos = RINGBUF_LOAD_RELAXED( &rb->output ); }	\
+		*data = rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].data;	\
+		RINGBUF_STORE_RELEASE( &rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].sequence,	\
+			pos + BUFFER_LEN( NAME ) );	\
+		return true; }
+
+#define	ringbuffer_mpmc_peek_def( NAME, ... )	\
+	DECL_qualif( __VA_ARGS__ ) MPMC_DATA_TYPE( NAME )	*NAME ## _peek ( DECL_qualif( __VA_ARGS__ ) NAME *rb, index_t offset )	{\
+		index_t	pos = RINGBUF_LOAD_RELAXED( &rb->output ) + offset;	\
+		if ( RINGBUF_LOAD_ACQUIRE( &rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].sequence ) == ( index_t )( pos + 1 ) )	\
+			return &( rb->data_buffer[ RINGBUF_WRAP( rb, pos ) ].data );	\
+		return  NULL; }
+
+/** `output` is read first, so the difference never goes negative; clamp the upper bound. */
+#define	ringbuffer_mpmc_count_def( NAME, ... )	\
+	size_t	NAME ## _count ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	\
+	{ index_t output = RINGBUF_LOAD_ACQUIRE( &rb->output );	\
+	  size_t count = ( index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output );	\
+	  return count < BUFFER_LEN( NAME ) ? count : BUFFER_LEN( NAME ); }
+
+// --------------------------------------
+#define ringbuffer_mpmc_define_all( NAME, ... )	\
+	ringbuffer_mpmc_init_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_mpmc_count_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_empty_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_full_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_mpmc_push_front_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_mpmc_pop_back_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_mpmc_peek_def( NAME, __VA_ARGS__ )
+
+/** @} end MPMC ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_MPMC_H
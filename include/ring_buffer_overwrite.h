@@ -0,0 +1,170 @@
+#ifndef	RING_BUFFER_OVERWRITE_H
+#	define	RING_BUFFER_OVERWRITE_H
+
+/** Overwrite-oldest (lossy) push for telemetry and trace ring buffers.
+ *
+ * When the ring-buffer is full, these pushes drop the stalest elements instead
+ * of the newest one, in a single step, and report how many were dropped.
+ *
+ * Plain ring-buffers (ring_buffer.h)
+ * ----------------------------------
+ *
+ * `_push_overwrite`/`_push_n_overwrite` move `output` forward themselves, so
+ * they are only for ring-buffers without a concurrent consumer.
+ *
+ * SPSC ring-buffers (ring_buffer_spsc.h)
+ * --------------------------------------
+ *
+ * The producer never touches `output`: the `_push_overwrite`/`_push_n_overwrite`
+ * generated by `ringbuffer_spsc_push_overwrite_def`/`ringbuffer_spsc_push_n_overwrite_def`
+ * write and publish `input` unconditionally, and the consumer detects being lapped.
+ * The consumer \b must then use `_pop_overwrite`, which copies the element out,
+ * re-checks `input` and retries if the producer may have rewritten the slot in
+ * the meantime (`_pop_back`/`_peek` cannot detect that).
+ *
+ * The consumer cannot tell a slot `capacity` elements behind `input` from one the
+ * producer is rewriting right now, so in this mode the usable capacity is
+ * `capacity - 1`: the push that would fill the last free slot drops the oldest
+ * element, and reports it. The producer side count of dropped elements is an
+ * estimate (it races the consumer); the consumer side one (`lost`) is exact.
+ *
+ * \note	`push_callback` is \b not invoked by overwriting pushes.
+ * \note	SPSC overwriting needs a capacity of at least 2.
+ */
+
+
+#include "ring_buffer.h"
+#include "ring_buffer_bulk.h"
+
+
+// --------------------------------------
+/** Overwrite push declaration macros. @{ */
+
+/** Push `data`, dropping the oldest element if full. Returns elements dropped (0 or 1). */
+#define	ringbuffer_push_overwrite_decl( NAME, ... )	\
+	size_t	NAME ## _push_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )
+
+/** Push all `len` elements from `src`, dropping the oldest ones as needed.
+ *
+ * If `len` exceeds the capacity, only the last `capacity` source elements are kept.
+ *
+ * \return	Elements dropped: old ones from the ring plus skipped source ones.
+ */
+#define	ringbuffer_push_n_overwrite_decl( NAME, ... )	\
+	size_t	NAME ## _push_n_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )
+
+/** SPSC consumer side: pop the oldest element still intact into `data`.
+ *
+ * \param	lost	If not NULL, set to the number of elements overwritten before they could be popped.
+ * \return	false if empty.
+ */
+#define	ringbuffer_pop_overwrite_decl( NAME, ... )	\
+	bool	NAME ## _pop_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data, size_t *lost )
+
+/** @} end Overwrite push declaration macros. */
+
+
+// --------------------------------------
+/** Overwrite push definition macros. @{ */
+
+#define	ringbuffer_push_overwrite_def( NAME, ... )	\
+	size_t	NAME ## _push_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )	{\
+		size_t	lost	= NAME ## _full( rb );	\
+		rb->output	+= lost;	/* Drop the oldest. */	\
+		RINGBUF_CURR_i( rb ) = *data;	\
+		rb->input++;	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_IN( rb, overwritten, lost );	\
+		RINGBUF_STAT_LEVEL( rb, NAME ## _count( rb ) );	\
+		return lost; }
+
+#define	ringbuffer_push_n_overwrite_def( NAME, ... )	\
+	size_t	NAME ## _push_n_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )	{\
+		size_t	lost	= 0, avail;	\
+		if ( len > RINGBUF_CAPACITY( rb ) )	\
+		{ lost = len - RINGBUF_CAPACITY( rb ); src += lost; len -= lost; }	\
+		avail	= RINGBUF_CAPACITY( rb ) - NAME ## _count( rb );	\
+		if ( len > avail )	\
+		{ rb->output += len - avail; lost += len - avail; }	\
+		RINGBUF_COPY_IN_( rb, rb->input, src, len );	\
+		rb->input += len;	\
+		RINGBUF_STAT_IN( rb, pushes, len );	\
+		RINGBUF_STAT_IN( rb, overwritten, lost );	\
+		RINGBUF_STAT_LEVEL( rb, NAME ## _count( rb ) );	\
+		return lost; }
+
+/** SPSC producer side: write and publish without looking at `output`.
+ *
+ * The write fence keeps the previous `input` publication ahead of the slot
+ * rewrite, which is what lets `_pop_overwrite` detect a torn copy. At most
+ * `capacity - 1` elements are kept (see SPSC ring-buffers above).
+ */
+#define	ringbuffer_spsc_push_overwrite_def( NAME, ... )	\
+	size_t	NAME ## _push_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )	{\
+		NAME ## _index_t input = rb->input;	\
+		size_t	used, lost;	\
+		RINGBUF_WRITE_FENCE();	\
+		RINGBUF_CURR_i( rb ) = *data;	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + 1 );	\
+		used	= ( NAME ## _index_t )( input - RINGBUF_LOAD_RELAXED( &rb->output ) );	\
+		lost	= used >= RINGBUF_CAPACITY( rb ) - 1;	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_IN( rb, overwritten, lost );	\
+		RINGBUF_STAT_LEVEL( rb, lost ? RINGBUF_CAPACITY( rb ) - 1 : used + 1 );	\
+		return lost; }
+
+/** Push the elements one by one, as `_push_overwrite` does, publishing `input`
+ * after each: `_pop_overwrite` only detects the rewrite of the slot it copies
+ * if no other slot is in flight. For the same reason no source element is
+ * skipped: every index published must hold its element.
+ */
+#define	ringbuffer_spsc_push_n_overwrite_def( NAME, ... )	\
+	size_t	NAME ## _push_n_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const DATA_TYPE( NAME ) *src, size_t len )	{\
+		NAME ## _index_t input = rb->input;	\
+		size_t	keep	= RINGBUF_CAPACITY( rb ) - 1, lost, used, i;	\
+		used	= ( NAME ## _index_t )( input - RINGBUF_LOAD_RELAXED( &rb->output ) );	\
+		if ( used > keep ) used = keep;		/* Already lapped: those drops were counted. */	\
+		for ( i = 0; i < len; ++i, ++input )	{	\
+			RINGBUF_WRITE_FENCE();	\
+			rb->data_buffer[ RINGBUF_WRAP( rb, input ) ] = src[ i ];	\
+			RINGBUF_STORE_RELEASE( &rb->input, input + 1 ); }	\
+		lost	= used + len > keep ? used + len - keep : 0;	\
+		RINGBUF_STAT_IN( rb, pushes, len );	\
+		RINGBUF_STAT_IN( rb, overwritten, lost );	\
+		RINGBUF_STAT_LEVEL( rb, used + len < keep ? used + len : keep );	\
+		return lost; }
+
+/** Copy the element out, then re-check `input`: if the producer reached this
+ * slot again meanwhile, the copy may be torn, so skip ahead and retry.
+ *
+ * A lapped consumer resumes `capacity - 1` elements behind `input`: the slot
+ * `capacity` behind may be the one being rewritten.
+ */
+#define	ringbuffer_pop_overwrite_def( NAME, ... )	\
+	bool	NAME ## _pop_overwrite ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data, size_t *lost )	{\
+		NAME ## _index_t output = rb->output, input;	\
+		size_t	skipped	= 0;	\
+		for ( ;; )	{	\
+			input = RINGBUF_LOAD_ACQUIRE( &rb->input );	\
+			if ( input == output ) break;	\
+			if ( ( NAME ## _index_t )( input - output ) > RINGBUF_CAPACITY( rb ) - 1 )	\
+			{ /* Lapped: skip to the oldest element surely intact. */	\
+			  skipped	+= ( NAME ## _index_t )( input - output ) - ( RINGBUF_CAPACITY( rb ) - 1 );	\
+			  output	= input - ( RINGBUF_CAPACITY( rb ) - 1 ); }	\
+			*data = rb->data_buffer[ RINGBUF_WRAP( rb, output ) ];	\
+			RINGBUF_READ_FENCE();	\
+			if ( ( NAME ## _index_t )( RINGBUF_LOAD_RELAXED( &rb->input ) - output ) < RINGBUF_CAPACITY( rb ) )	\
+				break;	\
+			++skipped; ++output; }	/* Slot may have been rewritten while copying. */	\
+		if ( lost ) *lost = skipped;	\
+		if ( input == output )	\
+		{ RINGBUF_STORE_RELEASE( &rb->output, output );	\
+		  RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return false; }	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + 1 );	\
+		RINGBUF_STAT_OUT( rb, pops, 1 );	\
+		return true; }
+
+/** @} end Overwrite push definition macros. */
+
+
+#endif	// RING_BUFFER_OVERWRITE_H
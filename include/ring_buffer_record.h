@@ -0,0 +1,182 @@
+#ifndef	RING_BUFFER_RECORD_H
+#	define	RING_BUFFER_RECORD_H
+
+/** Variable-length record (length-prefixed message) operations on byte ring buffers.
+ *
+ * Each record is a header holding the payload length followed by the payload,
+ * rounded up to RINGBUF_RECORD_ALIGN bytes, so headers and payloads stay aligned.
+ * A record never straddles the wrap point: when it does not fit before the end
+ * of data_buffer, the tail is marked with a RINGBUF_RECORD_SKIP header and the
+ * record starts again at data_buffer[ 0 ]. Payloads can thus be read in place.
+ *
+ * Every record costs a single `input` publication (`_push_record`) and a single
+ * `output` one (`_pop_record`), on plain, SPSC or runtime-sized `uint8_t` rings.
+ * On mirrored rings (ring_buffer_mirror.h) records never need skipping.
+ *
+ * \code
+	ringbuffer_spsc_declare_all( msgs, uint8_t, 4096 );
+	ringbuffer_spsc_define_all( msgs )
+	ringbuffer_record_declare_all( msgs );
+	ringbuffer_record_define_all( msgs )
+
+	// Producer:
+	if ( !msgs_push_record( rb, &frame, sizeof( frame ) ) )
+		dropped++;
+	// Consumer:
+	uint8_t	*p;
+	size_t	len;
+	while ( msgs_peek_record( rb, &p, &len ) )
+	{
+		handle( p, len );
+		msgs_pop_record( rb );
+	}
+ * \endcode
+ *
+ * \note	Ring length \b must be at least RINGBUF_RECORD_ALIGN (hence, both being
+ * 	powers of two, a multiple of it): checked at compile time for fixed-size
+ * 	rings, `_push_record` fails on smaller runtime-sized ones.
+ * \note	Don't mix with element-wise pushes/pops on the same ring-buffer.
+ * \note	With `RINGBUF_STATS`, `pushes`, `pops` and `rejected_pushes` count records,
+ * 	`empty_polls` counts `_peek_record` calls on an empty ring and `high_water`
+ * 	is in bytes (padding included), as `_count()`.
+ */
+
+
+#include "ring_buffer.h"
+
+#ifdef __KERNEL__
+#	include <linux/string.h>
+#else
+#	include <string.h>
+#endif
+
+
+/** Record helpers. @{ */
+
+/// Record alignment in bytes (power of two, at least 4). Header slots take this much room too.
+#ifndef	RINGBUF_RECORD_ALIGN
+#	define	RINGBUF_RECORD_ALIGN	8
+#endif
+
+/// Header length value marking the rest of data_buffer, up to the wrap point, as padding.
+#define	RINGBUF_RECORD_SKIP	UINT32_MAX
+
+/// Bytes taken in the ring by a record of `len` payload bytes.
+#define	RINGBUF_RECORD_SIZE( len )	\
+	( ( RINGBUF_RECORD_ALIGN + ( size_t )( len ) + RINGBUF_RECORD_ALIGN - 1 ) & ~( size_t )( RINGBUF_RECORD_ALIGN - 1 ) )
+
+/// Don't use. Read the header at `index`.
+#define	RINGBUF_RECORD_HDR_( rb, index, len )	\
+	memcpy( ( len ), ( const void * )&( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ], sizeof( uint32_t ) )
+
+/// Don't use. Write the header at `index`.
+#define	RINGBUF_RECORD_SET_HDR_( rb, index, len )	do {	\
+	uint32_t	hdr_	= ( len );	\
+	memcpy( ( void * )&( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ], &hdr_, sizeof( hdr_ ) ); } while ( 0 )
+
+/** @} end Record helpers. */
+
+
+// --------------------------------------
+/** Record ring buffer declaration macros. @{ */
+
+/** Push the `len` bytes at `src` as a single record.
+ *
+ * \return	false if there is no room for it (counting any wrap padding), or if it
+ * 	would not fit even in the empty ring-buffer.
+ */
+#define	ringbuffer_push_record_decl( NAME, ... )	\
+	bool	NAME ## _push_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const void *src, uint32_t len )
+
+/** Get the oldest record in place.
+ *
+ * \return	false if empty; otherwise `*ptr`/`*len` are set to its payload.
+ */
+#define	ringbuffer_peek_record_decl( NAME, ... )	\
+	bool	NAME ## _peek_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr, size_t *len )
+
+/** Release the oldest record (and any padding before it).
+ *
+ * \note	Ring-buffer \b must not be empty (see `_peek_record`).
+ */
+#define	ringbuffer_pop_record_decl( NAME, ... )	\
+	void	NAME ## _pop_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb )
+
+// --------------------------------------
+#define ringbuffer_record_declare_all( NAME, ... )	\
+	ringbuffer_push_record_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_record_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_record_decl( NAME, __VA_ARGS__ )
+
+/** @} end Record ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Record ring buffer function definition macros. @{ */
+
+/** Padding (when needed), header and payload are all published by one `input` store.
+ *
+ * `len` is bounded by the capacity before RINGBUF_RECORD_SIZE, which could
+ * otherwise wrap around with a 32-bit `size_t`.
+ */
+#define	ringbuffer_push_record_def( NAME, ... )	\
+	bool	NAME ## _push_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb, const void *src, uint32_t len )	{\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	need, pad = 0, avail;	\
+		_Static_assert( sizeof( DATA_TYPE( NAME ) ) == 1, #NAME " is not a byte ring-buffer" );	\
+		_Static_assert( __builtin_choose_expr( RINGBUF_IS_DYNAMIC( ( NAME * )0 ), 1,	\
+			RINGBUF_CAPACITY( ( NAME * )0 ) >= RINGBUF_RECORD_ALIGN ), #NAME " is smaller than RINGBUF_RECORD_ALIGN" );	\
+		if ( RINGBUF_CAPACITY( rb ) < RINGBUF_RECORD_ALIGN || len == RINGBUF_RECORD_SKIP	\
+			|| len > RINGBUF_CAPACITY( rb ) - RINGBUF_RECORD_ALIGN )	\
+		{ RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; }	\
+		need	= RINGBUF_RECORD_SIZE( len );	\
+		avail	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+		if ( RINGBUF_TO_END( rb, input ) < need ) pad = RINGBUF_TO_END( rb, input );	\
+		if ( need + pad > avail ) { RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; }	\
+		if ( pad ) { RINGBUF_RECORD_SET_HDR_( rb, input, RINGBUF_RECORD_SKIP ); input += pad; }	\
+		RINGBUF_RECORD_SET_HDR_( rb, input, len );	\
+		memcpy( ( void * )&rb->data_buffer[ RINGBUF_WRAP( rb, input ) + RINGBUF_RECORD_ALIGN ], src, len );	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + need );	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_LEVEL( rb, RINGBUF_CAPACITY( rb ) - avail + pad + need );	\
+		return true; }
+
+#define	ringbuffer_peek_record_def( NAME, ... )	\
+	bool	NAME ## _peek_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME ) **ptr, size_t *len )	{\
+		NAME ## _index_t output	= rb->output;	\
+		uint32_t	hdr;	\
+		if ( RINGBUF_LOAD_ACQUIRE( &rb->input ) == output )	\
+		{ RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return false; }	\
+		RINGBUF_RECORD_HDR_( rb, output, &hdr );	\
+		if ( hdr == RINGBUF_RECORD_SKIP )	/* A record always follows its padding. */	\
+		{ output += RINGBUF_TO_END( rb, output ); RINGBUF_RECORD_HDR_( rb, output, &hdr ); }	\
+		*ptr	= &rb->data_buffer[ RINGBUF_WRAP( rb, output ) + RINGBUF_RECORD_ALIGN ];	\
+		*len	= hdr;	\
+		return true; }
+
+#define	ringbuffer_pop_record_def( NAME, ... )	\
+	void	NAME ## _pop_record ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
+		NAME ## _index_t output	= rb->output;	\
+		uint32_t	hdr;	\
+		RINGBUF_RECORD_HDR_( rb, output, &hdr );	\
+		if ( hdr == RINGBUF_RECORD_SKIP )	\
+		{ output += RINGBUF_TO_END( rb, output ); RINGBUF_RECORD_HDR_( rb, output, &hdr ); }	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + RINGBUF_RECORD_SIZE( hdr ) );	\
+		RINGBUF_STAT_OUT( rb, pops, 1 ); }
+
+// --------------------------------------
+#define ringbuffer_record_define_all( NAME, ... )	\
+	ringbuffer_push_record_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_peek_record_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_pop_record_def( NAME, __VA_ARGS__ )
+
+/** @} end Record ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_RECORD_H
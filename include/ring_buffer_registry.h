@@ -0,0 +1,288 @@
+#ifndef	RING_BUFFER_REGISTRY_H
+#	define	RING_BUFFER_REGISTRY_H
+
+/** Type-erased ring-buffer registry: enumeration and memory accounting across ring types.
+ *
+ * Every `NAME` is a distinct compile-time type, so a process with many rings has
+ * no way to walk them. Rings may join a registry (typically right after `_init`)
+ * with a caller-provided descriptor that points at a per-`NAME` ops table
+ * (element size, `_count`, capacity, footprint, `_stats_snapshot`), and the
+ * registry then answers aggregate occupancy, bytes reserved and top-N-fullest
+ * queries, e.g. to find hot queues or idle runtime-sized rings to shrink.
+ *
+ * \code
+	ringbuffer_dyn_declare_all( conn_q, struct msg );
+	ringbuffer_dyn_define_all( conn_q )
+	ringbuffer_registry_declare_all( conn_q );
+	ringbuffer_registry_define_all( conn_q )
+
+	struct ring_buffer_registry	reg;
+	ring_buffer_registry_init( &reg );
+
+	// Per connection:
+	conn_q_init_storage( &c->q, mem, 256 );
+	conn_q_join( &c->q, &reg, &c->q_desc, "conn" );
+	...
+	ring_buffer_registry_leave( &reg, &c->q_desc );
+
+	// Metrics:
+	struct ring_buffer_registry_totals	tot;
+	struct ring_buffer_desc	*hot[ 8 ];
+
+	ring_buffer_registry_totals( &reg, &tot );
+	n	= ring_buffer_registry_top( &reg, hot, ARRAY_COUNT( hot ) );
+ * \endcode
+ *
+ * \note	Descriptors are intrusive: no allocation; a ring must leave before it
+ * 	(or its descriptor) goes away.
+ * \note	Queries read `_count` from any context, so, as for SPSC rings, results
+ * 	are just a snapshot. Joins/leaves/queries are serialised by the registry lock.
+ * \note	Not for MPMC ring-buffers (no `_stats_snapshot`, slot-sized elements).
+ */
+
+
+#include "ring_buffer.h"
+
+#ifdef __KERNEL__
+#	include <linux/spinlock.h>
+#else
+#	include <pthread.h>
+#endif
+
+
+/** Registry types and helpers. @{ */
+
+/** Per-`NAME` operations (one static table per ring type).
+ *
+ * \var element_size	sizeof( DATA_TYPE( NAME ) ).
+ * \var count		`_count`.
+ * \var capacity	Elements (RINGBUF_CAPACITY).
+ * \var bytes		Memory reserved: control structure plus runtime-sized storage.
+ * \var stats		`_stats_snapshot`.
+ */
+struct ring_buffer_desc_ops
+{
+	size_t	element_size;
+	size_t	( *count )( void *rb );
+	size_t	( *capacity )( void *rb );
+	size_t	( *bytes )( void *rb );
+	void	( *stats )( void *rb, struct ring_buffer_stats *stats );
+};
+
+/** Registered ring-buffer.
+ *
+ * \var ops		Type operations.
+ * \var rb		The ring-buffer.
+ * \var name		Caller label (not copied), may be NULL.
+ * \var next, pprev	Registry list linkage.
+ */
+struct ring_buffer_desc
+{
+	const struct ring_buffer_desc_ops	*ops;
+	void	*rb;
+	const char	*name;
+	struct ring_buffer_desc	*next;
+	struct ring_buffer_desc	**pprev;
+};
+
+struct ring_buffer_registry
+{
+#ifdef __KERNEL__
+	spinlock_t	lock;
+#else
+	pthread_mutex_t	lock;
+#endif
+	struct ring_buffer_desc	*head;
+	size_t	rings;
+};
+
+/** Aggregates over all registered ring-buffers.
+ *
+ * \var rings		Registered ring-buffers.
+ * \var used, capacity	Elements queued / elements of storage.
+ * \var bytes_used	Bytes of queued elements.
+ * \var bytes_reserved	Bytes of control structures and storage.
+ */
+struct ring_buffer_registry_totals
+{
+	size_t	rings;
+	size_t	used;
+	size_t	capacity;
+	size_t	bytes_used;
+	size_t	bytes_reserved;
+};
+
+#ifdef __KERNEL__
+#	define	RINGBUF_REGISTRY_LOCK_( reg )	spin_lock( &( reg )->lock )
+#	define	RINGBUF_REGISTRY_UNLOCK_( reg )	spin_unlock( &( reg )->lock )
+#else
+#	define	RINGBUF_REGISTRY_LOCK_( reg )	pthread_mutex_lock( &( reg )->lock )
+#	define	RINGBUF_REGISTRY_UNLOCK_( reg )	pthread_mutex_unlock( &( reg )->lock )
+#endif
+
+static inline void	ring_buffer_registry_init ( struct ring_buffer_registry *reg )
+{
+#ifdef __KERNEL__
+	spin_lock_init( &reg->lock );
+#else
+	pthread_mutex_init( &reg->lock, NULL );
+#endif
+	reg->head	= NULL;
+	reg->rings	= 0;
+}
+
+/// Link `d` (already filled in, see `NAME_join`) into `reg`.
+static inline void	ring_buffer_registry_add ( struct ring_buffer_registry *reg, struct ring_buffer_desc *d )
+{
+	RINGBUF_REGISTRY_LOCK_( reg );
+	if ( ( d->next = reg->head ) )
+		d->next->pprev	= &d->next;
+	d->pprev	= &reg->head;
+	reg->head	= d;
+	reg->rings++;
+	RINGBUF_REGISTRY_UNLOCK_( reg );
+}
+
+static inline void	ring_buffer_registry_leave ( struct ring_buffer_registry *reg, struct ring_buffer_desc *d )
+{
+	RINGBUF_REGISTRY_LOCK_( reg );
+	if ( ( *d->pprev = d->next ) )
+		d->next->pprev	= d->pprev;
+	d->next		= NULL;
+	d->pprev	= NULL;
+	reg->rings--;
+	RINGBUF_REGISTRY_UNLOCK_( reg );
+}
+
+static inline void	ring_buffer_registry_totals ( struct ring_buffer_registry *reg, struct ring_buffer_registry_totals *tot )
+{
+	struct ring_buffer_desc	*d;
+	size_t	n;
+
+	*tot	= ( struct ring_buffer_registry_totals ){ 0 };
+
+	RINGBUF_REGISTRY_LOCK_( reg );
+	for ( d = reg->head; d; d = d->next )
+	{
+		n	= d->ops->count( d->rb );
+		tot->used		+= n;
+		tot->bytes_used		+= n * d->ops->element_size;
+		tot->capacity		+= d->ops->capacity( d->rb );
+		tot->bytes_reserved	+= d->ops->bytes( d->rb );
+	}
+	tot->rings	= reg->rings;
+	RINGBUF_REGISTRY_UNLOCK_( reg );
+}
+
+/// Largest `n` for `ring_buffer_registry_top` (its snapshot lives on the stack).
+#ifndef	RINGBUF_REGISTRY_TOP_MAX
+#	define	RINGBUF_REGISTRY_TOP_MAX	16
+#endif
+
+/** Store the (up to) `n` fullest ring-buffers, by fill ratio, fullest first, in `top`.
+ *
+ * `_count` and capacity are read once per descriptor into a local snapshot,
+ * kept alongside `top` and sorted with it, so every ring is ranked on a single
+ * reading (and its ops are not called again on each comparison).
+ *
+ * \note	The descriptors are only valid as long as their ring-buffers stay registered.
+ * \return	Descriptors stored (`n` is capped at RINGBUF_REGISTRY_TOP_MAX).
+ */
+static inline size_t	ring_buffer_registry_top ( struct ring_buffer_registry *reg, struct ring_buffer_desc **top, size_t n )
+{
+	struct { size_t used, capacity; }	snap[ RINGBUF_REGISTRY_TOP_MAX ];
+	struct ring_buffer_desc	*d;
+	size_t	found	= 0, u, c, i;
+
+	if ( n > RINGBUF_REGISTRY_TOP_MAX )
+		n	= RINGBUF_REGISTRY_TOP_MAX;
+	if ( !n )
+		return 0;
+
+	RINGBUF_REGISTRY_LOCK_( reg );
+	for ( d = reg->head; d; d = d->next )
+	{
+		u	= d->ops->count( d->rb );
+		c	= d->ops->capacity( d->rb );
+
+		// Insertion into the sorted prefix while u/c is above the entry's ratio (cross-multiplied).
+		for ( i = found; i > 0; i-- )
+		{
+			if ( ( unsigned long long )u * snap[ i - 1 ].capacity
+				<= ( unsigned long long )snap[ i - 1 ].used * c )
+				break;
+			if ( i < n )
+			{
+				top[ i ]	= top[ i - 1 ];
+				snap[ i ]	= snap[ i - 1 ];
+			}
+		}
+
+		if ( i < n )
+		{
+			top[ i ]		= d;
+			snap[ i ].used		= u;
+			snap[ i ].capacity	= c;
+			if ( found < n )
+				found++;
+		}
+	}
+	RINGBUF_REGISTRY_UNLOCK_( reg );
+
+	return found;
+}
+
+/** @} end Registry types and helpers. */
+
+
+// --------------------------------------
+/** Ring buffer registry declaration macros. @{ */
+
+/** Fill descriptor `d` for `rb` (labelled `name`) and add it to `reg`. */
+#define	ringbuffer_registry_join_decl( NAME, ... )	\
+	void	NAME ## _join ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct ring_buffer_registry *reg,	\
+		struct ring_buffer_desc *d, const char *name )
+
+#define ringbuffer_registry_declare_all( NAME, ... )	\
+	ringbuffer_registry_join_decl( NAME, __VA_ARGS__ )
+
+/** @} end Ring buffer registry declaration macros. */
+
+
+// --------------------------------------
+/** Ring buffer registry function definition macros. @{ */
+
+/** The ops table and its thunks are emitted `static` alongside `NAME_join`. */
+#define	ringbuffer_registry_join_def( NAME, ... )	\
+	static size_t	NAME ## _desc_count_ ( void *rb )	\
+	{ return NAME ## _count( ( NAME * )rb ); }	\
+	static size_t	NAME ## _desc_capacity_ ( void *rb )	\
+	{ return RINGBUF_CAPACITY( ( NAME * )rb ); }	\
+	static size_t	NAME ## _desc_bytes_ ( void *rb )	\
+	{ return sizeof( NAME ) + ( RINGBUF_IS_DYNAMIC( ( NAME * )rb )	\
+		? RINGBUF_CAPACITY( ( NAME * )rb ) * sizeof( DATA_TYPE( NAME ) ) : 0 ); }	\
+	static void	NAME ## _desc_stats_ ( void *rb, struct ring_buffer_stats *stats )	\
+	{ NAME ## _stats_snapshot( ( NAME * )rb, stats ); }	\
+	static const struct ring_buffer_desc_ops	NAME ## _desc_ops_	=	\
+	{	\
+		.element_size	= sizeof( DATA_TYPE( NAME ) ),	\
+		.count		= NAME ## _desc_count_,	\
+		.capacity	= NAME ## _desc_capacity_,	\
+		.bytes		= NAME ## _desc_bytes_,	\
+		.stats		= NAME ## _desc_stats_,	\
+	};	\
+	\
+	void	NAME ## _join ( DECL_qualif( __VA_ARGS__ ) NAME *rb, struct ring_buffer_registry *reg,	\
+		struct ring_buffer_desc *d, const char *name )	{\
+		d->ops	= &NAME ## _desc_ops_;	\
+		d->rb	= ( void * )rb;	\
+		d->name	= name;	\
+		ring_buffer_registry_add( reg, d ); }
+
+#define ringbuffer_registry_define_all( NAME, ... )	\
+	ringbuffer_registry_join_def( NAME, __VA_ARGS__ )
+
+/** @} end Ring buffer registry function definition macros. */
+
+
+#endif	// RING_BUFFER_REGISTRY_H
@@ -0,0 +1,253 @@
+#ifndef	RING_BUFFER_SHM_H
+#	define	RING_BUFFER_SHM_H
+
+/** Shared-memory inter-process SPSC ring buffer (POSIX user space only).
+ *
+ * The whole control structure lives in a `shm_open`/`mmap` segment and holds no
+ * pointers: a validation header (magic, version, element size/capacity, index
+ * width, total size), the producer and consumer indices on their own cache
+ * lines, then a fixed-size data_buffer. Each process maps it wherever it likes
+ * and runs the usual SPSC fast path on it, with no copies and no syscalls.
+ *
+ * \code
+	// Both sides (e.g. a shared header):
+	ringbuffer_shm_declare_all( samples, struct sample, 4096 );
+	// One .c file per process:
+	ringbuffer_shm_define_all( samples )
+
+	// Capture process (producer):
+	samples	*rb = samples_shm_create( "/capture", 0600 );
+	samples_push_front( rb, &s );
+
+	// Analysis process (consumer):
+	samples	*rb = samples_shm_attach( "/capture" );
+	while ( ( p = samples_peek( rb, 0 ) ) ) { analyse( p ); samples_pop_back( rb ); }
+	samples_shm_detach( rb );
+ * \endcode
+ *
+ * \note	TYPE \b must be position independent too (no pointers into either process).
+ * \note	There is no `push_callback` (a function pointer means nothing in the other
+ * 	process); bulk operations are available with
+ * 	`ringbuffer_spsc_bulk_define_all_cb( NAME, RINGBUF_BATCH_NONE )`.
+ * \note	`shm_unlink()` the name once both sides are attached or done.
+ */
+
+
+#ifdef __KERNEL__
+#	error	"ring_buffer_shm.h is user space only."
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ring_buffer_spsc.h"
+
+
+/** Shared-memory helpers. @{ */
+
+#define	RINGBUF_SHM_MAGIC	0x48534252u	///< "RBSH", little endian.
+#define	RINGBUF_SHM_VERSION	1
+
+/// Segment validation header. `magic` is written last, with release semantics.
+struct ring_buffer_shm_header
+{
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	index_size;	///< sizeof( NAME_index_t ).
+	uint32_t	element_size;	///< sizeof( TYPE ).
+	uint32_t	reserved;
+	uint64_t	capacity;	///< LEN.
+	uint64_t	size;		///< sizeof( NAME ): whole segment.
+};
+
+/** Shared-memory control structure layout: header, then RINGBUF_SPSC_CACHED without callbacks.
+ *
+ * \var output_cache	Producer's last seen `output`. Producer only.
+ * \var input_cache	Consumer's last seen `input`. Consumer only.
+ */
+#define	RINGBUF_SHM( NAME, TYPE, LEN )	\
+		struct ring_buffer_shm_header	header;	\
+		NAME ## _index_t	input	RINGBUF_CACHELINE_ALIGNED;	\
+		NAME ## _index_t	output_cache;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		NAME ## _index_t	output	RINGBUF_CACHELINE_ALIGNED;	\
+		NAME ## _index_t	input_cache;	\
+		RINGBUF_STATS_OUT_FIELDS	\
+		TYPE	data_buffer[ LEN ]	RINGBUF_CACHELINE_ALIGNED;
+
+/// Don't use. True if header `h` describes a `NAME` segment.
+#define	RINGBUF_SHM_VALID_( NAME, h )	\
+	( RINGBUF_LOAD_ACQUIRE( &( h )->magic ) == RINGBUF_SHM_MAGIC	\
+	  && ( h )->version == RINGBUF_SHM_VERSION	\
+	  && ( h )->index_size == sizeof( NAME ## _index_t )	\
+	  && ( h )->element_size == sizeof( DATA_TYPE( NAME ) )	\
+	  && ( h )->capacity == BUFFER_LEN( NAME )	\
+	  && ( h )->size == sizeof( NAME ) )
+
+/** Open (`flags`, `mode` as shm_open) and map a `bytes` long segment, sizing it if `create`.
+ *
+ * \return	Base of the mapping, or NULL (errno set). A segment created here is removed on failure.
+ */
+static inline void	*ring_buffer_shm_map ( const char *path, int flags, mode_t mode, size_t bytes, bool create )
+{
+	struct stat	st;
+	void	*base	= MAP_FAILED;
+	bool	ok;
+	int	fd, err;
+
+	if ( ( fd = shm_open( path, flags, mode ) ) < 0 )
+		return NULL;
+
+	if ( create )
+		ok	= ftruncate( fd, ( off_t )bytes ) == 0;
+	else if ( ( ok = fstat( fd, &st ) == 0 ) && ( size_t )st.st_size < bytes )
+	{
+		ok	= false;
+		errno	= EPROTO;
+	}
+
+	if ( ok )
+		base	= mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+	err	= errno;
+	close( fd );	// The mapping keeps the segment alive.
+	if ( base == MAP_FAILED && create )
+		shm_unlink( path );
+	errno	= err;
+
+	return base == MAP_FAILED ? NULL : base;
+}
+
+/** @} end Shared-memory helpers. */
+
+
+// --------------------------------------
+/** Define shared-memory ring buffer control structure (see RINGBUF_SHM). */
+#define ringbuffer_shm_type_def( NAME, TYPE, LEN, ... )	\
+	ringbuffer_type_def_ex( NAME, TYPE, LEN, RINGBUF_SHM, index_t, __VA_ARGS__ )
+
+
+// --------------------------------------
+/** Shared-memory ring buffer declaration macros. @{ */
+
+/** Create segment `path` (must not exist), reset it and publish its header.
+ *
+ * \return	Mapped ring-buffer, or NULL (errno set).
+ */
+#define	ringbuffer_shm_create_decl( NAME, ... )	\
+	NAME	*NAME ## _shm_create ( const char *path, mode_t mode )
+
+/** Map existing segment `path` and validate its header against `NAME`.
+ *
+ * \return	Mapped ring-buffer, or NULL (errno set; EPROTO if the header does not match).
+ */
+#define	ringbuffer_shm_attach_decl( NAME, ... )	\
+	NAME	*NAME ## _shm_attach ( const char *path )
+
+/** Unmap a segment mapped by `_shm_create`/`_shm_attach`. */
+#define	ringbuffer_shm_detach_decl( NAME, ... )	\
+	void	NAME ## _shm_detach ( NAME *rb )
+
+// --------------------------------------
+#define ringbuffer_shm_declare_all( NAME, TYPE, LEN, ... )	\
+	ringbuffer_shm_type_def( NAME, TYPE, LEN, __VA_ARGS__ );	\
+	\
+	ringbuffer_shm_create_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_shm_attach_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_shm_detach_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_count_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_empty_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_full_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_push_front_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_back_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_stats_snapshot_decl( NAME, __VA_ARGS__ )
+
+/** @} end Shared-memory ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Shared-memory ring buffer function definition macros. @{ */
+
+/** The header goes last: an attacher seeing `magic` also sees the reset indices. */
+#define	ringbuffer_shm_create_def( NAME, ... )	\
+	NAME	*NAME ## _shm_create ( const char *path, mode_t mode )	{\
+		NAME	*rb;	\
+		_Static_assert( __atomic_always_lock_free( sizeof( NAME ## _index_t ), 0 ),	\
+			#NAME ": index type not lock-free, cannot be shared across processes" );	\
+		if ( !( rb = ring_buffer_shm_map( path, O_RDWR | O_CREAT | O_EXCL, mode, sizeof( NAME ), true ) ) )	\
+			return NULL;	\
+		rb->output_cache = rb->input_cache = 0;	\
+		RINGBUF_STATS_RESET( rb );	\
+		RINGBUF_STORE_RELEASE( &rb->output, 0 );	\
+		RINGBUF_STORE_RELEASE( &rb->input, 0 );	\
+		rb->header	= ( struct ring_buffer_shm_header ){	\
+			.version = RINGBUF_SHM_VERSION, .index_size = sizeof( NAME ## _index_t ),	\
+			.element_size = sizeof( DATA_TYPE( NAME ) ), .capacity = BUFFER_LEN( NAME ),	\
+			.size = sizeof( NAME ) };	\
+		RINGBUF_STORE_RELEASE( &rb->header.magic, RINGBUF_SHM_MAGIC );	\
+		return rb; }
+
+#define	ringbuffer_shm_attach_def( NAME, ... )	\
+	NAME	*NAME ## _shm_attach ( const char *path )	{\
+		NAME	*rb	= ring_buffer_shm_map( path, O_RDWR, 0, sizeof( NAME ), false );	\
+		if ( rb && !RINGBUF_SHM_VALID_( NAME, &rb->header ) )	\
+		{ munmap( rb, sizeof( NAME ) ); rb = NULL; errno = EPROTO; }	\
+		return rb; }
+
+#define	ringbuffer_shm_detach_def( NAME, ... )	\
+	void	NAME ## _shm_detach ( NAME *rb )	\
+	{ if ( rb ) munmap( rb, sizeof( NAME ) ); }
+
+/** As ringbuffer_spsc_push_front_def, without `push_callback`. */
+#define	ringbuffer_shm_push_front_def( NAME, ... )	\
+	bool	NAME ## _push_front ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )	{\
+		NAME ## _index_t input = rb->input;	\
+		if ( ( NAME ## _index_t )( input - rb->output_cache ) >= BUFFER_LEN( NAME ) )	\
+		{ rb->output_cache = RINGBUF_LOAD_ACQUIRE( &rb->output );	\
+		  if ( ( NAME ## _index_t )( input - rb->output_cache ) >= BUFFER_LEN( NAME ) )	\
+		  { RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; } }	\
+		RINGBUF_CURR_i( rb ) = *data;	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + 1 );	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + 1 - rb->output_cache ) );	\
+		return true; }
+
+// --------------------------------------
+#define ringbuffer_shm_define_all( NAME, ... )	\
+	ringbuffer_shm_create_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_shm_attach_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_shm_detach_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_count_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_empty_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_full_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_shm_push_front_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_pop_back_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_peek_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_stats_snapshot_def( NAME, __VA_ARGS__ )
+
+/** @} end Shared-memory ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_SHM_H
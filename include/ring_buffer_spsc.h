@@ -0,0 +1,212 @@
+#ifndef	RING_BUFFER_SPSC_H
+#	define	RING_BUFFER_SPSC_H
+
+/** Single-producer/single-consumer lock-free ring buffer.
+ *
+ * Same function set as ring_buffer.h, but the indices are handed over with
+ * acquire/release semantics, so one producer and one consumer (e.g. an ISR
+ * and a thread, or two threads) may run concurrently without external locking.
+ *
+ * \note	Only the producer may call `_push_front`; only the consumer may call
+ * 	`_pop_back` and `_peek`. `_count`, `_empty` and `_full` are safe from either
+ * 	side, but are just a snapshot.
+ *
+ * Usage
+ * -----
+ *
+ * Exactly as ring_buffer.h, replacing `ringbuffer_declare_all`/`ringbuffer_define_all`
+ * with `ringbuffer_spsc_declare_all( NAME, TYPE, LEN )`/`ringbuffer_spsc_define_all( NAME )`
+ * (or `ringbuffer_spsc_type_def` for locally accessible ring-buffers).
+ *
+ * \note	`push_callback` runs in the producer context and must only write the
+ * 	current input element (`RINGBUF_CURR_i`); the index is published afterwards.
+ */
+
+
+#include "ring_buffer.h"
+
+
+// --------------------------------------
+/** SPSC control structure layout.
+ *
+ * Like RINGBUF_CACHELINE, plus a private copy of the remote index on each side
+ * ("cached head/tail"), so a side only reloads the shared index from the other
+ * core when its cached view says the buffer is full (producer) or empty (consumer).
+ *
+ * \var output_cache	Producer's last seen `output`. Producer only.
+ * \var input_cache	Consumer's last seen `input`. Consumer only.
+ */
+#define	RINGBUF_SPSC_CACHED( NAME, TYPE, LEN )	\
+		NAME ## _index_t	input	RINGBUF_CACHELINE_ALIGNED;	\
+		NAME ## _index_t	output_cache;	\
+		NAME ## _push_callback_t	push_callback;	\
+		NAME ## _push_batch_callback_t	push_batch_callback;	\
+		RINGBUF_STATS_IN_FIELDS	\
+		NAME ## _index_t	output	RINGBUF_CACHELINE_ALIGNED;	\
+		NAME ## _index_t	input_cache;	\
+		RINGBUF_STATS_OUT_FIELDS	\
+		TYPE	data_buffer[ LEN ]	RINGBUF_CACHELINE_ALIGNED;
+
+/** Compile-time check that `RING` is an SPSC ring-buffer (RINGBUF_SPSC_CACHED fields),
+ * for wrappers whose two sides run concurrently. A plain ring-buffer fails with
+ * "no member named input_cache".
+ */
+#define	RINGBUF_SPSC_ASSERT( RING, WHAT )	\
+	_Static_assert( sizeof( ( ( RING * )0 )->input_cache ) == sizeof( RING ## _index_t ),	\
+		WHAT " needs an SPSC ring-buffer (ring_buffer_spsc.h)" )
+
+/** Define SPSC ring buffer control structure.
+ *
+ * Always uses the RINGBUF_SPSC_CACHED layout, so the producer side (`input`,
+ * `push_callback`) and the consumer side (`output`) never share a cache line.
+ */
+#define ringbuffer_spsc_type_def( NAME, TYPE, LEN, ... )	\
+	ringbuffer_type_def_ex( NAME, TYPE, LEN, RINGBUF_SPSC_CACHED, index_t, __VA_ARGS__ )
+
+/** Define SPSC ring buffer control structure with a given `INDEX` type (see ringbuffer_type_def_ex). */
+#define ringbuffer_spsc_type_def_ex( NAME, TYPE, LEN, INDEX, ... )	\
+	ringbuffer_type_def_ex( NAME, TYPE, LEN, RINGBUF_SPSC_CACHED, INDEX, __VA_ARGS__ )
+
+
+// --------------------------------------
+/** SPSC ring buffer declaration macros. @{ */
+
+#define ringbuffer_spsc_declare_all( NAME, TYPE, LEN, ... )	\
+	ringbuffer_spsc_type_def( NAME, TYPE, LEN, __VA_ARGS__ );	\
+	\
+	ringbuffer_init_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_count_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_empty_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_full_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_push_front_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_pop_back_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_peek_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_stats_snapshot_decl( NAME, __VA_ARGS__ )
+
+/** @} end SPSC ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** SPSC ring buffer function definition macros. @{ */
+
+/** Don't use. True if the consumer's cached `input` does not cover `offset`.
+ *
+ * A cache behind `output` (left by code that moved `output` without refreshing
+ * it, e.g. the generic bulk pops) shows up as more than a full ring, and is
+ * reloaded too instead of being trusted.
+ */
+#define	RINGBUF_SPSC_STALE_IN_( NAME, rb, output, offset )	\
+	( ( NAME ## _index_t )( ( rb )->input_cache - ( output ) ) <= ( offset )	\
+	  || ( NAME ## _index_t )( ( rb )->input_cache - ( output ) ) > RINGBUF_CAPACITY( rb ) )
+
+#define	ringbuffer_spsc_init_def( NAME, ... )	\
+	void	NAME ## _init( DECL_qualif( __VA_ARGS__ ) NAME *rb, NAME ## _push_callback_t push_callback )	{\
+		rb->push_callback	= push_callback;	\
+		rb->push_batch_callback	= NULL;	\
+		rb->output_cache = rb->input_cache = 0;	\
+		RINGBUF_STATS_RESET( rb );	\
+		RINGBUF_STORE_RELEASE( &rb->output, 0 );	\
+		RINGBUF_STORE_RELEASE( &rb->input, 0 ); }
+
+/** Producer side: the element is written before `input` is released.
+ *
+ * `output` is only reloaded when the cached copy says the buffer is full. The
+ * test is `>=`, not `==`: a cache left behind by code that moved `input` without
+ * refreshing it (e.g. the generic bulk pushes) then costs one reload, not an overrun.
+ */
+#define	ringbuffer_spsc_push_front_def( NAME, ... )	\
+	bool	NAME ## _push_front ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data )	{\
+		NAME ## _index_t input = rb->input;	/* Own index: no ordering needed. */	\
+		if ( ( NAME ## _index_t )( input - rb->output_cache ) >= RINGBUF_CAPACITY( rb ) )	\
+		{ rb->output_cache = RINGBUF_LOAD_ACQUIRE( &rb->output );	\
+		  if ( ( NAME ## _index_t )( input - rb->output_cache ) >= RINGBUF_CAPACITY( rb ) )	\
+		  { RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; } }	\
+		if ( rb->push_callback )	\
+		{ if( !rb->push_callback( rb, data ) )	\
+		  { RINGBUF_STAT_IN( rb, rejected_pushes, 1 ); return false; } }	\
+		else { RINGBUF_CURR_i( rb ) = *data; }	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + 1 );	\
+		RINGBUF_STAT_IN( rb, pushes, 1 );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + 1 - rb->output_cache ) );	\
+		return true; }
+
+/** Consumer side: the element is released back to the producer.
+ *
+ * `input` is only reloaded when the cached copy says the buffer is empty, or
+ * is behind `output` (see RINGBUF_SPSC_STALE_IN_).
+ */
+#define	ringbuffer_spsc_pop_back_def( NAME, ... )	\
+	bool	NAME ## _pop_back ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	{\
+		NAME ## _index_t output = rb->output;	/* Own index: no ordering needed. */	\
+		if ( RINGBUF_SPSC_STALE_IN_( NAME, rb, output, 0 ) )	\
+		{ rb->input_cache = RINGBUF_LOAD_ACQUIRE( &rb->input );	\
+		  if ( rb->input_cache == output )	\
+		  { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return false; } }	\
+		RINGBUF_STORE_RELEASE( &rb->output, output + 1 );	\
+		RINGBUF_STAT_OUT( rb, pops, 1 );	\
+		return true; }
+
+/** Consumer side: `input` is acquired before the element is handed out.
+ *
+ * `input` is only reloaded when the cached copy does not cover `offset`.
+ */
+#define	ringbuffer_spsc_peek_def( NAME, ... )	\
+	DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME )	*NAME ## _peek ( DECL_qualif( __VA_ARGS__ ) NAME *rb, index_t offset )	{\
+		NAME ## _index_t output = rb->output;	\
+		if ( RINGBUF_SPSC_STALE_IN_( NAME, rb, output, offset ) )	\
+		{ rb->input_cache = RINGBUF_LOAD_ACQUIRE( &rb->input );	\
+		  if ( ( NAME ## _index_t )( rb->input_cache - output ) <= offset ) return NULL; }	\
+		return &( rb->data_buffer[ RINGBUF_WRAP( rb, output + offset ) ] ); }
+
+#define	ringbuffer_spsc_count_def( NAME, ... )	\
+	size_t	NAME ## _count ( DECL_qualif( __VA_ARGS__ ) NAME *rb )	\
+	{ NAME ## _index_t output = RINGBUF_LOAD_ACQUIRE( &rb->output );	\
+	  return ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output ); }
+
+// --------------------------------------
+#define ringbuffer_spsc_define_all( NAME, ... )	\
+	ringbuffer_spsc_init_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_count_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_empty_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_full_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_push_front_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_pop_back_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_spsc_peek_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_stats_snapshot_def( NAME, __VA_ARGS__ )
+
+/** As ringbuffer_define_all_inline, for SPSC ring-buffers (with `ringbuffer_spsc_type_def`). */
+#define ringbuffer_spsc_define_all_inline( NAME, ... )	\
+	RINGBUF_INLINE		ringbuffer_spsc_init_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_spsc_count_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_empty_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_ALWAYS_INLINE	ringbuffer_full_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_spsc_push_front_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_spsc_pop_back_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_spsc_peek_def( NAME, __VA_ARGS__ )	\
+	\
+	RINGBUF_INLINE		ringbuffer_stats_snapshot_def( NAME, __VA_ARGS__ )
+
+/** @} end SPSC ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_SPSC_H
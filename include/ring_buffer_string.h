@@ -3,6 +3,7 @@
 
 
 #include "ring_buffer.h"
+#include "ring_buffer_bulk.h"
 #include "cprep_tricks.h"
 
 
@@ -10,6 +11,22 @@
 #define PASTE_cond(COND,BEHAV)	TEST(COND)( TEST( BEHAV )(if( COND ) { BEHAV; }, ), )
 // --------------------
 
+/// Don't use. Offset of `delim` in `len` contiguous elements at `seg` (or `len`). Byte elements use `memchr`.
+#define	RINGBUF_SCAN_( seg, len, delim, pos )	do {	\
+	if ( 1 == sizeof( *( seg ) ) )	{	\
+		const void *p_ = memchr( ( const void * )( seg ), ( unsigned char )( delim ), ( len ) );	\
+		( pos ) = p_ ? ( size_t )( ( const char * )p_ - ( const char * )( seg ) ) : ( len ); }	\
+	else	\
+		for ( ( pos ) = 0; ( pos ) < ( len ) && ( seg )[ pos ] != ( delim ); ++( pos ) ) ; } while ( 0 )
+
+/// Don't use. Offset of the first `delim` in a `n` elements span starting at `index` (or `n`).
+#define	RINGBUF_FIND_( rb, index, n, delim, pos )	do {	\
+	size_t	first_	= RINGBUF_SPAN_FIRST( ( rb ), ( index ), ( n ) );	\
+	RINGBUF_SCAN_( &( rb )->data_buffer[ RINGBUF_WRAP( ( rb ), ( index ) ) ], first_, ( delim ), pos );	\
+	if ( ( pos ) == first_ && first_ < ( n ) )	{	\
+		RINGBUF_SCAN_( &( rb )->data_buffer[ 0 ], ( n ) - first_, ( delim ), pos );	\
+		( pos ) += first_; } } while ( 0 )
+
 // --------------------------------------
 /** String ring buffer function declaration macros.. @{ */
 
@@ -61,30 +78,54 @@
 	size_t	NAME ## _pop_string_ ## SUFFIX ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )
 
 
+/** Pop items up to and including the first `delim`, at most `limit - 1`, and null-terminate the output.
+ *
+ * Each contiguous segment is scanned at once (with `memchr` for byte-sized items)
+ * and the items up to the match are bulk-copied, e.g. for line extraction:
+ * \code
+ * 	len = my_buffer_pop_until( rb, line, sizeof( line ), '\\n' );
+ * \endcode
+ *
+ * \return	Items copied (the delimiter included, the terminator excluded).
+ * 	If no `delim` is found, all available items that fit are copied.
+ */
+#define	ringbuffer_pop_until_decl( NAME, ... )	\
+	size_t	NAME ## _pop_until ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit, DATA_TYPE( NAME ) delim )
+
+
 /** @} end String ring buffer function declaration macros.. */
 
 
 // --------------------------------------
 /** String ring buffer function definition macros.. @{ */
 
+/** Copies as many elements as fit with one `memcpy` per contiguous segment. */
 #define	ringbuffer_push_string_def( NAME, ... )	\
+	ringbuffer_push_string_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+/** As `ringbuffer_push_string_def`, with the batch callback `CB` bound at compile time. */
+#define	ringbuffer_push_string_cb_def( NAME, CB, ... )	\
 	size_t	NAME ## _push_string ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *data, size_t len )	\
-	{ size_t count = 0;	\
-	for ( ; len &&			/* Check end of source... */	\
-		NAME ## _full( rb );	/*	and and available space. */	\
-		rb->input++, --len )	\
-	{ RINGBUF_CURR_i( rb ) = src[ count++ ]; }	\
+	{ NAME ## _index_t input	= rb->input;	\
+	size_t	count	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+	if ( count > len ) count = len;		/* Check end of source and available space. */	\
+	RINGBUF_COPY_IN_( rb, input, data, count );	\
+	RINGBUF_BATCH_( CB, rb, input, count );	\
+	RINGBUF_STORE_RELEASE( &rb->input, input + count );	\
+	RINGBUF_STAT_IN( rb, pushes, count );	\
+	RINGBUF_STAT_IN( rb, rejected_pushes, len - count );	\
+	RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + count - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
 	return count; }
-// 	{ rb->data_buffer[ RINGBUF_WRAP( rb, rb->input ) ] = src[ count++ ]; }
 
 #define	ringbuffer_pop_string_def( NAME, ... )	\
 	size_t	NAME ## _pop_string ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )	\
 	{ size_t count = 0;	\
-	if ( NAME ## _empty( rb ) ) return 0;	\
+	if ( NAME ## _empty( rb ) ) { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return 0; }	\
 	for ( ; limit-- &&			/* Check end of dest buffer... */	\
 		NAME ## _count( rb );		/*	and ring-buffer empty. */	\
 		rb->output++ )	{	\
 		dest[ count++ ] = RINGBUF_CURR_o( rb ); }	\
+	RINGBUF_STAT_OUT( rb, pops, count );	\
 	return count; }
 // 	for ( ; count < limit &&		/* Check end of dest buffer... */
 // 		dest[ count++ ] = rb->data_buffer[ RINGBUF_WRAP( rb, rb->output ) ]; }
@@ -92,27 +133,46 @@
 #define	ringbuffer_pop_cstring_def( NAME, ... )	\
 	size_t	NAME ## _pop_cstring ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )	\
 	{ size_t count = 0;	\
-	if ( NAME ## _empty( rb ) ) return 0;	\
+	if ( NAME ## _empty( rb ) ) { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return 0; }	\
 	for ( ; --limit &&			/* Check end of dest buffer (save space for terminator)... */	\
 		NAME ## _count( rb );		/*	and ring-buffer empty. */	\
 		rb->output++ )	{	\
 		dest[ count++ ] = RINGBUF_CURR_o( rb ); }	\
 	dest[ count ] = ( ( DATA_TYPE( NAME ) )0 );	\
+	RINGBUF_STAT_OUT( rb, pops, count );	\
 	return count; }
 
 #define	ringbuffer_pop_cstring_cond_def( NAME, SUFFIX, COND, BEHAV, ... )	\
 	size_t	NAME ## _pop_string_ ## SUFFIX ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit )	\
 	{ size_t count = 0;	\
-	if ( NAME ## _empty( rb ) ) return 0;	\
+	NAME ## _index_t start	= rb->output;	/* Skipped items are popped, not copied. */	\
+	( void )start;	\
+	if ( NAME ## _empty( rb ) ) { RINGBUF_STAT_OUT( rb, empty_polls, 1 ); return 0; }	\
 	for ( ; --limit &&			/* Check end of dest buffer (save space for terminator)... */	\
 		NAME ## _count( rb );		/*	and ring-buffer empty. */	\
 		rb->output++ )	{	\
 		PASTE_cond( COND, BEHAV )	\
 		dest[ count++ ] = RINGBUF_CURR_o( rb ); }	\
 	dest[ count ] = ( ( DATA_TYPE( NAME ) )0 );	\
+	RINGBUF_STAT_OUT( rb, pops, ( NAME ## _index_t )( rb->output - start ) );	\
 	return count; }
 // 	for ( ; count < ( limit - 1 ) &&	/* Check end of dest buffer (save space for terminator)... */
 
+#define	ringbuffer_pop_until_def( NAME, ... )	\
+	size_t	NAME ## _pop_until ( DECL_qualif( __VA_ARGS__ ) NAME *rb, DATA_TYPE( NAME ) *dest, size_t limit, DATA_TYPE( NAME ) delim )	\
+	{ NAME ## _index_t output	= rb->output;	\
+	size_t	count	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output ), pos;	\
+	if ( !limit ) return 0;	\
+	if ( !count ) RINGBUF_STAT_OUT( rb, empty_polls, 1 );	\
+	if ( count > --limit ) count = limit;	/* Save space for terminator. */	\
+	RINGBUF_FIND_( rb, output, count, delim, pos );	\
+	if ( pos < count ) count = pos + 1;	/* Take the delimiter as well. */	\
+	RINGBUF_COPY_OUT_( rb, output, dest, count );	\
+	dest[ count ] = ( ( DATA_TYPE( NAME ) )0 );	\
+	RINGBUF_STORE_RELEASE( &rb->output, output + count );	\
+	RINGBUF_STAT_OUT( rb, pops, count );	\
+	return count; }
+
 /** @} end String ring buffer function definition macros.. */
 
 
@@ -0,0 +1,308 @@
+#ifndef	RING_BUFFER_TRACE_H
+#	define	RING_BUFFER_TRACE_H
+
+/** Queueing-delay (push-to-pop latency) tracing for plain and SPSC ring buffers.
+ *
+ * Wraps an existing fixed-size ring-buffer type `RING` with a timestamp per slot,
+ * kept in a parallel array so data_buffer stays dense. Pushes stamp the slots
+ * they fill before publishing them; pops feed `now - stamp` into a log-bucket
+ * (HDR-style: `2^RINGBUF_HIST_SUB_BITS` linear sub-buckets per power of two)
+ * histogram kept per ring, on the consumer's cache line.
+ *
+ * \code
+	ringbuffer_spsc_declare_all( reqs, struct req, 1024 );
+	ringbuffer_spsc_define_all( reqs )
+	ringbuffer_spsc_bulk_define_all( reqs )		// `_push_n`/`_pop_n` are required.
+
+	ringbuffer_trace_declare_all( reqs_t, reqs );
+	ringbuffer_trace_define_all( reqs_t, reqs )
+
+	reqs_t_push( &q, &r );				// Producer.
+	reqs_t_pop_n( &q, batch, 32 );			// Consumer.
+
+	// Anywhere, e.g. a metrics thread:
+	struct ring_buffer_hist	h;
+	reqs_t_hist_snapshot( &q, &h );
+	p99	= ring_buffer_hist_percentile( &h, 990 );	// In RINGBUF_TRACE_CLOCK() units.
+ * \endcode
+ *
+ * Clock and probes (define before including):
+ *
+ * - `RINGBUF_TRACE_CLOCK()`: timestamp source, truncated to RINGBUF_TRACE_TIME_TYPE.
+ *   Defaults to nanoseconds (ktime_get_ns() / CLOCK_MONOTONIC); e.g.
+ *   `( uint32_t )__rdtsc()` is cheaper on x86. 32-bit stamps measure delays up to
+ *   2^32 ticks (about 4 s in nanoseconds).
+ * - `RINGBUF_TRACE_USDT` (user space): adds `ringbuf:push`/`ringbuf:pop` USDT probes
+ *   (`<sys/sdt.h>`), a nop until a tracer (bpftrace, perf, SystemTap) attaches.
+ * - `RINGBUF_TRACE_PROBE_PUSH( t, n )`/`RINGBUF_TRACE_PROBE_POP( t, n, delay )`:
+ *   custom hooks instead (e.g. the driver's own tracepoint under `__KERNEL__`);
+ *   `delay` is that of the oldest element popped.
+ *
+ * \note	Only the `_trace_` wrappers stamp and measure: bypassing them on `&q.ring`
+ * 	skews (pushes) or skips (pops) the histogram.
+ * \note	Fixed-size ring-buffers only (the stamp array is sized with BUFFER_LEN).
+ */
+
+
+#include "ring_buffer_bulk.h"
+
+#ifdef __KERNEL__
+#	include <linux/timekeeping.h>
+#else
+#	include <time.h>
+#	ifdef	RINGBUF_TRACE_USDT
+#		include <sys/sdt.h>
+#	endif
+#endif
+
+
+/** Tracing helpers. @{ */
+
+/// Per-slot timestamp type: delays wrap at its range.
+#ifndef	RINGBUF_TRACE_TIME_TYPE
+#	define	RINGBUF_TRACE_TIME_TYPE	uint32_t
+#endif
+
+typedef	RINGBUF_TRACE_TIME_TYPE	ringbuf_time_t;
+
+#ifndef	RINGBUF_TRACE_CLOCK
+#	ifdef __KERNEL__
+#		define	RINGBUF_TRACE_CLOCK()	( ( ringbuf_time_t )ktime_get_ns() )
+#	else
+static inline ringbuf_time_t	ring_buffer_trace_clock ( void )
+{
+	struct timespec	ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ( ringbuf_time_t )( ( uint64_t )ts.tv_sec * 1000000000u + ( uint64_t )ts.tv_nsec );
+}
+#		define	RINGBUF_TRACE_CLOCK()	ring_buffer_trace_clock()
+#	endif
+#endif
+
+#ifndef	RINGBUF_TRACE_PROBE_PUSH
+#	ifdef	RINGBUF_TRACE_USDT
+#		define	RINGBUF_TRACE_PROBE_PUSH( t, n )	DTRACE_PROBE2( ringbuf, push, ( t ), ( n ) )
+#	else
+#		define	RINGBUF_TRACE_PROBE_PUSH( t, n )	do { } while ( 0 )
+#	endif
+#endif
+
+#ifndef	RINGBUF_TRACE_PROBE_POP
+#	ifdef	RINGBUF_TRACE_USDT
+#		define	RINGBUF_TRACE_PROBE_POP( t, n, delay )	DTRACE_PROBE3( ringbuf, pop, ( t ), ( n ), ( delay ) )
+#	else
+#		define	RINGBUF_TRACE_PROBE_POP( t, n, delay )	do { } while ( 0 )
+#	endif
+#endif
+
+/// Linear sub-buckets per power of two: 2^2 gives 25% worst-case bucket width.
+#ifndef	RINGBUF_HIST_SUB_BITS
+#	define	RINGBUF_HIST_SUB_BITS	2
+#endif
+
+#define	RINGBUF_HIST_SUB	( 1u << RINGBUF_HIST_SUB_BITS )
+#define	RINGBUF_HIST_BUCKETS	( ( 8 * sizeof( ringbuf_time_t ) + 1 - RINGBUF_HIST_SUB_BITS ) * RINGBUF_HIST_SUB )
+
+/** Delay histogram.
+ *
+ * \var count	Delays recorded.
+ * \var max	Largest delay recorded.
+ * \var bucket	Delays per bucket (see ring_buffer_hist_bucket/ring_buffer_hist_lower).
+ */
+struct ring_buffer_hist
+{
+	ringbuf_stat_t	count;
+	ringbuf_stat_t	max;
+	ringbuf_stat_t	bucket[ RINGBUF_HIST_BUCKETS ];
+};
+
+/// Bucket of delay `v`: values below RINGBUF_HIST_SUB get their own, then log-linear.
+static inline unsigned	ring_buffer_hist_bucket ( ringbuf_time_t v )
+{
+	unsigned	msb;
+
+	if ( v < RINGBUF_HIST_SUB )
+		return v;
+
+	msb	= 8 * sizeof( unsigned long long ) - 1 - __builtin_clzll( v );
+
+	return ( msb - RINGBUF_HIST_SUB_BITS + 1 ) * RINGBUF_HIST_SUB
+		+ ( ( v >> ( msb - RINGBUF_HIST_SUB_BITS ) ) & ( RINGBUF_HIST_SUB - 1 ) );
+}
+
+/// Smallest delay falling in bucket `b`.
+static inline uint64_t	ring_buffer_hist_lower ( unsigned b )
+{
+	unsigned	shift;
+
+	if ( b < RINGBUF_HIST_SUB )
+		return b;
+
+	shift	= b / RINGBUF_HIST_SUB - 1;
+
+	return ( uint64_t )( RINGBUF_HIST_SUB + b % RINGBUF_HIST_SUB ) << shift;
+}
+
+/** Delay below which `permille`/1000 of the recorded delays fall (bucket lower bound).
+ *
+ * \note	Run it on a `_hist_snapshot` copy.
+ */
+static inline uint64_t	ring_buffer_hist_percentile ( const struct ring_buffer_hist *h, unsigned permille )
+{
+	ringbuf_stat_t	rank	= ( h->count * permille + 999 ) / 1000, seen = 0;
+	unsigned	b;
+
+	for ( b = 0; b < RINGBUF_HIST_BUCKETS; b++ )
+		if ( ( seen += h->bucket[ b ] ) >= rank && seen )
+			return ring_buffer_hist_lower( b );
+
+	return 0;
+}
+
+/// Don't use. Record `n` delays `delay` (single writer: the consumer).
+#define	RINGBUF_HIST_ADD_( h, delay, n )	do {	\
+	unsigned	b_	= ring_buffer_hist_bucket( delay );	\
+	RINGBUF_STORE_RELAXED( &( h )->bucket[ b_ ], ( h )->bucket[ b_ ] + ( n ) );	\
+	RINGBUF_STORE_RELAXED( &( h )->count, ( h )->count + ( n ) );	\
+	if ( ( ringbuf_stat_t )( delay ) > ( h )->max )	\
+		RINGBUF_STORE_RELAXED( &( h )->max, ( ringbuf_stat_t )( delay ) ); } while ( 0 )
+
+/** @} end Tracing helpers. */
+
+
+// --------------------------------------
+/** Define traced ring buffer wrapper structure.
+ *
+ * \var ring		Wrapped ring-buffer.
+ * \var stamp		Push time of each slot of `ring.data_buffer`.
+ * \var hist		Delay histogram (consumer side).
+ */
+#define ringbuffer_trace_type_def( NAME, RING )	\
+	typedef struct ring_buffer_trace_ ## NAME	\
+	{					\
+		RING	ring;	\
+		ringbuf_time_t	stamp[ BUFFER_LEN( RING ) ]	RINGBUF_CACHELINE_ALIGNED;	\
+		struct ring_buffer_hist	hist	RINGBUF_CACHELINE_ALIGNED;	\
+	} NAME
+
+
+// --------------------------------------
+/** Traced ring buffer declaration macros. @{ */
+
+/** Reset the ring-buffer (no callbacks; `ring.push_batch_callback` may be set afterwards) and the histogram. */
+#define	ringbuffer_trace_init_decl( NAME, RING )	\
+	void	NAME ## _init ( NAME *t )
+
+/** Stamp and push `*data`. Returns false if full. */
+#define	ringbuffer_trace_push_decl( NAME, RING )	\
+	bool	NAME ## _push ( NAME *t, DATA_TYPE( RING ) *data )
+
+/** Pop into `*data`, recording its delay. Returns false if empty. */
+#define	ringbuffer_trace_pop_decl( NAME, RING )	\
+	bool	NAME ## _pop ( NAME *t, DATA_TYPE( RING ) *data )
+
+/** Stamp (one clock read) and push up to `len` elements from `src`. Returns the number pushed. */
+#define	ringbuffer_trace_push_n_decl( NAME, RING )	\
+	size_t	NAME ## _push_n ( NAME *t, const DATA_TYPE( RING ) *src, size_t len )
+
+/** Pop up to `limit` elements into `dest`, recording each delay (one clock read). Returns the number popped. */
+#define	ringbuffer_trace_pop_n_decl( NAME, RING )	\
+	size_t	NAME ## _pop_n ( NAME *t, DATA_TYPE( RING ) *dest, size_t limit )
+
+/** Copy the delay histogram into `hist`. Safe from any context; just a snapshot. */
+#define	ringbuffer_trace_hist_snapshot_decl( NAME, RING )	\
+	void	NAME ## _hist_snapshot ( NAME *t, struct ring_buffer_hist *hist )
+
+// --------------------------------------
+#define ringbuffer_trace_declare_all( NAME, RING )	\
+	ringbuffer_trace_type_def( NAME, RING );	\
+	\
+	ringbuffer_trace_init_decl( NAME, RING );	\
+	\
+	ringbuffer_trace_push_decl( NAME, RING );	\
+	\
+	ringbuffer_trace_pop_decl( NAME, RING );	\
+	\
+	ringbuffer_trace_push_n_decl( NAME, RING );	\
+	\
+	ringbuffer_trace_pop_n_decl( NAME, RING );	\
+	\
+	ringbuffer_trace_hist_snapshot_decl( NAME, RING )
+
+/** @} end Traced ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Traced ring buffer function definition macros. @{ */
+
+#define	ringbuffer_trace_init_def( NAME, RING )	\
+	void	NAME ## _init ( NAME *t )	{\
+		RING ## _init( &t->ring, NULL );	\
+		t->hist	= ( struct ring_buffer_hist ){ 0 }; }
+
+#define	ringbuffer_trace_push_def( NAME, RING )	\
+	bool	NAME ## _push ( NAME *t, DATA_TYPE( RING ) *data )	\
+	{ return NAME ## _push_n( t, data, 1 ); }
+
+#define	ringbuffer_trace_pop_def( NAME, RING )	\
+	bool	NAME ## _pop ( NAME *t, DATA_TYPE( RING ) *data )	\
+	{ return NAME ## _pop_n( t, data, 1 ); }
+
+/** Only slots known free are stamped: when full, the slot at `input` still holds the oldest element's stamp. */
+#define	ringbuffer_trace_push_n_def( NAME, RING )	\
+	size_t	NAME ## _push_n ( NAME *t, const DATA_TYPE( RING ) *src, size_t len )	{\
+		RING ## _index_t input	= t->ring.input;	\
+		size_t	n	= RINGBUF_CAPACITY( &t->ring ) - RING ## _count( &t->ring ), i;	\
+		ringbuf_time_t	now	= RINGBUF_TRACE_CLOCK();	\
+		if ( n > len ) n = len;	\
+		for ( i = 0; i < n; i++ )	\
+			t->stamp[ RINGBUF_WRAP( &t->ring, input + i ) ]	= now;	\
+		n	= RING ## _push_n( &t->ring, src, n );	\
+		RINGBUF_STAT_IN( &t->ring, rejected_pushes, len - n );	\
+		if ( n ) RINGBUF_TRACE_PROBE_PUSH( t, n );	\
+		return n; }
+
+#define	ringbuffer_trace_pop_n_def( NAME, RING )	\
+	size_t	NAME ## _pop_n ( NAME *t, DATA_TYPE( RING ) *dest, size_t limit )	{\
+		RING ## _index_t output	= t->ring.output;	\
+		size_t	n	= RING ## _count( &t->ring ), i;	\
+		ringbuf_time_t	now, delay	= 0;	\
+		if ( n > limit ) n = limit;	\
+		if ( !n )	\
+		{ RINGBUF_STAT_OUT( &t->ring, empty_polls, 1 ); return 0; }	\
+		now	= RINGBUF_TRACE_CLOCK();	\
+		for ( i = n; i--; )	/* Stamps are read before the slots are released; oldest last, for the probe. */	\
+		{ delay	= now - t->stamp[ RINGBUF_WRAP( &t->ring, output + i ) ];	\
+		  RINGBUF_HIST_ADD_( &t->hist, delay, 1 ); }	\
+		n	= RING ## _pop_n( &t->ring, dest, n );	\
+		RINGBUF_TRACE_PROBE_POP( t, n, delay );	\
+		return n; }
+
+#define	ringbuffer_trace_hist_snapshot_def( NAME, RING )	\
+	void	NAME ## _hist_snapshot ( NAME *t, struct ring_buffer_hist *hist )	{\
+		unsigned	b;	\
+		hist->count	= RINGBUF_LOAD_RELAXED( &t->hist.count );	\
+		hist->max	= RINGBUF_LOAD_RELAXED( &t->hist.max );	\
+		for ( b = 0; b < RINGBUF_HIST_BUCKETS; b++ )	\
+			hist->bucket[ b ]	= RINGBUF_LOAD_RELAXED( &t->hist.bucket[ b ] ); }
+
+// --------------------------------------
+#define ringbuffer_trace_define_all( NAME, RING )	\
+	ringbuffer_trace_init_def( NAME, RING )	\
+	\
+	ringbuffer_trace_push_n_def( NAME, RING )	\
+	\
+	ringbuffer_trace_pop_n_def( NAME, RING )	\
+	\
+	ringbuffer_trace_push_def( NAME, RING )	\
+	\
+	ringbuffer_trace_pop_def( NAME, RING )	\
+	\
+	ringbuffer_trace_hist_snapshot_def( NAME, RING )
+
+/** @} end Traced ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_TRACE_H
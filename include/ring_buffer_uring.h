@@ -0,0 +1,405 @@
+#ifndef	RING_BUFFER_URING_H
+#	define	RING_BUFFER_URING_H
+
+/** io_uring engine: asynchronous fill/drain of byte ring buffers (Linux user space only).
+ *
+ * One `struct ring_buffer_uring` engine services any number of ring-buffers from
+ * a single thread. Each ring side gets a `struct ring_buffer_uring_io` slot:
+ *
+ * - `_uring_fill` queues a read into the writable span (as `_reserve` would hand
+ *   out) and its completion commits what arrived, like `_commit`;
+ * - `_uring_drain` queues a write of the readable span (as `_peek_span`) and its
+ *   completion consumes what went out, like `_consume`.
+ *
+ * With `rearm` set, completions queue the next operation on the same slot (and
+ * with the same `max`), so drains chain until the ring is empty and fills until
+ * it is full or EOF.
+ * Operations are only queued; `ring_buffer_uring_submit()` sends them all in a
+ * single io_uring_enter(), and `ring_buffer_uring_reap()` runs completions.
+ *
+ * If data_buffer is registered (`ring_buffer_uring_register()` and
+ * RINGBUF_URING_IOVEC), pass its index as `buf_index` to use READ_FIXED and
+ * WRITE_FIXED; -1 uses plain READ/WRITE (Linux 5.6+).
+ *
+ * \code
+	ringbuffer_spsc_declare_all( logs, uint8_t, 1 << 16 );
+	ringbuffer_spsc_define_all( logs )
+	ringbuffer_uring_declare_all( logs );
+	ringbuffer_uring_define_all( logs )
+
+	struct ring_buffer_uring	u;
+	struct ring_buffer_uring_io	out;
+
+	ring_buffer_uring_init( &u, 64 );
+	ring_buffer_uring_register( &u, &RINGBUF_URING_IOVEC( &rb ), 1 );
+	logs_uring_io_init( &out, &u, &rb, sock, 0 );
+	out.rearm = true;
+	for ( ;; )
+	{
+		logs_uring_drain( &out, SIZE_MAX );	// No-op while one is in flight.
+		ring_buffer_uring_submit( &u, 1 );
+		ring_buffer_uring_reap( &u );
+	}
+ * \endcode
+ *
+ * \note	Byte ring-buffers only. At most one fill and one drain in flight per
+ * 	ring-buffer (use one slot for each): indices are committed in order.
+ * \note	Each operation covers a single contiguous segment, up to the wrap point;
+ * 	mirrored rings (ring_buffer_mirror.h) always offer the whole span.
+ * \note	The engine thread is the producer for rings it fills and the consumer
+ * 	for rings it drains.
+ * \note	With `RINGBUF_STATS`, completions count as `pushes`/`pops` (bytes), and
+ * 	drains finding the ring empty as `empty_polls`.
+ */
+
+
+#ifdef __KERNEL__
+#	error	"ring_buffer_uring.h is user space only."
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_io.h"
+
+
+/** io_uring engine. @{ */
+
+struct ring_buffer_uring_io;
+
+/// Engine: one io_uring instance.
+struct ring_buffer_uring
+{
+	int	fd;
+	unsigned	entries;
+	unsigned	*sq_head, *sq_tail, *sq_array, sq_mask;
+	unsigned	sq_pending;	///< Queued SQEs not yet seen by the kernel.
+	struct io_uring_sqe	*sqes;
+	unsigned	*cq_head, *cq_tail, cq_mask;
+	struct io_uring_cqe	*cqes;
+	void	*sq_map, *cq_map;
+	size_t	sq_map_len, cq_map_len, sqes_len;
+};
+
+/** Per ring-buffer side operation slot.
+ *
+ * \var done	Completion handler, set by the generated `_uring_fill`/`_uring_drain`.
+ * \var notify	Optional: called after each completion was committed/consumed.
+ * \var res	Last completion result: bytes moved, 0 (EOF on fills) or -errno.
+ * \var rearm	Queue the next operation from the completion.
+ * \var max	Byte limit of the last operation queued, reused when re-arming.
+ * \var busy	An operation is in flight.
+ */
+struct ring_buffer_uring_io
+{
+	void	( *done )( struct ring_buffer_uring_io *io, int res );
+	void	( *notify )( struct ring_buffer_uring_io *io );
+	struct ring_buffer_uring	*uring;
+	void	*rb;
+	int	fd;
+	int	buf_index;
+	int	res;
+	bool	rearm;
+	bool	busy;
+	size_t	max;
+};
+
+/// `struct iovec` covering data_buffer of `rb` (including the mirror, if any), for `ring_buffer_uring_register()`.
+#define	RINGBUF_URING_IOVEC( rb )	\
+	( ( struct iovec ){ ( void * )&( rb )->data_buffer[ 0 ], RINGBUF_LINEAR( rb ) * sizeof( ( rb )->data_buffer[ 0 ] ) } )
+
+/** Set up an io_uring of (at least) `entries` submission slots.
+ *
+ * \return	0, or -errno.
+ */
+static inline int	ring_buffer_uring_init ( struct ring_buffer_uring *u, unsigned entries )
+{
+	struct io_uring_params	p;
+	char	*sq, *cq;
+
+	memset( &p, 0, sizeof( p ) );
+	memset( u, 0, sizeof( *u ) );
+	if ( ( u->fd = ( int )syscall( __NR_io_uring_setup, entries, &p ) ) < 0 )
+		return -errno;
+
+	u->sq_map_len	= p.sq_off.array + p.sq_entries * sizeof( unsigned );
+	u->cq_map_len	= p.cq_off.cqes + p.cq_entries * sizeof( struct io_uring_cqe );
+	u->sqes_len	= p.sq_entries * sizeof( struct io_uring_sqe );
+	if ( p.features & IORING_FEAT_SINGLE_MMAP )
+		u->sq_map_len	= u->cq_map_len	= u->sq_map_len > u->cq_map_len ? u->sq_map_len : u->cq_map_len;
+
+	u->sq_map	= mmap( NULL, u->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING );
+	u->cq_map	= ( p.features & IORING_FEAT_SINGLE_MMAP ) ? u->sq_map
+		: mmap( NULL, u->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_CQ_RING );
+	u->sqes		= mmap( NULL, u->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES );
+
+	if ( u->sq_map == MAP_FAILED || u->cq_map == MAP_FAILED || u->sqes == MAP_FAILED )
+	{
+		int	err = errno;
+
+		if ( u->sqes != MAP_FAILED ) munmap( u->sqes, u->sqes_len );
+		if ( u->cq_map != MAP_FAILED && u->cq_map != u->sq_map ) munmap( u->cq_map, u->cq_map_len );
+		if ( u->sq_map != MAP_FAILED ) munmap( u->sq_map, u->sq_map_len );
+		close( u->fd );
+		u->fd	= -1;
+		return -err;
+	}
+
+	sq		= u->sq_map;
+	cq		= u->cq_map;
+	u->entries	= p.sq_entries;
+	u->sq_head	= ( unsigned * )( sq + p.sq_off.head );
+	u->sq_tail	= ( unsigned * )( sq + p.sq_off.tail );
+	u->sq_array	= ( unsigned * )( sq + p.sq_off.array );
+	u->sq_mask	= *( unsigned * )( sq + p.sq_off.ring_mask );
+	u->cq_head	= ( unsigned * )( cq + p.cq_off.head );
+	u->cq_tail	= ( unsigned * )( cq + p.cq_off.tail );
+	u->cq_mask	= *( unsigned * )( cq + p.cq_off.ring_mask );
+	u->cqes		= ( struct io_uring_cqe * )( cq + p.cq_off.cqes );
+
+	return 0;
+}
+
+static inline void	ring_buffer_uring_exit ( struct ring_buffer_uring *u )
+{
+	if ( u->fd < 0 )
+		return;
+
+	munmap( u->sqes, u->sqes_len );
+	if ( u->cq_map != u->sq_map )
+		munmap( u->cq_map, u->cq_map_len );
+	munmap( u->sq_map, u->sq_map_len );
+	close( u->fd );
+	u->fd	= -1;
+}
+
+/** Register `n` buffers (e.g. RINGBUF_URING_IOVEC of each ring-buffer) for fixed I/O.
+ *
+ * \return	0, or -errno.
+ */
+static inline int	ring_buffer_uring_register ( struct ring_buffer_uring *u, const struct iovec *iov, unsigned n )
+{
+	return syscall( __NR_io_uring_register, u->fd, IORING_REGISTER_BUFFERS, iov, n ) < 0 ? -errno : 0;
+}
+
+/// Next free (zeroed) submission entry, or NULL if the submission queue is full.
+static inline struct io_uring_sqe	*ring_buffer_uring_get_sqe ( struct ring_buffer_uring *u )
+{
+	unsigned	tail	= *u->sq_tail + u->sq_pending;
+	struct io_uring_sqe	*sqe;
+
+	if ( tail - RINGBUF_LOAD_ACQUIRE( u->sq_head ) >= u->entries )
+		return NULL;
+
+	sqe	= &u->sqes[ tail & u->sq_mask ];
+	memset( sqe, 0, sizeof( *sqe ) );
+	u->sq_array[ tail & u->sq_mask ]	= tail & u->sq_mask;
+	u->sq_pending++;
+
+	return sqe;
+}
+
+/** Hand all queued operations to the kernel in one call, waiting for `wait_nr` completions.
+ *
+ * \return	Operations submitted, or -errno.
+ */
+static inline int	ring_buffer_uring_submit ( struct ring_buffer_uring *u, unsigned wait_nr )
+{
+	unsigned	n	= u->sq_pending;
+	long	ret;
+
+	RINGBUF_STORE_RELEASE( u->sq_tail, *u->sq_tail + n );
+	u->sq_pending	= 0;
+	if ( !n && !wait_nr )
+		return 0;
+
+	ret	= syscall( __NR_io_uring_enter, u->fd, n, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0 );
+
+	return ret < 0 ? -errno : ( int )ret;
+}
+
+/** Run the handler of every available completion. Returns the number handled. */
+static inline unsigned	ring_buffer_uring_reap ( struct ring_buffer_uring *u )
+{
+	unsigned	head	= *u->cq_head, tail, n = 0;
+
+	for ( tail = RINGBUF_LOAD_ACQUIRE( u->cq_tail ); head != tail; tail = RINGBUF_LOAD_ACQUIRE( u->cq_tail ) )
+		while ( head != tail )
+		{
+			struct io_uring_cqe	*cqe	= &u->cqes[ head & u->cq_mask ];
+			struct ring_buffer_uring_io	*io	= ( struct ring_buffer_uring_io * )( uintptr_t )cqe->user_data;
+			int	res	= cqe->res;
+
+			RINGBUF_STORE_RELEASE( u->cq_head, ++head );	// Free the slot before the handler queues more.
+			io->busy	= false;
+			io->res		= res;
+			io->done( io, res );
+			if ( io->notify )
+				io->notify( io );
+			++n;
+		}
+
+	return n;
+}
+
+/// Don't use. Fill `sqe` with a fixed/plain read or write of `len` bytes at `addr` for `io`.
+static inline void	ring_buffer_uring_prep_ ( struct io_uring_sqe *sqe, struct ring_buffer_uring_io *io,
+	bool write, void *addr, size_t len )
+{
+	if ( io->buf_index >= 0 )
+	{
+		sqe->opcode	= write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->buf_index	= ( __u16 )io->buf_index;
+	}
+	else
+		sqe->opcode	= write ? IORING_OP_WRITE : IORING_OP_READ;
+
+	sqe->fd		= io->fd;
+	sqe->off	= ( __u64 )-1;		// Current file position / streams.
+	sqe->addr	= ( __u64 )( uintptr_t )addr;
+	sqe->len	= len > UINT32_MAX ? UINT32_MAX : ( __u32 )len;
+	sqe->user_data	= ( __u64 )( uintptr_t )io;
+	io->busy	= true;
+}
+
+/** @} end io_uring engine. */
+
+
+// --------------------------------------
+/** io_uring ring buffer declaration macros. @{ */
+
+/** Bind `io` to ring-buffer `rb`, engine `u` and descriptor `fd` (`buf_index` -1: not registered). */
+#define	ringbuffer_uring_io_init_decl( NAME, ... )	\
+	void	NAME ## _uring_io_init ( struct ring_buffer_uring_io *io, struct ring_buffer_uring *u,	\
+		DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, int buf_index )
+
+/** Queue a read of up to `max` bytes into the writable span.
+ *
+ * \return	false if `io` is busy, the ring-buffer is full or the submission queue is.
+ */
+#define	ringbuffer_uring_fill_decl( NAME, ... )	\
+	bool	NAME ## _uring_fill ( struct ring_buffer_uring_io *io, size_t max )
+
+/** Queue a write of up to `max` bytes from the readable span.
+ *
+ * \return	false if `io` is busy, the ring-buffer is empty or the submission queue is full.
+ */
+#define	ringbuffer_uring_drain_decl( NAME, ... )	\
+	bool	NAME ## _uring_drain ( struct ring_buffer_uring_io *io, size_t max )
+
+/// Completion handlers (set on `io` by `_uring_fill`/`_uring_drain`).
+#define	ringbuffer_uring_done_decl( NAME, ... )	\
+	void	NAME ## _uring_fill_done ( struct ring_buffer_uring_io *io, int res );	\
+	void	NAME ## _uring_drain_done ( struct ring_buffer_uring_io *io, int res )
+
+// --------------------------------------
+#define ringbuffer_uring_declare_all( NAME, ... )	\
+	ringbuffer_uring_io_init_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_uring_fill_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_uring_drain_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_uring_done_decl( NAME, __VA_ARGS__ )
+
+/** @} end io_uring ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** io_uring ring buffer function definition macros. @{ */
+
+#define	ringbuffer_uring_io_init_def( NAME, ... )	\
+	void	NAME ## _uring_io_init ( struct ring_buffer_uring_io *io, struct ring_buffer_uring *u,	\
+		DECL_qualif( __VA_ARGS__ ) NAME *rb, int fd, int buf_index )	{\
+		RINGBUF_IO_BYTES_( NAME );	\
+		memset( io, 0, sizeof( *io ) );	\
+		io->uring	= u;	\
+		io->rb		= ( void * )rb;	\
+		io->fd		= fd;	\
+		io->buf_index	= buf_index; }
+
+/** Only the first contiguous segment is read, so the completion commits in order. */
+#define	ringbuffer_uring_fill_def( NAME, ... )	\
+	bool	NAME ## _uring_fill ( struct ring_buffer_uring_io *io, size_t max )	{\
+		DECL_qualif( __VA_ARGS__ ) NAME	*rb	= io->rb;	\
+		NAME ## _index_t input	= rb->input;	\
+		size_t	n	= RINGBUF_CAPACITY( rb ) - ( NAME ## _index_t )( input - RINGBUF_LOAD_ACQUIRE( &rb->output ) );	\
+		struct io_uring_sqe	*sqe;	\
+		if ( n > max ) n = max;	\
+		if ( io->busy || !n || !( sqe = ring_buffer_uring_get_sqe( io->uring ) ) ) return false;	\
+		io->done	= NAME ## _uring_fill_done;	\
+		io->max		= max;	\
+		ring_buffer_uring_prep_( sqe, io, false, ( void * )&rb->data_buffer[ RINGBUF_WRAP( rb, input ) ],	\
+			RINGBUF_SPAN_FIRST( rb, input, n ) );	\
+		return true; }
+
+#define	ringbuffer_uring_drain_def( NAME, ... )	\
+	bool	NAME ## _uring_drain ( struct ring_buffer_uring_io *io, size_t max )	{\
+		DECL_qualif( __VA_ARGS__ ) NAME	*rb	= io->rb;	\
+		NAME ## _index_t output	= rb->output;	\
+		size_t	n	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &rb->input ) - output );	\
+		struct io_uring_sqe	*sqe;	\
+		if ( n > max ) n = max;	\
+		if ( !n && !io->busy ) RINGBUF_STAT_OUT( rb, empty_polls, 1 );	\
+		if ( io->busy || !n || !( sqe = ring_buffer_uring_get_sqe( io->uring ) ) ) return false;	\
+		io->done	= NAME ## _uring_drain_done;	\
+		io->max		= max;	\
+		ring_buffer_uring_prep_( sqe, io, true, ( void * )&rb->data_buffer[ RINGBUF_WRAP( rb, output ) ],	\
+			RINGBUF_SPAN_FIRST( rb, output, n ) );	\
+		return true; }
+
+/** Commit/consume the bytes moved, then re-arm with the same `max`.
+ *
+ * Fills stop at EOF (`res` 0) and on errors. Drains only stop on errors: one
+ * completing with 0 bytes consumes nothing and re-arms, retrying the same span.
+ */
+#define	ringbuffer_uring_done_def( NAME, ... )	\
+	ringbuffer_uring_done_cb_def( NAME, RINGBUF_BATCH_INDIRECT, __VA_ARGS__ )
+
+#define	ringbuffer_uring_done_cb_def( NAME, CB, ... )	\
+	void	NAME ## _uring_fill_done ( struct ring_buffer_uring_io *io, int res )	{\
+		DECL_qualif( __VA_ARGS__ ) NAME	*rb	= io->rb;	\
+		NAME ## _index_t input	= rb->input;	\
+		if ( res <= 0 ) return;	\
+		RINGBUF_BATCH_( CB, rb, input, ( size_t )res );	\
+		RINGBUF_STORE_RELEASE( &rb->input, input + ( size_t )res );	\
+		RINGBUF_STAT_IN( rb, pushes, ( size_t )res );	\
+		RINGBUF_STAT_LEVEL( rb, ( NAME ## _index_t )( input + ( size_t )res - RINGBUF_LOAD_RELAXED( &rb->output ) ) );	\
+		if ( io->rearm ) NAME ## _uring_fill( io, io->max ); }	\
+	\
+	void	NAME ## _uring_drain_done ( struct ring_buffer_uring_io *io, int res )	{\
+		DECL_qualif( __VA_ARGS__ ) NAME	*rb	= io->rb;	\
+		if ( res < 0 ) return;	\
+		RINGBUF_STORE_RELEASE( &rb->output, rb->output + ( size_t )res );	\
+		RINGBUF_STAT_OUT( rb, pops, ( size_t )res );	\
+		if ( io->rearm ) NAME ## _uring_drain( io, io->max ); }
+
+// --------------------------------------
+#define ringbuffer_uring_define_all( NAME, ... )	\
+	ringbuffer_uring_io_init_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_fill_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_drain_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_done_def( NAME, __VA_ARGS__ )
+
+#define ringbuffer_uring_define_all_cb( NAME, CB, ... )	\
+	ringbuffer_uring_io_init_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_fill_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_drain_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_uring_done_cb_def( NAME, CB, __VA_ARGS__ )
+
+/** @} end io_uring ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_URING_H
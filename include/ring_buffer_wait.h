@@ -0,0 +1,448 @@
+#ifndef	RING_BUFFER_WAIT_H
+#	define	RING_BUFFER_WAIT_H
+
+/** Blocking (waitable) wrappers for SPSC ring buffers.
+ *
+ * Wraps an existing ring-buffer type `RING` together with its wait state, and
+ * generates pushes/pops that sleep until space/data is available or a timeout
+ * expires: futexes in Linux user space, wait queues under `__KERNEL__`.
+ *
+ * Blocking implies the producer and the consumer run concurrently, so `RING`
+ * \b must be an SPSC ring-buffer (ring_buffer_spsc.h, ring_buffer_shm.h): plain
+ * ones are not thread-safe, and are rejected at compile time (RINGBUF_SPSC_ASSERT).
+ *
+ * Sleepers announce themselves before re-checking the ring, and the other side
+ * only signals (syscall/wake_up) when someone is announced, so the uncontended
+ * fast path is a plain ring operation plus a fence and a load.
+ *
+ * Adaptive waiting
+ * ----------------
+ *
+ * `ring_buffer_wait_tune()` trades bounded latency for fewer wakeups:
+ *
+ * - `_pop_batch_wait` sleeps until `high_watermark` elements are queued or its
+ *   timeout (the batching deadline) passes, then drains whatever is there, and
+ *   pushes only wake it once `_count()` reaches `high_watermark`;
+ * - pops only wake a sleeping producer once `_count()` drops to `low_watermark`;
+ * - `_pop_wait` is not affected: any push wakes it as soon as the ring is not empty;
+ * - waiters first poll `spin_count` times with a cpu pause and `yield_count` times
+ *   yielding the cpu before parking.
+ *
+ * The defaults (high 1, low capacity - 1, no spinning) wake on every transition.
+ * Watermarks are clamped to the capacity, so a full ring always wakes batching
+ * consumers and a non-full one always (eventually) wakes producers.
+ *
+ * Usage
+ * -----
+ *
+ * \code
+	ringbuffer_spsc_declare_all( samples, int, 256 );
+	ringbuffer_spsc_define_all( samples )
+
+	ringbuffer_wait_declare_all( samples_wq, samples );
+	ringbuffer_wait_define_all( samples_wq, samples )
+
+	// Producer:
+	samples_wq_push_wait( &q, &value, 10 );		// Up to 10 ms.
+	// Consumer:
+	if ( samples_wq_pop_wait( &q, &value, -1 ) == 0 )	// Forever.
+		process( value );
+ * \endcode
+ *
+ * \note	Bypassing the wrappers (e.g. bulk pushes on `&q.ring`) must be followed by
+ * 	`ring_buffer_wake( &q.wait.not_empty )` and `ring_buffer_wake( &q.wait.batch )`
+ * 	(or `not_full` after pops).
+ * \note	`_pop_batch_wait` with a negative timeout waits for `high_watermark` elements,
+ * 	however long that takes: give it a deadline if the producer may stop below it.
+ * \note	With `RINGBUF_STATS`, timeouts are counted in the wait state (`push_timeouts`,
+ * 	`pop_timeouts`); the ring's `rejected_pushes` counts every failed attempt,
+ * 	so a blocking push adds one per poll or wakeup that still found the ring full.
+ */
+
+
+#include "ring_buffer_spsc.h"
+
+#ifdef __KERNEL__
+#	include <linux/wait.h>
+#	include <linux/jiffies.h>
+#	include <linux/errno.h>
+#	include <linux/sched.h>
+#	include <asm/processor.h>
+#else
+#	include <sched.h>
+#	include <errno.h>
+#	include <limits.h>
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/syscall.h>
+#	include <linux/futex.h>
+#endif
+
+
+/** Wait state. @{ */
+
+/// One waitable condition (not_empty, batch or not_full), on its own cache line.
+struct ring_buffer_waitq
+{
+#ifdef __KERNEL__
+	wait_queue_head_t	wq;
+#else
+	uint32_t	seq;		///< Futex word: bumped on every signal to sleepers.
+	uint32_t	waiters;	///< Announced sleepers.
+#endif
+} RINGBUF_CACHELINE_ALIGNED;
+
+struct ring_buffer_wait
+{
+	struct ring_buffer_waitq	not_empty;	///< `_pop_wait` consumers sleep here.
+	struct ring_buffer_waitq	batch;		///< `_pop_batch_wait` consumers sleep here.
+	struct ring_buffer_waitq	not_full;	///< Producers sleep here.
+
+	size_t		capacity;	///< Ring capacity, bounding the watermarks.
+
+	/** Tunables: read-only once the ring is in use. @{ */
+	size_t		high_watermark;	///< Wake batching consumers once `_count()` reaches this.
+	size_t		low_watermark;	///< Wake the producer once `_count()` drops to this.
+	unsigned	spin_count;	///< Polls with a cpu pause before yielding.
+	unsigned	yield_count;	///< Polls yielding the cpu before parking.
+	/** @} */
+
+#ifdef	RINGBUF_STATS
+	ringbuf_stat_t	push_timeouts;	///< `_push_wait` calls that timed out. Producer only.
+	ringbuf_stat_t	pop_timeouts;	///< `_pop_wait` timeouts and `_pop_batch_wait` deadlines. Consumer only.
+#endif
+};
+
+#ifdef	RINGBUF_STATS
+/// Don't use. Count a timeout in `field` of wait state `w`.
+#	define	RINGBUF_WAIT_STAT_( w, field )	\
+		RINGBUF_STORE_RELAXED( &( w )->field, ( w )->field + 1 )
+#	define	RINGBUF_WAIT_STATS_RESET_( w )	( ( w )->push_timeouts = ( w )->pop_timeouts = 0 )
+#else
+#	define	RINGBUF_WAIT_STAT_( w, field )	do { } while ( 0 )
+#	define	RINGBUF_WAIT_STATS_RESET_( w )	( ( void )( w ) )
+#endif
+
+/** @} end Wait state. */
+
+
+/** Wait helpers. @{ */
+
+#ifdef __KERNEL__
+#	define	RINGBUF_CPU_RELAX()	cpu_relax()
+#	define	RINGBUF_CPU_YIELD()	cond_resched()
+#elif defined( __x86_64__ ) || defined( __i386__ )
+#	define	RINGBUF_CPU_RELAX()	__builtin_ia32_pause()
+#elif defined( __aarch64__ ) || defined( __arm__ )
+#	define	RINGBUF_CPU_RELAX()	__asm__ __volatile__( "yield" ::: "memory" )
+#else
+#	define	RINGBUF_CPU_RELAX()	__asm__ __volatile__( "" ::: "memory" )
+#endif
+
+#ifndef	RINGBUF_CPU_YIELD
+#	define	RINGBUF_CPU_YIELD()	sched_yield()
+#endif
+
+/// Don't use. Poll `TRY` through the spin and yield phases; `ok` tells whether it succeeded.
+#define	RINGBUF_SPIN_FOR_( w, TRY, ok )	do {	\
+	unsigned	i_;	\
+	for ( i_ = 0; !( ok = ( TRY ) ) && i_ < ( w )->spin_count; ++i_ )	\
+		RINGBUF_CPU_RELAX();	\
+	for ( i_ = 0; !ok && i_ < ( w )->yield_count; ++i_ )	\
+	{ RINGBUF_CPU_YIELD(); ok = ( TRY ); } } while ( 0 )
+
+#ifdef __KERNEL__
+
+static inline void	ring_buffer_waitq_init ( struct ring_buffer_waitq *q )
+{
+	init_waitqueue_head( &q->wq );
+}
+
+/// Signal `q` if someone is sleeping on it (wq_has_sleeper() implies the needed barrier).
+static inline void	ring_buffer_wake ( struct ring_buffer_waitq *q )
+{
+	if ( wq_has_sleeper( &q->wq ) )
+		wake_up_interruptible( &q->wq );
+}
+
+/** Don't use. Evaluate `TRY` until true, sleeping on `q` of wait state `w`.
+ *
+ * Runs `TIMEOUT` (a statement, `break` to just fall through) once `timeout_ms`
+ * passed, and returns -ERESTARTSYS from the caller if interrupted.
+ */
+#define	RINGBUF_WAIT_FOR_( w, q, TRY, timeout_ms, TIMEOUT )	do {	\
+	long	ret_;	\
+	bool	ok_;	\
+	RINGBUF_SPIN_FOR_( w, TRY, ok_ );	\
+	if ( ok_ ) break;	\
+	ret_ = wait_event_interruptible_timeout( ( q )->wq, ( TRY ),	\
+		( timeout_ms ) < 0 ? MAX_SCHEDULE_TIMEOUT : msecs_to_jiffies( timeout_ms ) );	\
+	if ( ret_ < 0 ) return ret_;	\
+	if ( !ret_ ) { TIMEOUT; } } while ( 0 )
+
+#else
+
+static inline void	ring_buffer_waitq_init ( struct ring_buffer_waitq *q )
+{
+	q->seq = q->waiters = 0;
+}
+
+/// Announce a sleeper; returns the futex value to sleep on. Re-check the ring afterwards.
+static inline uint32_t	ring_buffer_wait_enter ( struct ring_buffer_waitq *q )
+{
+	uint32_t	seq = __atomic_load_n( &q->seq, __ATOMIC_ACQUIRE );
+
+	__atomic_add_fetch( &q->waiters, 1, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );	// Announce before re-checking the ring.
+
+	return seq;
+}
+
+static inline void	ring_buffer_wait_leave ( struct ring_buffer_waitq *q )
+{
+	__atomic_sub_fetch( &q->waiters, 1, __ATOMIC_RELAXED );
+}
+
+/** Sleep on `q` unless it was signalled since `seq`, up to the absolute CLOCK_MONOTONIC `deadline` (NULL: forever).
+ *
+ * \return	-ETIMEDOUT once the deadline passed, 0 otherwise (woken, signalled or interrupted).
+ */
+static inline int	ring_buffer_wait_sleep ( struct ring_buffer_waitq *q, uint32_t seq, const struct timespec *deadline )
+{
+	long	ret = syscall( SYS_futex, &q->seq, FUTEX_WAIT_BITSET_PRIVATE, seq, deadline, NULL, FUTEX_BITSET_MATCH_ANY );
+	int	err = errno;
+
+	ring_buffer_wait_leave( q );
+
+	return ( ret < 0 && ETIMEDOUT == err ) ? -ETIMEDOUT : 0;
+}
+
+/// Signal `q` if someone is sleeping on it.
+static inline void	ring_buffer_wake ( struct ring_buffer_waitq *q )
+{
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );	// Publish the ring change before looking for sleepers.
+
+	if ( __atomic_load_n( &q->waiters, __ATOMIC_RELAXED ) )
+	{
+		__atomic_add_fetch( &q->seq, 1, __ATOMIC_RELEASE );
+		syscall( SYS_futex, &q->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+	}
+}
+
+/// Absolute CLOCK_MONOTONIC deadline `timeout_ms` from now.
+static inline void	ring_buffer_deadline ( struct timespec *deadline, long timeout_ms )
+{
+	clock_gettime( CLOCK_MONOTONIC, deadline );
+	deadline->tv_sec	+= timeout_ms / 1000;
+	deadline->tv_nsec	+= ( timeout_ms % 1000 ) * 1000000L;
+	if ( deadline->tv_nsec >= 1000000000L )
+	{
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000L;
+	}
+}
+
+/** Don't use. Evaluate `TRY` until true, sleeping on `q` of wait state `w`.
+ *
+ * Runs `TIMEOUT` (a statement, `break` to just fall through) once `timeout_ms` passed.
+ */
+#define	RINGBUF_WAIT_FOR_( w, q, TRY, timeout_ms, TIMEOUT )	do {	\
+	struct timespec	deadline_;	\
+	uint32_t	seq_;	\
+	bool	ok_;	\
+	RINGBUF_SPIN_FOR_( w, TRY, ok_ );	/* Fast path: no clock, no syscall. */	\
+	if ( ok_ ) break;	\
+	if ( ( timeout_ms ) >= 0 ) ring_buffer_deadline( &deadline_, ( timeout_ms ) );	\
+	for ( ;; )	{	\
+		seq_ = ring_buffer_wait_enter( q );	\
+		if ( TRY ) { ring_buffer_wait_leave( q ); break; }	\
+		if ( ring_buffer_wait_sleep( ( q ), seq_, ( timeout_ms ) >= 0 ? &deadline_ : NULL ) )	\
+		{ TIMEOUT; }	\
+		if ( TRY ) break; } } while ( 0 )
+
+#endif
+
+/// Reset `w` for a ring of `capacity` elements, with default (wake on every transition) tunables.
+static inline void	ring_buffer_wait_init ( struct ring_buffer_wait *w, size_t capacity )
+{
+	ring_buffer_waitq_init( &w->not_empty );
+	ring_buffer_waitq_init( &w->batch );
+	ring_buffer_waitq_init( &w->not_full );
+	w->capacity		= capacity;
+	w->high_watermark	= 1;
+	w->low_watermark	= capacity - 1;
+	w->spin_count		= 0;
+	w->yield_count		= 0;
+	RINGBUF_WAIT_STATS_RESET_( w );
+}
+
+/** Set the wakeup watermarks and spin phase of `w` (see Adaptive waiting).
+ *
+ * \note	Call before the ring is shared, after `_init`. `high` is clamped to
+ * 	`1 .. capacity` and `low` to `capacity - 1`: a watermark the ring can never
+ * 	reach would never wake anyone.
+ */
+static inline void	ring_buffer_wait_tune ( struct ring_buffer_wait *w, size_t low, size_t high,
+	unsigned spin_count, unsigned yield_count )
+{
+	w->high_watermark	= !high ? 1 : high > w->capacity ? w->capacity : high;
+	w->low_watermark	= low < w->capacity ? low : w->capacity - 1;
+	w->spin_count		= spin_count;
+	w->yield_count		= yield_count;
+}
+
+/** @} end Wait helpers. */
+
+
+// --------------------------------------
+/** Define waitable ring buffer type `NAME` wrapping a `RING` ring-buffer.
+ *
+ * \var ring	The wrapped ring-buffer. Use its functions directly for non-blocking access.
+ * \var wait	Wait state.
+ */
+#define ringbuffer_wait_type_def( NAME, RING )	\
+	RINGBUF_SPSC_ASSERT( RING, #NAME );	\
+	\
+	typedef struct ring_buffer_wait_ ## NAME	\
+	{					\
+		RING			ring;	\
+		struct ring_buffer_wait	wait;	\
+	} NAME
+
+
+// --------------------------------------
+/** Waitable ring buffer declaration macros. @{ */
+
+#define	ringbuffer_wait_init_decl( NAME, RING )	\
+	void	NAME ## _init ( NAME *w, RING ## _push_callback_t push_callback )
+
+/** Non-blocking push, waking a sleeping consumer. */
+#define	ringbuffer_wait_push_decl( NAME, RING )	\
+	bool	NAME ## _push ( NAME *w, DATA_TYPE( RING ) *data )
+
+/** Non-blocking pop into `data`, waking a sleeping producer. */
+#define	ringbuffer_wait_pop_decl( NAME, RING )	\
+	bool	NAME ## _pop ( NAME *w, DATA_TYPE( RING ) *data )
+
+/** Push, sleeping up to `timeout_ms` (negative: forever) while full.
+ *
+ * \return	0, -ETIMEDOUT, or (kernel) -ERESTARTSYS if interrupted.
+ */
+#define	ringbuffer_push_wait_decl( NAME, RING )	\
+	int	NAME ## _push_wait ( NAME *w, DATA_TYPE( RING ) *data, long timeout_ms )
+
+/** Pop into `data`, sleeping up to `timeout_ms` (negative: forever) while empty.
+ *
+ * \return	0, -ETIMEDOUT, or (kernel) -ERESTARTSYS if interrupted.
+ */
+#define	ringbuffer_pop_wait_decl( NAME, RING )	\
+	int	NAME ## _pop_wait ( NAME *w, DATA_TYPE( RING ) *data, long timeout_ms )
+
+/** Batching consumer: wait until `high_watermark` elements are queued or `timeout_ms`
+ * (negative: forever) passed, then pop up to `limit` of them into `dest`.
+ *
+ * \return	Elements popped (0 if the deadline passed on an empty ring), or (kernel)
+ * 	-ERESTARTSYS if interrupted.
+ */
+#define	ringbuffer_pop_batch_wait_decl( NAME, RING )	\
+	long	NAME ## _pop_batch_wait ( NAME *w, DATA_TYPE( RING ) *dest, size_t limit, long timeout_ms )
+
+// --------------------------------------
+#define ringbuffer_wait_declare_all( NAME, RING )	\
+	ringbuffer_wait_type_def( NAME, RING );	\
+	\
+	ringbuffer_wait_init_decl( NAME, RING );	\
+	\
+	ringbuffer_wait_push_decl( NAME, RING );	\
+	\
+	ringbuffer_wait_pop_decl( NAME, RING );	\
+	\
+	ringbuffer_push_wait_decl( NAME, RING );	\
+	\
+	ringbuffer_pop_wait_decl( NAME, RING );	\
+	\
+	ringbuffer_pop_batch_wait_decl( NAME, RING )
+
+/** @} end Waitable ring buffer declaration macros. */
+
+
+// --------------------------------------
+/** Waitable ring buffer function definition macros. @{ */
+
+/// Don't use. Copy the oldest element of `RING` `rb` into `data` and pop it.
+#define	RINGBUF_TRY_POP_( RING, rb, data, p )	\
+	( ( ( p ) = RING ## _peek( ( rb ), 0 ) ) && ( *( data ) = *( p ), RING ## _pop_back( rb ) ) )
+
+/// Don't use. Wake sleeping `_pop_wait` consumers of `w`, and batching ones if the high watermark is reached.
+#define	RINGBUF_WAKE_CONSUMER_( RING, w )	do {	\
+	ring_buffer_wake( &( w )->wait.not_empty );	\
+	if ( RING ## _count( &( w )->ring ) >= ( w )->wait.high_watermark )	\
+		ring_buffer_wake( &( w )->wait.batch ); } while ( 0 )
+
+/// Don't use. Wake a sleeping producer of `w` if the low watermark is reached.
+#define	RINGBUF_WAKE_PRODUCER_( RING, w )	do {	\
+	if ( RING ## _count( &( w )->ring ) <= ( w )->wait.low_watermark )	\
+		ring_buffer_wake( &( w )->wait.not_full ); } while ( 0 )
+
+#define	ringbuffer_wait_init_def( NAME, RING )	\
+	void	NAME ## _init ( NAME *w, RING ## _push_callback_t push_callback )	{\
+		RING ## _init( &w->ring, push_callback );	\
+		ring_buffer_wait_init( &w->wait, RINGBUF_CAPACITY( &w->ring ) ); }
+
+#define	ringbuffer_wait_push_def( NAME, RING )	\
+	bool	NAME ## _push ( NAME *w, DATA_TYPE( RING ) *data )	{\
+		if ( !RING ## _push_front( &w->ring, data ) ) return false;	\
+		RINGBUF_WAKE_CONSUMER_( RING, w );	\
+		return true; }
+
+#define	ringbuffer_wait_pop_def( NAME, RING )	\
+	bool	NAME ## _pop ( NAME *w, DATA_TYPE( RING ) *data )	{\
+		DATA_TYPE( RING )	*p;	\
+		if ( !RINGBUF_TRY_POP_( RING, &w->ring, data, p ) ) return false;	\
+		RINGBUF_WAKE_PRODUCER_( RING, w );	\
+		return true; }
+
+#define	ringbuffer_push_wait_def( NAME, RING )	\
+	int	NAME ## _push_wait ( NAME *w, DATA_TYPE( RING ) *data, long timeout_ms )	{\
+		RINGBUF_WAIT_FOR_( &w->wait, &w->wait.not_full, RING ## _push_front( &w->ring, data ),	\
+			timeout_ms, RINGBUF_WAIT_STAT_( &w->wait, push_timeouts ); return -ETIMEDOUT );	\
+		RINGBUF_WAKE_CONSUMER_( RING, w );	\
+		return 0; }
+
+#define	ringbuffer_pop_wait_def( NAME, RING )	\
+	int	NAME ## _pop_wait ( NAME *w, DATA_TYPE( RING ) *data, long timeout_ms )	{\
+		DATA_TYPE( RING )	*p;	\
+		RINGBUF_WAIT_FOR_( &w->wait, &w->wait.not_empty, RINGBUF_TRY_POP_( RING, &w->ring, data, p ),	\
+			timeout_ms, RINGBUF_WAIT_STAT_( &w->wait, pop_timeouts ); return -ETIMEDOUT );	\
+		RINGBUF_WAKE_PRODUCER_( RING, w );	\
+		return 0; }
+
+/** The deadline ends the wait but not the call: whatever is queued by then is drained. */
+#define	ringbuffer_pop_batch_wait_def( NAME, RING )	\
+	long	NAME ## _pop_batch_wait ( NAME *w, DATA_TYPE( RING ) *dest, size_t limit, long timeout_ms )	{\
+		DATA_TYPE( RING )	*p;	\
+		size_t	n	= 0;	\
+		RINGBUF_WAIT_FOR_( &w->wait, &w->wait.batch, RING ## _count( &w->ring ) >= w->wait.high_watermark,	\
+			timeout_ms, RINGBUF_WAIT_STAT_( &w->wait, pop_timeouts ); break );	\
+		while ( n < limit && RINGBUF_TRY_POP_( RING, &w->ring, dest + n, p ) ) ++n;	\
+		if ( n ) RINGBUF_WAKE_PRODUCER_( RING, w );	\
+		return ( long )n; }
+
+// --------------------------------------
+#define ringbuffer_wait_define_all( NAME, RING )	\
+	ringbuffer_wait_init_def( NAME, RING )	\
+	\
+	ringbuffer_wait_push_def( NAME, RING )	\
+	\
+	ringbuffer_wait_pop_def( NAME, RING )	\
+	\
+	ringbuffer_push_wait_def( NAME, RING )	\
+	\
+	ringbuffer_pop_wait_def( NAME, RING )	\
+	\
+	ringbuffer_pop_batch_wait_def( NAME, RING )
+
+/** @} end Waitable ring buffer function definition macros. */
+
+
+#endif	// RING_BUFFER_WAIT_H
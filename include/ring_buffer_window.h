@@ -0,0 +1,207 @@
+#ifndef	RING_BUFFER_WINDOW_H
+#	define	RING_BUFFER_WINDOW_H
+
+/** Segment-wise visitor and window kernels over used elements.
+ *
+ * A window is `n` used elements starting `offset` elements after the oldest one
+ * (as `_peek`). It is bounded and split once, at most in two contiguous segments
+ * (before and after the RINGBUF_WRAP boundary), and each segment is handed over
+ * whole: loops run linear, with no per-element masking or bounds check, and
+ * vectorize. Nothing is consumed.
+ *
+ * \code
+	// `samples` holds int; sums accumulate in int64_t.
+	ringbuffer_window_declare_all( samples, int64_t );	// Declares the generic part too.
+	ringbuffer_window_define_all( samples, int64_t )
+
+	// Moving average and range over the last K samples:
+	size_t	used	= samples_count( rb );
+	size_t	k	= used < K ? used : K;
+	int64_t	sum	= 0;
+	int	lo, hi;
+
+	if ( samples_window_sum( rb, used - k, k, &sum ) )
+		avg	= sum / ( int64_t )k;
+	samples_window_minmax( rb, used - k, k, &lo, &hi );
+
+	// Anything else:
+	static void	feed ( samples *rb, const int *first, size_t n, void *ctx )
+	{ fir_run( ctx, first, n ); }
+
+	samples_for_each_span( rb, 0, SIZE_MAX, feed, &fir );
+ * \endcode
+ *
+ * \note	Consumer side, on plain (ring_buffer.h) and SPSC (ring_buffer_spsc.h) ring-buffers.
+ * \note	`_window_sum`/`_window_minmax` need an arithmetic TYPE (the generic part,
+ * 	`_for_each_span` and `_window_crc32`, works with any); use
+ * 	`ringbuffer_window_span_declare_all`/`_define_all` alone otherwise.
+ */
+
+
+#include "ring_buffer_bulk.h"
+
+#ifdef __KERNEL__
+#	include <linux/crc32.h>
+#endif
+
+
+/** Window helpers. @{ */
+
+#ifdef __KERNEL__
+#	define	ring_buffer_crc32( crc, p, len )	crc32_le( ( crc ), ( const unsigned char * )( p ), ( len ) )
+#else
+/** CRC-32 (IEEE 802.3, reflected) update of `len` bytes at `p`, as the kernel crc32_le:
+ * no pre/post inversion. Seed with ~0 and invert the result for the usual CRC-32.
+ */
+static inline uint32_t	ring_buffer_crc32 ( uint32_t crc, const void *p, size_t len )
+{
+	static const uint32_t	nibble[ 16 ]	=
+	{
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+	};
+	const unsigned char	*b	= p;
+
+	while ( len-- )
+	{
+		crc	^= *b++;
+		crc	= ( crc >> 4 ) ^ nibble[ crc & 0x0f ];
+		crc	= ( crc >> 4 ) ^ nibble[ crc & 0x0f ];
+	}
+
+	return crc;
+}
+#endif
+
+/// Don't use. Bound window `n` (updated) to the used elements and split it in `seg`/`len`.
+#define	RINGBUF_WINDOW_( NAME, rb, offset, n, seg, len )	do {	\
+	NAME ## _index_t	output_	= ( rb )->output;	\
+	size_t	used_	= ( NAME ## _index_t )( RINGBUF_LOAD_ACQUIRE( &( rb )->input ) - output_ );	\
+	if ( ( size_t )( offset ) < used_ )	\
+	{ used_	-= ( size_t )( offset );	\
+	  if ( ( n ) > used_ ) ( n ) = used_;	\
+	  output_	+= ( offset ); }	\
+	else	\
+	  ( n )	= 0;	\
+	RINGBUF_SPAN_( ( rb ), output_, ( n ), &( seg )[ 0 ], &( len )[ 0 ], &( seg )[ 1 ], &( len )[ 1 ] ); } while ( 0 )
+
+/** @} end Window helpers. */
+
+
+// --------------------------------------
+/** Ring buffer window declaration macros. @{ */
+
+/// Segment visitor type: `first[ 0 .. n )` is one contiguous part of the window, in order.
+#define	ringbuffer_span_fn_def( NAME, ... )	\
+	typedef void ( * NAME ## _span_fn_t )( DECL_qualif( __VA_ARGS__ ) NAME *rb,	\
+		DECL_qualif( __VA_ARGS__ ) const DATA_TYPE( NAME ) *first, size_t n, void *ctx )
+
+/** Call `fn` on each contiguous segment (one or two) of the window.
+ *
+ * \return	Window length (0 if `offset` is past the used elements; `fn` is not called then).
+ */
+#define	ringbuffer_for_each_span_decl( NAME, ... )	\
+	size_t	NAME ## _for_each_span ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n,	\
+		NAME ## _span_fn_t fn, void *ctx )
+
+/** Update `*crc` (see ring_buffer_crc32) with the window bytes. Returns the window length. */
+#define	ringbuffer_window_crc32_decl( NAME, ... )	\
+	size_t	NAME ## _window_crc32 ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n, uint32_t *crc )
+
+/** Add the window elements to `*sum` (in `ACC` arithmetic). Returns the window length. */
+#define	ringbuffer_window_sum_decl( NAME, ACC, ... )	\
+	size_t	NAME ## _window_sum ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n, ACC *sum )
+
+/** Store the window minimum and maximum. Returns the window length (`*min`, `*max` untouched if 0). */
+#define	ringbuffer_window_minmax_decl( NAME, ... )	\
+	size_t	NAME ## _window_minmax ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n,	\
+		DATA_TYPE( NAME ) *min, DATA_TYPE( NAME ) *max )
+
+// --------------------------------------
+#define ringbuffer_window_span_declare_all( NAME, ... )	\
+	ringbuffer_span_fn_def( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_for_each_span_decl( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_window_crc32_decl( NAME, __VA_ARGS__ )
+
+#define ringbuffer_window_declare_all( NAME, ACC, ... )	\
+	ringbuffer_window_span_declare_all( NAME, __VA_ARGS__ );	\
+	\
+	ringbuffer_window_sum_decl( NAME, ACC, __VA_ARGS__ );	\
+	\
+	ringbuffer_window_minmax_decl( NAME, __VA_ARGS__ )
+
+/** @} end Ring buffer window declaration macros. */
+
+
+// --------------------------------------
+/** Ring buffer window function definition macros. @{ */
+
+#define	ringbuffer_for_each_span_def( NAME, ... )	\
+	size_t	NAME ## _for_each_span ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n,	\
+		NAME ## _span_fn_t fn, void *ctx )	{\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME )	*seg[ 2 ];	\
+		size_t	len[ 2 ];	\
+		RINGBUF_WINDOW_( NAME, rb, offset, n, seg, len );	\
+		if ( len[ 0 ] ) fn( rb, seg[ 0 ], len[ 0 ], ctx );	\
+		if ( len[ 1 ] ) fn( rb, seg[ 1 ], len[ 1 ], ctx );	\
+		return n; }
+
+#define	ringbuffer_window_crc32_def( NAME, ... )	\
+	size_t	NAME ## _window_crc32 ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n, uint32_t *crc )	{\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME )	*seg[ 2 ];	\
+		size_t	len[ 2 ];	\
+		RINGBUF_WINDOW_( NAME, rb, offset, n, seg, len );	\
+		*crc	= ring_buffer_crc32( *crc, ( const void * )seg[ 0 ], len[ 0 ] * sizeof( DATA_TYPE( NAME ) ) );	\
+		*crc	= ring_buffer_crc32( *crc, ( const void * )seg[ 1 ], len[ 1 ] * sizeof( DATA_TYPE( NAME ) ) );	\
+		return n; }
+
+#define	ringbuffer_window_sum_def( NAME, ACC, ... )	\
+	size_t	NAME ## _window_sum ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n, ACC *sum )	{\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME )	*seg[ 2 ];	\
+		size_t	len[ 2 ], s, i;	\
+		ACC	acc	= *sum;	\
+		RINGBUF_WINDOW_( NAME, rb, offset, n, seg, len );	\
+		for ( s = 0; s < 2; s++ )	\
+			for ( i = 0; i < len[ s ]; i++ )	\
+				acc	+= ( ACC )seg[ s ][ i ];	\
+		*sum	= acc;	\
+		return n; }
+
+/** Branch-free select in the inner loop, so it vectorizes. */
+#define	ringbuffer_window_minmax_def( NAME, ... )	\
+	size_t	NAME ## _window_minmax ( DECL_qualif( __VA_ARGS__ ) NAME *rb, size_t offset, size_t n,	\
+		DATA_TYPE( NAME ) *min, DATA_TYPE( NAME ) *max )	{\
+		DECL_qualif( __VA_ARGS__ ) DATA_TYPE( NAME )	*seg[ 2 ];	\
+		size_t	len[ 2 ], s, i;	\
+		DATA_TYPE( NAME )	lo, hi;	\
+		RINGBUF_WINDOW_( NAME, rb, offset, n, seg, len );	\
+		if ( !n ) return 0;	\
+		lo = hi	= seg[ 0 ][ 0 ];	\
+		for ( s = 0; s < 2; s++ )	\
+			for ( i = 0; i < len[ s ]; i++ )	\
+			{ DATA_TYPE( NAME )	v = seg[ s ][ i ];	\
+			  lo	= v < lo ? v : lo;	\
+			  hi	= v > hi ? v : hi; }	\
+		*min	= lo;	\
+		*max	= hi;	\
+		return n; }
+
+// --------------------------------------
+#define ringbuffer_window_span_define_all( NAME, ... )	\
+	ringbuffer_for_each_span_def( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_window_crc32_def( NAME, __VA_ARGS__ )
+
+#define ringbuffer_window_define_all( NAME, ACC, ... )	\
+	ringbuffer_window_span_define_all( NAME, __VA_ARGS__ )	\
+	\
+	ringbuffer_window_sum_def( NAME, ACC, __VA_ARGS__ )	\
+	\
+	ringbuffer_window_minmax_def( NAME, __VA_ARGS__ )
+
+/** @} end Ring buffer window function definition macros. */
+
+
+#endif	// RING_BUFFER_WINDOW_H
@@ -0,0 +1,591 @@
+/** fuzz_ring_buffer: operation sequences checked against a reference deque.
+ *
+ * Each input is read as a stream of opcode/argument bytes and replayed on every
+ * ring under test, each against its own model (a plain array deque, or index
+ * arithmetic where the API defines it):
+ * - plain:	fixed-size, `uint8_t` indices (wrapping every 256 elements): element,
+ *		bulk, span and overwriting operations;
+ * - spsc:	RINGBUF_SPSC_CACHED with `uint8_t` indices, single and bulk operations
+ *		mixed, so the cached remote indices must stay coherent;
+ * - dyn:	runtime-sized, 1 to 32 elements (from the first byte), as plain;
+ * - overwrite:	SPSC `_push_overwrite`/`_push_n_overwrite` with `_pop_overwrite`:
+ *		values popped and `lost` counts are exact in a single thread;
+ * - string:	`_push_string` with `_pop_string`, `_pop_cstring` and `_pop_until`;
+ * - record:	`_push_record`/`_peek_record`/`_pop_record`, padding at the wrap point.
+ *
+ * After every operation `_count`, `_empty`, `_full` and `_peek` at each offset
+ * are checked as well. All rings are built with RINGBUF_DEBUG.
+ *
+ * Built as a libFuzzer target with clang (RINGBUF_LIBFUZZER); otherwise `main`
+ * below replays the files given on the command line, or random inputs, taking
+ * the same options as libFuzzer does:
+ * \code
+	fuzz_ring_buffer [-runs=N] [-seed=S] [-max_len=N] [FILE...]
+ * \endcode
+ * A failure prints the check and aborts; the standalone driver also saves the
+ * input to `fuzz-crash.bin`, to be replayed as a FILE.
+ */
+
+#include <stdlib.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_dynamic.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_overwrite.h"
+#include "ring_buffer_string.h"
+#include "ring_buffer_record.h"
+
+#include "test.h"
+
+
+// --------------------------------------
+/** Failure reporting and input. @{ */
+
+static const uint8_t	*fuzz_data_;	///< Current input (standalone driver only).
+static size_t		fuzz_size_;
+
+static void	fuzz_fail ( const char *suite, size_t pos, int line, const char *expr )
+{
+	FILE	*f;
+
+	fprintf( stderr, "fuzz_ring_buffer.c:%d: %s, input offset %zu: check failed: %s\n", line, suite, pos, expr );
+	if ( fuzz_data_ && ( f = fopen( "fuzz-crash.bin", "wb" ) ) )
+	{
+		fwrite( fuzz_data_, 1, fuzz_size_, f );
+		fclose( f );
+		fprintf( stderr, "input (%zu bytes) saved to fuzz-crash.bin\n", fuzz_size_ );
+	}
+	abort();
+}
+
+struct fuzz_in
+{
+	const char	*suite;
+	const uint8_t	*p, *begin, *end;
+};
+
+/// Next input byte (0 past the end).
+static inline uint8_t	fuzz_byte ( struct fuzz_in *in )
+{
+	return in->p < in->end ? *in->p++ : 0;
+}
+
+#define	FUZZ_CHECK( in, cond )	do {	\
+	if ( !( cond ) )	\
+		fuzz_fail( ( in )->suite, ( size_t )( ( in )->p - ( in )->begin ), __LINE__, #cond ); } while ( 0 )
+
+/** @} */
+
+
+// --------------------------------------
+/** Reference deque. @{ */
+
+#define	MODEL_MAX	64
+
+struct model
+{
+	uint32_t	v[ MODEL_MAX ];
+	size_t		head, n, cap;
+};
+
+static inline void	model_init ( struct model *m, size_t cap )
+{
+	m->head	= m->n = 0;
+	m->cap	= cap;
+}
+
+static inline bool	model_push ( struct model *m, uint32_t x )
+{
+	if ( m->n == m->cap )
+		return false;
+	m->v[ ( m->head + m->n++ ) % MODEL_MAX ]	= x;
+	return true;
+}
+
+static inline uint32_t	model_pop ( struct model *m )
+{
+	uint32_t	x = m->v[ m->head ];
+
+	m->head	= ( m->head + 1 ) % MODEL_MAX;
+	m->n--;
+	return x;
+}
+
+static inline uint32_t	model_at ( const struct model *m, size_t i )
+{
+	return m->v[ ( m->head + i ) % MODEL_MAX ];
+}
+
+static inline size_t	min_sz ( size_t a, size_t b )
+{
+	return a < b ? a : b;
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Element, bulk, span and (plain) overwrite operations. @{ */
+
+/// Largest length argument: up to twice the largest capacity, plus one.
+#define	FUZZ_LEN_MAX	( 2 * MODEL_MAX + 1 )
+
+enum
+{
+	FUZZ_PUSH_FRONT,
+	FUZZ_POP_BACK,
+	FUZZ_PUSH_N,
+	FUZZ_POP_N,
+	FUZZ_RESERVE_COMMIT,
+	FUZZ_PEEK_SPAN_CONSUME,
+	FUZZ_ELEM_OPS,			///< Operations of every ring with the element API.
+	FUZZ_PUSH_OVERWRITE = FUZZ_ELEM_OPS,
+	FUZZ_PUSH_N_OVERWRITE,
+	FUZZ_PLAIN_OPS			///< Plus (non-SPSC) overwriting pushes.
+};
+
+/// `_count`, `_empty`, `_full` and `_peek` at every offset (and one past the end) against `m`.
+#define	FUZZ_CHECK_STATE( NAME, in, rb, m )	do {	\
+	size_t	i_;	\
+	FUZZ_CHECK( in, NAME ## _count( rb ) == ( m )->n );	\
+	FUZZ_CHECK( in, NAME ## _empty( rb ) == !( m )->n );	\
+	FUZZ_CHECK( in, NAME ## _full( rb ) == ( ( m )->n == ( m )->cap ) );	\
+	for ( i_ = 0; i_ <= ( m )->n; ++i_ )	{	\
+		uint32_t	*p_ = NAME ## _peek( rb, i_ );	\
+		FUZZ_CHECK( in, i_ < ( m )->n ? p_ && *p_ == model_at( m, i_ ) : !p_ ); } } while ( 0 )
+
+/// Check a `_reserve`/`_peek_span` split of `n` elements starting at `index`.
+#define	FUZZ_CHECK_SPAN( in, rb, index, n, p1, l1, p2, l2 )	do {	\
+	FUZZ_CHECK( in, ( l1 ) + ( l2 ) == ( n ) );	\
+	FUZZ_CHECK( in, ( p1 ) == &( rb )->data_buffer[ RINGBUF_WRAP( rb, index ) ] );	\
+	FUZZ_CHECK( in, ( l1 ) == min_sz( ( n ), RINGBUF_TO_END( rb, index ) ) );	\
+	FUZZ_CHECK( in, ( l2 ) ? ( p2 ) == &( rb )->data_buffer[ 0 ] : !( p2 ) ); } while ( 0 )
+
+/** `static void NAME_fuzz_op( rb, m, in, op, next )`: run `op` on `rb` and `m`.
+ *
+ * Elements pushed take the values `*next`, `*next + 1`, ... With `OVERWRITE`
+ * (true for non-SPSC rings) the overwriting pushes are run as well.
+ */
+#define	FUZZ_ELEM_DEF( NAME, OVERWRITE )	\
+	static void	NAME ## _fuzz_op ( NAME *rb, struct model *m, struct fuzz_in *in, unsigned op, uint32_t *next )	\
+	{	\
+		uint32_t	buf[ FUZZ_LEN_MAX ], x, *p1, *p2;	\
+		size_t		len = fuzz_byte( in ) % ( 2 * m->cap + 2 ), n, l1, l2, i, lost;	\
+		bool		ok;	\
+		\
+		switch ( op )	\
+		{	\
+		case FUZZ_PUSH_FRONT:	\
+			x	= *next;	\
+			ok	= model_push( m, x );	\
+			FUZZ_CHECK( in, NAME ## _push_front( rb, &x ) == ok );	\
+			*next	+= ok;	\
+			break;	\
+		case FUZZ_POP_BACK:	\
+			FUZZ_CHECK( in, NAME ## _pop_back( rb ) == !!m->n );	\
+			if ( m->n ) model_pop( m );	\
+			break;	\
+		case FUZZ_PUSH_N:	\
+			for ( i = 0; i < len; ++i ) buf[ i ] = *next + i;	\
+			n	= NAME ## _push_n( rb, buf, len );	\
+			FUZZ_CHECK( in, n == min_sz( len, m->cap - m->n ) );	\
+			for ( i = 0; i < n; ++i ) model_push( m, ( *next )++ );	\
+			break;	\
+		case FUZZ_POP_N:	\
+			n	= NAME ## _pop_n( rb, buf, len );	\
+			FUZZ_CHECK( in, n == min_sz( len, m->n ) );	\
+			for ( i = 0; i < n; ++i ) FUZZ_CHECK( in, buf[ i ] == model_pop( m ) );	\
+			break;	\
+		case FUZZ_RESERVE_COMMIT:	\
+			n	= NAME ## _reserve( rb, len, &p1, &l1, &p2, &l2 );	\
+			FUZZ_CHECK( in, n == min_sz( len, m->cap - m->n ) );	\
+			FUZZ_CHECK_SPAN( in, rb, rb->input, n, p1, l1, p2, l2 );	\
+			n	= fuzz_byte( in ) % ( n + 1 );	/* Commit part of it. */	\
+			for ( i = 0; i < n; ++i )	\
+			{ *( i < l1 ? &p1[ i ] : &p2[ i - l1 ] ) = *next; model_push( m, ( *next )++ ); }	\
+			NAME ## _commit( rb, n );	\
+			break;	\
+		case FUZZ_PEEK_SPAN_CONSUME:	\
+			n	= NAME ## _peek_span( rb, len, &p1, &l1, &p2, &l2 );	\
+			FUZZ_CHECK( in, n == min_sz( len, m->n ) );	\
+			FUZZ_CHECK_SPAN( in, rb, rb->output, n, p1, l1, p2, l2 );	\
+			for ( i = 0; i < n; ++i )	\
+				FUZZ_CHECK( in, ( i < l1 ? p1[ i ] : p2[ i - l1 ] ) == model_at( m, i ) );	\
+			n	= fuzz_byte( in ) % ( n + 1 );	/* Consume part of it. */	\
+			NAME ## _consume( rb, n );	\
+			for ( i = 0; i < n; ++i ) model_pop( m );	\
+			break;	\
+		case FUZZ_PUSH_OVERWRITE:	\
+			if ( !( OVERWRITE ) ) break;	\
+			x	= ( *next )++;	\
+			lost	= m->n == m->cap;	\
+			if ( lost ) model_pop( m );	\
+			model_push( m, x );	\
+			FUZZ_CHECK( in, FUZZ_OVERWRITE_CALL_( OVERWRITE, NAME ## _push_overwrite( rb, &x ) ) == lost );	\
+			break;	\
+		case FUZZ_PUSH_N_OVERWRITE:	\
+			if ( !( OVERWRITE ) ) break;	\
+			for ( i = 0; i < len; ++i ) buf[ i ] = *next + i;	\
+			n	= FUZZ_OVERWRITE_CALL_( OVERWRITE, NAME ## _push_n_overwrite( rb, buf, len ) );	\
+			lost	= len > m->cap ? len - m->cap : 0;	/* Only the last `cap` are kept... */	\
+			for ( i = lost; i < len; ++i )	\
+			{ if ( m->n == m->cap ) { model_pop( m ); lost++; }	/* ...dropping the oldest. */	\
+			  model_push( m, *next + i ); }	\
+			*next	+= len;	\
+			FUZZ_CHECK( in, n == lost );	\
+			break;	\
+		}	\
+		FUZZ_CHECK_STATE( NAME, in, rb, m );	\
+	}
+
+/// Don't use. `CALL` for rings with the plain overwriting pushes, 0 (never evaluated) otherwise.
+#define	FUZZ_OVERWRITE_CALL_( OVERWRITE, CALL )	FUZZ_OVERWRITE_CALL_ ## OVERWRITE( CALL )
+#define	FUZZ_OVERWRITE_CALL_1( CALL )	( CALL )
+#define	FUZZ_OVERWRITE_CALL_0( CALL )	( ( size_t )0 )
+
+/// Replay `in` on `rb` (initialised, empty), drawing opcodes among the first `ops`.
+#define	FUZZ_ELEM_RUN( NAME, in, rb, ops )	do {	\
+	struct model	m_;	\
+	uint32_t	next_ = 0;	\
+	model_init( &m_, RINGBUF_CAPACITY( rb ) );	\
+	while ( ( in )->p < ( in )->end )	\
+		NAME ## _fuzz_op( ( rb ), &m_, ( in ), fuzz_byte( in ) % ( ops ), &next_ ); } while ( 0 )
+
+
+ringbuffer_type_def_ex( fz_plain, uint32_t, 8, RINGBUF_PACKED, uint8_t );
+ringbuffer_define_all( fz_plain )
+ringbuffer_bulk_define_all( fz_plain )
+ringbuffer_push_overwrite_def( fz_plain )
+ringbuffer_push_n_overwrite_def( fz_plain )
+FUZZ_ELEM_DEF( fz_plain, 1 )
+
+ringbuffer_spsc_type_def_ex( fz_spsc, uint32_t, 16, uint8_t );
+ringbuffer_spsc_define_all( fz_spsc )
+ringbuffer_spsc_bulk_define_all( fz_spsc )
+FUZZ_ELEM_DEF( fz_spsc, 0 )
+
+ringbuffer_dyn_type_def( fz_dyn, uint32_t );
+ringbuffer_dyn_define_all( fz_dyn )
+ringbuffer_bulk_define_all( fz_dyn )
+ringbuffer_push_overwrite_def( fz_dyn )
+ringbuffer_push_n_overwrite_def( fz_dyn )
+FUZZ_ELEM_DEF( fz_dyn, 1 )
+
+static void	fuzz_plain ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "plain", data, data, data + size };
+	fz_plain	rb;
+
+	fz_plain_init( &rb, NULL );
+	FUZZ_ELEM_RUN( fz_plain, &in, &rb, FUZZ_PLAIN_OPS );
+}
+
+static void	fuzz_spsc ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "spsc", data, data, data + size };
+	fz_spsc		rb;
+
+	fz_spsc_init( &rb, NULL );
+	FUZZ_ELEM_RUN( fz_spsc, &in, &rb, FUZZ_ELEM_OPS );
+}
+
+static void	fuzz_dyn ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "dyn", data, data, data + size };
+	uint32_t	mem[ 32 ];
+	fz_dyn		rb;
+
+	FUZZ_CHECK( &in, fz_dyn_init_storage( &rb, mem, ( size_t )1 << ( fuzz_byte( &in ) % 6 ) ) );
+	FUZZ_ELEM_RUN( fz_dyn, &in, &rb, FUZZ_PLAIN_OPS );
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** SPSC overwriting pushes. @{ */
+
+ringbuffer_spsc_type_def( fz_ovw, uint32_t, 8 );
+ringbuffer_spsc_define_all( fz_ovw )
+ringbuffer_spsc_push_overwrite_def( fz_ovw )
+ringbuffer_spsc_push_n_overwrite_def( fz_ovw )
+ringbuffer_pop_overwrite_def( fz_ovw )
+
+/** Model: element `i` holds value `i`; pushes never look at `out`; the consumer
+ * resumes at most `capacity - 1` elements behind `in`, and counts the rest as lost.
+ */
+static void	fuzz_overwrite ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "overwrite", data, data, data + size };
+	const uint32_t	keep = 8 - 1;
+	uint32_t	buf[ FUZZ_LEN_MAX ], x, pos_in = 0, pos_out = 0, used, expect;
+	size_t		len, i, lost, got;
+	fz_ovw		rb;
+
+	fz_ovw_init( &rb, NULL );
+	while ( in.p < in.end )
+	{
+		switch ( fuzz_byte( &in ) % 3 )
+		{
+		case 0:
+			x	= pos_in;
+			FUZZ_CHECK( &in, fz_ovw_push_overwrite( &rb, &x ) == ( pos_in - pos_out >= keep ) );
+			pos_in++;
+			break;
+		case 1:
+			len	= fuzz_byte( &in ) % ( 2 * keep + 4 );
+			for ( i = 0; i < len; ++i ) buf[ i ] = pos_in + i;
+			used	= pos_in - pos_out < keep ? pos_in - pos_out : keep;
+			lost	= len > keep ? len - keep : 0;
+			lost	+= used + len - lost > keep ? used + len - lost - keep : 0;
+			FUZZ_CHECK( &in, fz_ovw_push_n_overwrite( &rb, buf, len ) == lost );
+			pos_in	+= len;
+			break;
+		default:
+			got	= ~( size_t )0;
+			if ( pos_in == pos_out )
+			{
+				FUZZ_CHECK( &in, !fz_ovw_pop_overwrite( &rb, &x, &got ) );
+				FUZZ_CHECK( &in, 0 == got );
+				break;
+			}
+			expect	= pos_in - pos_out > keep ? pos_in - keep : pos_out;
+			FUZZ_CHECK( &in, fz_ovw_pop_overwrite( &rb, &x, &got ) );
+			FUZZ_CHECK( &in, x == expect );
+			FUZZ_CHECK( &in, got == expect - pos_out );
+			pos_out	= expect + 1;
+			break;
+		}
+		FUZZ_CHECK( &in, fz_ovw_count( &rb ) == pos_in - pos_out );
+	}
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Strings. @{ */
+
+ringbuffer_type_def_ex( fz_str, char, 16, RINGBUF_PACKED, uint8_t );
+ringbuffer_define_all( fz_str )
+ringbuffer_push_string_def( fz_str )
+ringbuffer_pop_string_def( fz_str )
+ringbuffer_pop_cstring_def( fz_str )
+ringbuffer_pop_until_def( fz_str )
+
+/// String contents: a small alphabet, so delimiters and nulls show up often.
+static inline char	fuzz_char ( struct fuzz_in *in )
+{
+	return "ab\n"[ fuzz_byte( in ) % 4 ];
+}
+
+static void	fuzz_string ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "string", data, data, data + size };
+	char		buf[ 48 ], delim;
+	size_t		len, n, i, pos;
+	struct model	m;
+	fz_str		rb;
+
+	fz_str_init( &rb, NULL );
+	model_init( &m, RINGBUF_CAPACITY( &rb ) );
+	while ( in.p < in.end )
+	{
+		unsigned	op = fuzz_byte( &in ) % 4;
+
+		len	= fuzz_byte( &in ) % 40;
+		memset( buf, 0x5a, sizeof( buf ) );
+		switch ( op )
+		{
+		case 0:
+			for ( i = 0; i < len; ++i ) buf[ i ] = fuzz_char( &in );
+			n	= fz_str_push_string( &rb, buf, len );
+			FUZZ_CHECK( &in, n == min_sz( len, m.cap - m.n ) );
+			for ( i = 0; i < n; ++i ) model_push( &m, ( unsigned char )buf[ i ] );
+			break;
+		case 1:
+			n	= fz_str_pop_string( &rb, buf, len );
+			FUZZ_CHECK( &in, n == min_sz( len, m.n ) );
+			for ( i = 0; i < n; ++i ) FUZZ_CHECK( &in, ( unsigned char )buf[ i ] == model_pop( &m ) );
+			break;
+		case 2:
+			len++;	// `limit` 0 is not valid here.
+			n	= fz_str_pop_cstring( &rb, buf, len );
+			FUZZ_CHECK( &in, n == ( m.n ? min_sz( len - 1, m.n ) : 0 ) );
+			FUZZ_CHECK( &in, !m.n || !buf[ n ] );
+			for ( i = 0; i < n; ++i ) FUZZ_CHECK( &in, ( unsigned char )buf[ i ] == model_pop( &m ) );
+			break;
+		default:
+			delim	= fuzz_char( &in );
+			n	= fz_str_pop_until( &rb, buf, len, delim );
+			pos	= len ? min_sz( len - 1, m.n ) : 0;
+			for ( i = 0; i < pos; ++i )
+				if ( model_at( &m, i ) == ( unsigned char )delim )
+				{ pos = i + 1; break; }
+			FUZZ_CHECK( &in, n == pos );
+			FUZZ_CHECK( &in, !len || !buf[ n ] );
+			for ( i = 0; i < n; ++i ) FUZZ_CHECK( &in, ( unsigned char )buf[ i ] == model_pop( &m ) );
+			break;
+		}
+		FUZZ_CHECK( &in, fz_str_count( &rb ) == m.n );
+	}
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Records. @{ */
+
+ringbuffer_type_def_ex( fz_rec, uint8_t, 64, RINGBUF_PACKED, uint8_t );
+ringbuffer_define_all( fz_rec )
+ringbuffer_record_define_all( fz_rec )
+
+/** Model: byte positions, and the queued records with their end positions.
+ *
+ * Placement as documented: a record of RINGBUF_RECORD_SIZE( len ) bytes starts
+ * at `in`, or at the next wrap point if it does not fit before it.
+ */
+static void	fuzz_record ( const uint8_t *data, size_t size )
+{
+	struct fuzz_in	in = { "record", data, data, data + size };
+	const size_t	cap = 64;
+	struct { uint32_t len, end; uint8_t tag; }	q[ 16 ];
+	size_t		qh = 0, qn = 0, len, need, pad, i;
+	uint32_t	pos_in = 0, pos_out = 0;
+	uint8_t		buf[ 80 ], tag = 0, *p;
+	bool		ok;
+	fz_rec		rb;
+
+	fz_rec_init( &rb, NULL );
+	while ( in.p < in.end )
+	{
+		switch ( fuzz_byte( &in ) % 3 )
+		{
+		case 0:
+			len	= fuzz_byte( &in ) % 72;
+			for ( i = 0; i < len; ++i ) buf[ i ] = ( uint8_t )( tag + i );
+			need	= RINGBUF_RECORD_SIZE( len );
+			pad	= cap - pos_in % cap < need ? cap - pos_in % cap : 0;
+			ok	= len <= cap - RINGBUF_RECORD_ALIGN && need + pad <= cap - ( pos_in - pos_out );
+			FUZZ_CHECK( &in, fz_rec_push_record( &rb, buf, ( uint32_t )len ) == ok );
+			if ( !ok )
+				break;
+			pos_in	+= pad + need;
+			q[ ( qh + qn ) % 16 ].len	= ( uint32_t )len;
+			q[ ( qh + qn ) % 16 ].end	= pos_in;
+			q[ ( qh + qn++ ) % 16 ].tag	= tag++;
+			break;
+		case 1:
+			ok	= fz_rec_peek_record( &rb, &p, &len );
+			FUZZ_CHECK( &in, ok == !!qn );
+			if ( !ok )
+				break;
+			FUZZ_CHECK( &in, len == q[ qh ].len );
+			for ( i = 0; i < len; ++i ) FUZZ_CHECK( &in, p[ i ] == ( uint8_t )( q[ qh ].tag + i ) );
+			break;
+		default:
+			if ( !qn )	// Not valid on an empty ring.
+				break;
+			fz_rec_pop_record( &rb );
+			pos_out	= q[ qh ].end;
+			qh	= ( qh + 1 ) % 16;
+			qn--;
+			break;
+		}
+		FUZZ_CHECK( &in, fz_rec_count( &rb ) == pos_in - pos_out );
+	}
+}
+
+/** @} */
+
+
+// --------------------------------------
+
+int	LLVMFuzzerTestOneInput ( const uint8_t *data, size_t size );
+
+int	LLVMFuzzerTestOneInput ( const uint8_t *data, size_t size )
+{
+	fuzz_plain( data, size );
+	fuzz_spsc( data, size );
+	fuzz_dyn( data, size );
+	fuzz_overwrite( data, size );
+	fuzz_string( data, size );
+	fuzz_record( data, size );
+
+	return 0;
+}
+
+
+#ifndef	RINGBUF_LIBFUZZER
+
+static void	fuzz_run ( const uint8_t *data, size_t size )
+{
+	fuzz_data_	= data;
+	fuzz_size_	= size;
+	LLVMFuzzerTestOneInput( data, size );
+}
+
+static int	fuzz_file ( const char *path )
+{
+	static uint8_t	data[ 1 << 20 ];
+	FILE		*f = fopen( path, "rb" );
+	size_t		size;
+
+	if ( !f )
+	{
+		perror( path );
+		return 1;
+	}
+	size	= fread( data, 1, sizeof( data ), f );
+	fclose( f );
+	fuzz_run( data, size );
+
+	return 0;
+}
+
+int	main ( int argc, char **argv )
+{
+	uint64_t	runs = 10000, seed = 1, r;
+	size_t		max_len = 512, len, i;
+	uint8_t		*data;
+	int		a, files = 0, err = 0;
+
+	for ( a = 1; a < argc; ++a )
+	{
+		if ( !strncmp( argv[ a ], "-runs=", 6 ) )
+			runs	= strtoull( argv[ a ] + 6, NULL, 0 );
+		else if ( !strncmp( argv[ a ], "-seed=", 6 ) )
+			seed	= strtoull( argv[ a ] + 6, NULL, 0 );
+		else if ( !strncmp( argv[ a ], "-max_len=", 9 ) )
+			max_len	= strtoull( argv[ a ] + 9, NULL, 0 );
+		else if ( '-' == argv[ a ][ 0 ] )
+			;	// Other libFuzzer options: ignored.
+		else
+		{
+			err	|= fuzz_file( argv[ a ] );
+			files++;
+		}
+	}
+	if ( files )
+		return err;
+
+	if ( !seed )
+		seed	= 1;
+	if ( !( data = malloc( max_len + 1 ) ) )
+		return 1;
+	for ( r = 0; r < runs; ++r )
+	{
+		len	= test_rand( &seed ) % ( max_len + 1 );
+		for ( i = 0; i < len; ++i )
+			data[ i ] = ( uint8_t )( test_rand( &seed ) >> 32 );
+		fuzz_run( data, len );
+	}
+	free( data );
+	printf( "%" PRIu64 " inputs, up to %zu bytes: ok\n", runs, max_len );
+
+	return 0;
+}
+
+#endif	// RINGBUF_LIBFUZZER
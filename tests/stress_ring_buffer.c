@@ -0,0 +1,889 @@
+/** stress_ring_buffer: concurrent runs of every thread-safe family, with exact delivery checks.
+ *
+ * - spsc/elem:	`_push_front` against `_peek`/`_pop_back`;
+ * - spsc/bulk:	`_push_n` and `_reserve`/`_commit` against `_pop_n` and
+ *		`_peek_span`/`_consume`, in random burst sizes and mixed with the
+ *		single-element calls (so the cached remote indices must stay coherent);
+ *		every item must arrive once and in order;
+ * - spsc/overwrite:	`_push_overwrite` against `_pop_overwrite`: values must
+ *		increase and `lost` must account for every gap exactly. Not run under
+ *		ThreadSanitizer: `_pop_overwrite` validates its copy after the fact,
+ *		a race that TSan reports by design;
+ * - spsc/overwrite_n:	the same with `_push_n_overwrite` bursts (up to over the
+ *		capacity) of cache-line sized elements, each word holding the item
+ *		number: a torn copy that `_pop_overwrite` lets through shows up as
+ *		mixed words;
+ * - mpmc:	2 producers and 2 consumers: every item delivered exactly once,
+ *		and in order per producer as seen by each consumer;
+ * - wait/elem:	`_push_wait` against `_pop_wait`, both forever, with the
+ *		default wakeup on every transition: in order, nobody left asleep;
+ * - wait/batch:	`_push_wait` with short timeouts (retried) against
+ *		`_pop_batch_wait` with a deadline, on tuned watermarks and spinning;
+ * - group:	3 producers on shards 0-2 of a 4-shard group, 2 consumers with 2
+ *		home shards each draining, and stealing when idle: every item
+ *		delivered exactly once, consecutive per shard within each batch,
+ *		in order per shard as seen by each consumer;
+ * - deferred:	`_push_deferred`/`_push_n_deferred` against `_pop_deferred`/
+ *		`_pop_n_deferred`, publishing periodically (`every`), at random,
+ *		and before waiting: in order, and the ring left empty.
+ *
+ * Rings are small (SPSC ones with `uint8_t` indices), so full, empty and index
+ * wrap-around are hit all the time. Threads pause at random (short spins or
+ * yields), so each seed explores other interleavings.
+ *
+ * \code
+	stress_ring_buffer [--items=N] [--seed=S] [FILTER]
+ * \endcode
+ * Configure with `-DRINGBUF_TSAN=ON` to build it with ThreadSanitizer.
+ */
+
+#define	_GNU_SOURCE	// pthread_barrier_t.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_overwrite.h"
+#include "ring_buffer_mpmc.h"
+#include "ring_buffer_wait.h"
+#include "ring_buffer_group.h"
+#include "ring_buffer_deferred.h"
+
+#include "test.h"
+
+#if defined( __SANITIZE_THREAD__ )
+#	define	STRESS_TSAN	1
+#elif defined( __has_feature )
+#	if __has_feature( thread_sanitizer )
+#		define	STRESS_TSAN	1
+#	endif
+#endif
+
+
+static uint64_t	stress_items	= 1u << 17;
+static uint64_t	stress_seed	= 1;
+
+
+// --------------------------------------
+/** Threads. @{ */
+
+struct stress_thread
+{
+	pthread_t	tid;
+	void		*rb;
+	unsigned	id;
+	uint64_t	rng;
+	uint64_t	errors;		///< Checks failed.
+	uint64_t	first_bad;	///< Item of the first failure.
+	uint64_t	got;		///< Items received (consumers).
+};
+
+static pthread_barrier_t	stress_start;
+
+/// Random pause between operations: mostly none, sometimes a short spin or a yield.
+static inline void	stress_pause ( struct stress_thread *t )
+{
+	uint64_t	r = test_rand( &t->rng );
+	unsigned	i;
+
+	if ( r & 0x30 )
+		return;
+	if ( r & 0x40 )
+		sched_yield();
+	else
+		for ( i = ( r >> 8 ) & 63; i; --i )
+			__asm__ __volatile__( "" ::: "memory" );
+}
+
+/// A put/get failed (full/empty): let the other side run.
+static inline void	stress_wait ( void )
+{
+	sched_yield();
+}
+
+static inline void	stress_fail ( struct stress_thread *t, uint64_t item )
+{
+	if ( !t->errors++ )
+		t->first_bad	= item;
+}
+
+/// Run `n` threads of `fn` over `rb`, and wait for them.
+static void	stress_run ( struct stress_thread *t, unsigned n, void *( *const *fn )( void * ), void *rb )
+{
+	unsigned	i;
+
+	pthread_barrier_init( &stress_start, NULL, n );
+	for ( i = 0; i < n; ++i )
+	{
+		t[ i ]	= ( struct stress_thread ){ .rb = rb, .id = i, .rng = stress_seed * 0x9e3779b97f4a7c15ull + i + 1 };
+		pthread_create( &t[ i ].tid, NULL, fn[ i ], &t[ i ] );
+	}
+	for ( i = 0; i < n; ++i )
+		pthread_join( t[ i ].tid, NULL );
+	pthread_barrier_destroy( &stress_start );
+}
+
+/// Check a thread's error count, reporting its first failure.
+#define	STRESS_CHECK_THREAD( t )	do {	\
+	if ( ( t )->errors )	\
+		fprintf( stderr, "%s: thread %u: %" PRIu64 " error(s), first at item %" PRIu64 "\n",	\
+			test_case_, ( t )->id, ( t )->errors, ( t )->first_bad );	\
+	TEST_CHECK_EQ( ( t )->errors, 0 ); } while ( 0 )
+
+/** @} */
+
+
+// --------------------------------------
+/** SPSC. @{ */
+
+ringbuffer_spsc_type_def_ex( st_spsc, uint32_t, 16, uint8_t );
+ringbuffer_spsc_define_all( st_spsc )
+ringbuffer_spsc_bulk_define_all( st_spsc )
+
+/// Burst sizes: up to a bit over the capacity.
+#define	STRESS_BURST_MAX	20
+
+static void	*spsc_elem_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	st_spsc		*rb = t->rb;
+	uint32_t	v;
+
+	pthread_barrier_wait( &stress_start );
+	for ( v = 0; v < stress_items; ++v )
+	{
+		while ( !st_spsc_push_front( rb, &v ) )
+			stress_wait();
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	*spsc_elem_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	st_spsc		*rb = t->rb;
+	uint32_t	*p;
+
+	pthread_barrier_wait( &stress_start );
+	while ( t->got < stress_items )
+	{
+		if ( !( p = st_spsc_peek( rb, 0 ) ) )
+		{
+			stress_wait();
+			continue;
+		}
+		if ( *p != t->got )
+			stress_fail( t, t->got );
+		if ( !st_spsc_pop_back( rb ) )
+			stress_fail( t, t->got );
+		t->got++;
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	*spsc_bulk_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	st_spsc		*rb = t->rb;
+	uint32_t	buf[ STRESS_BURST_MAX ], next = 0, *p1, *p2;
+	size_t		want, n, l1, l2, i;
+
+	pthread_barrier_wait( &stress_start );
+	while ( next < stress_items )
+	{
+		uint64_t	r = test_rand( &t->rng );
+
+		want	= 1 + ( r >> 8 ) % STRESS_BURST_MAX;
+		if ( want > stress_items - next )
+			want	= stress_items - next;
+		switch ( r % 3 )
+		{
+		case 0:
+			n	= st_spsc_push_front( rb, &next );
+			break;
+		case 1:
+			for ( i = 0; i < want; ++i )
+				buf[ i ] = next + i;
+			n	= st_spsc_push_n( rb, buf, want );
+			break;
+		default:
+			n	= st_spsc_reserve( rb, want, &p1, &l1, &p2, &l2 );
+			n	= ( r >> 16 ) % ( n + 1 );	// Commit part of it.
+			for ( i = 0; i < n; ++i )
+				*( i < l1 ? &p1[ i ] : &p2[ i - l1 ] ) = next + i;
+			st_spsc_commit( rb, n );
+			break;
+		}
+		next	+= n;
+		if ( !n )
+			stress_wait();
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	*spsc_bulk_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	st_spsc		*rb = t->rb;
+	uint32_t	buf[ STRESS_BURST_MAX ], *p1, *p2, *p;
+	size_t		want, n, l1, l2, i;
+
+	pthread_barrier_wait( &stress_start );
+	while ( t->got < stress_items )
+	{
+		uint64_t	r = test_rand( &t->rng );
+
+		want	= 1 + ( r >> 8 ) % STRESS_BURST_MAX;
+		switch ( r % 3 )
+		{
+		case 0:
+			if ( ( n = !!( p = st_spsc_peek( rb, 0 ) ) ) )
+			{
+				if ( *p != t->got )
+					stress_fail( t, t->got );
+				st_spsc_pop_back( rb );
+			}
+			break;
+		case 1:
+			n	= st_spsc_pop_n( rb, buf, want );
+			for ( i = 0; i < n; ++i )
+				if ( buf[ i ] != t->got + i )
+					stress_fail( t, t->got + i );
+			break;
+		default:
+			n	= st_spsc_peek_span( rb, want, &p1, &l1, &p2, &l2 );
+			n	= ( r >> 16 ) % ( n + 1 );	// Consume part of it.
+			for ( i = 0; i < n; ++i )
+				if ( *( i < l1 ? &p1[ i ] : &p2[ i - l1 ] ) != t->got + i )
+					stress_fail( t, t->got + i );
+			st_spsc_consume( rb, n );
+			break;
+		}
+		t->got	+= n;
+		if ( !n )
+			stress_wait();
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	stress_spsc ( void *( *producer )( void * ), void *( *consumer )( void * ) )
+{
+	void	*( *const fn[] )( void * ) = { producer, consumer };
+	struct stress_thread	t[ 2 ];
+	st_spsc	rb;
+
+	st_spsc_init( &rb, NULL );
+	stress_run( t, 2, fn, &rb );
+
+	STRESS_CHECK_THREAD( &t[ 1 ] );
+	TEST_CHECK_EQ( t[ 1 ].got, stress_items );
+	TEST_CHECK( st_spsc_empty( &rb ) );
+}
+
+// --------------------------------------
+#ifndef	STRESS_TSAN
+
+ringbuffer_spsc_type_def( st_ovw, uint32_t, 8 );
+ringbuffer_spsc_define_all( st_ovw )
+ringbuffer_spsc_push_overwrite_def( st_ovw )
+ringbuffer_pop_overwrite_def( st_ovw )
+
+static unsigned	st_ovw_done;
+
+static void	*spsc_overwrite_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	v;
+
+	pthread_barrier_wait( &stress_start );
+	for ( v = 0; v < stress_items; ++v )
+	{
+		st_ovw_push_overwrite( t->rb, &v );
+		stress_pause( t );
+	}
+	__atomic_store_n( &st_ovw_done, 1, __ATOMIC_RELEASE );
+	return NULL;
+}
+
+/// `got` counts items received plus items reported lost: all of them in the end.
+static void	*spsc_overwrite_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	v;
+	size_t		lost;
+	bool		done;
+
+	pthread_barrier_wait( &stress_start );
+	for ( ;; )
+	{
+		done	= __atomic_load_n( &st_ovw_done, __ATOMIC_ACQUIRE );
+		if ( !st_ovw_pop_overwrite( t->rb, &v, &lost ) )
+		{
+			t->got	+= lost;	// Lapped, then found the slots it skipped to rewritten too.
+			if ( done )
+				break;	// Nothing left after the last push.
+			stress_wait();
+			continue;
+		}
+		if ( v != t->got + lost )
+			stress_fail( t, t->got );
+		t->got	= ( uint64_t )v + 1;
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+/// Wide elements: a copy torn by a concurrent rewrite mixes the words of two items.
+typedef struct { uint64_t w[ 8 ]; }	stress_wide;
+
+ringbuffer_spsc_type_def( st_ovw_n, stress_wide, 64 );
+ringbuffer_spsc_define_all( st_ovw_n )
+ringbuffer_spsc_push_n_overwrite_def( st_ovw_n )
+ringbuffer_pop_overwrite_def( st_ovw_n )
+
+/// Burst sizes: up to a bit over the capacity, so some sources are skipped.
+#define	STRESS_OVW_BURST_MAX	72
+
+static void	*spsc_overwrite_n_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	stress_wide	buf[ STRESS_OVW_BURST_MAX ];
+	uint64_t	v, n, i, w;
+
+	pthread_barrier_wait( &stress_start );
+	for ( v = 0; v < stress_items; v += n )
+	{
+		n	= 1 + test_rand( &t->rng ) % STRESS_OVW_BURST_MAX;
+		if ( n > stress_items - v )
+			n	= stress_items - v;
+		for ( i = 0; i < n; ++i )
+			for ( w = 0; w < ARRAY_COUNT( buf[ i ].w ); ++w )
+				buf[ i ].w[ w ]	= v + i;
+		st_ovw_n_push_n_overwrite( t->rb, buf, n );
+		stress_pause( t );
+	}
+	__atomic_store_n( &st_ovw_done, 1, __ATOMIC_RELEASE );
+	return NULL;
+}
+
+/// As `spsc_overwrite_consumer`, also checking that every word of an element agrees.
+static void	*spsc_overwrite_n_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	stress_wide	e;
+	size_t		lost, w;
+	bool		done;
+
+	pthread_barrier_wait( &stress_start );
+	for ( ;; )
+	{
+		done	= __atomic_load_n( &st_ovw_done, __ATOMIC_ACQUIRE );
+		if ( !st_ovw_n_pop_overwrite( t->rb, &e, &lost ) )
+		{
+			t->got	+= lost;
+			if ( done )
+				break;
+			stress_wait();
+			continue;
+		}
+		for ( w = 1; w < ARRAY_COUNT( e.w ); ++w )
+			if ( e.w[ w ] != e.w[ 0 ] )
+				break;
+		if ( w < ARRAY_COUNT( e.w ) || e.w[ 0 ] != t->got + lost )
+			stress_fail( t, t->got );
+		t->got	= e.w[ 0 ] + 1;
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+/// Run an overwrite producer/consumer pair: every item must be received or reported lost.
+static void	stress_overwrite ( void *( *producer )( void * ), void *( *consumer )( void * ), void *rb )
+{
+	void	*( *const fn[] )( void * ) = { producer, consumer };
+	struct stress_thread	t[ 2 ];
+
+	st_ovw_done	= 0;
+	stress_run( t, 2, fn, rb );
+
+	STRESS_CHECK_THREAD( &t[ 1 ] );
+	TEST_CHECK_EQ( t[ 1 ].got, stress_items );
+}
+
+#endif	// STRESS_TSAN
+
+/** @} */
+
+
+// --------------------------------------
+/** MPMC. @{ */
+
+ringbuffer_mpmc_type_def( st_mpmc, uint64_t, 64 );
+ringbuffer_mpmc_define_all( st_mpmc )
+
+#define	STRESS_MPMC_PRODUCERS	2
+#define	STRESS_MPMC_CONSUMERS	2
+
+/// Items are `producer << 32 | sequence`; `seen` counts deliveries of each.
+static uint8_t	*st_mpmc_seen[ STRESS_MPMC_PRODUCERS ];
+static uint64_t	st_mpmc_popped;
+
+static void	*mpmc_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint64_t	v, i;
+
+	pthread_barrier_wait( &stress_start );
+	for ( i = 0; i < stress_items; ++i )
+	{
+		v	= ( uint64_t )t->id << 32 | i;
+		while ( !st_mpmc_push_front( t->rb, &v ) )
+			stress_wait();
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	*mpmc_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	const uint64_t	total = STRESS_MPMC_PRODUCERS * stress_items;
+	uint64_t	last[ STRESS_MPMC_PRODUCERS ], v, p, seq;
+
+	for ( p = 0; p < STRESS_MPMC_PRODUCERS; ++p )
+		last[ p ] = UINT64_MAX;
+
+	pthread_barrier_wait( &stress_start );
+	while ( __atomic_load_n( &st_mpmc_popped, __ATOMIC_RELAXED ) < total )
+	{
+		if ( !st_mpmc_pop_back( t->rb, &v ) )
+		{
+			stress_wait();
+			continue;
+		}
+		__atomic_add_fetch( &st_mpmc_popped, 1, __ATOMIC_RELAXED );
+		p	= v >> 32;
+		seq	= v & 0xffffffffu;
+		if ( p >= STRESS_MPMC_PRODUCERS || seq >= stress_items
+			|| ( last[ p ] != UINT64_MAX && seq <= last[ p ] ) )
+		{
+			stress_fail( t, v );
+			continue;
+		}
+		last[ p ]	= seq;
+		__atomic_add_fetch( &st_mpmc_seen[ p ][ seq ], 1, __ATOMIC_RELAXED );
+		t->got++;
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	stress_mpmc ( void )
+{
+	void	*( *const fn[] )( void * ) = { mpmc_producer, mpmc_producer, mpmc_consumer, mpmc_consumer };
+	struct stress_thread	t[ STRESS_MPMC_PRODUCERS + STRESS_MPMC_CONSUMERS ];
+	uint64_t	got = 0, bad = 0, i;
+	unsigned	p;
+	st_mpmc		rb;
+
+	for ( p = 0; p < STRESS_MPMC_PRODUCERS; ++p )
+		st_mpmc_seen[ p ]	= calloc( stress_items, 1 );
+	st_mpmc_popped	= 0;
+	st_mpmc_init( &rb );
+	stress_run( t, 4, fn, &rb );	// Producers get ids 0 and 1.
+
+	for ( p = STRESS_MPMC_PRODUCERS; p < 4; ++p )
+	{
+		STRESS_CHECK_THREAD( &t[ p ] );
+		got	+= t[ p ].got;
+	}
+	for ( p = 0; p < STRESS_MPMC_PRODUCERS; ++p )
+	{
+		for ( i = 0; i < stress_items; ++i )
+			bad	+= 1 != st_mpmc_seen[ p ][ i ];
+		free( st_mpmc_seen[ p ] );
+	}
+	TEST_CHECK_EQ( got, STRESS_MPMC_PRODUCERS * stress_items );
+	TEST_CHECK_EQ( bad, 0 );
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Blocking wrappers. @{ */
+
+ringbuffer_spsc_type_def_ex( st_wait_ring, uint32_t, 16, uint8_t );
+ringbuffer_spsc_define_all( st_wait_ring )
+ringbuffer_wait_declare_all( st_wait, st_wait_ring );
+ringbuffer_wait_define_all( st_wait, st_wait_ring )
+
+static void	*wait_elem_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	v;
+
+	pthread_barrier_wait( &stress_start );
+	for ( v = 0; v < stress_items; ++v )
+	{
+		if ( st_wait_push_wait( t->rb, &v, -1 ) )
+			stress_fail( t, v );
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	*wait_elem_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	v;
+
+	pthread_barrier_wait( &stress_start );
+	for ( ; t->got < stress_items; t->got++ )
+	{
+		if ( st_wait_pop_wait( t->rb, &v, -1 ) || v != t->got )
+			stress_fail( t, t->got );
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+/// Timeouts only delay: -ETIMEDOUT is retried, anything else is an error.
+static void	*wait_batch_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	v;
+	int	err;
+
+	pthread_barrier_wait( &stress_start );
+	for ( v = 0; v < stress_items; )
+	{
+		if ( !( err = st_wait_push_wait( t->rb, &v, test_rand( &t->rng ) & 1 ) ) )
+			++v;
+		else if ( err != -ETIMEDOUT )
+			stress_fail( t, v );
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+/// The 1 ms deadline also drains the tail, below the high watermark.
+static void	*wait_batch_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	buf[ STRESS_BURST_MAX ];
+	long	n, i;
+
+	pthread_barrier_wait( &stress_start );
+	while ( t->got < stress_items )
+	{
+		n	= st_wait_pop_batch_wait( t->rb, buf, 1 + test_rand( &t->rng ) % STRESS_BURST_MAX, 1 );
+		if ( n < 0 )
+			stress_fail( t, t->got );
+		for ( i = 0; i < n; ++i )
+			if ( buf[ i ] != t->got + i )
+				stress_fail( t, t->got + i );
+		t->got	+= n > 0 ? n : 0;
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	stress_wait_run ( void *( *producer )( void * ), void *( *consumer )( void * ), bool tuned )
+{
+	void	*( *const fn[] )( void * ) = { producer, consumer };
+	struct stress_thread	t[ 2 ];
+	st_wait	w;
+
+	st_wait_init( &w, NULL );
+	if ( tuned )
+		ring_buffer_wait_tune( &w.wait, 4, 8, 50, 2 );
+	stress_run( t, 2, fn, &w );
+
+	STRESS_CHECK_THREAD( &t[ 0 ] );
+	STRESS_CHECK_THREAD( &t[ 1 ] );
+	TEST_CHECK_EQ( t[ 1 ].got, stress_items );
+	TEST_CHECK( st_wait_ring_empty( &w.ring ) );
+	TEST_CHECK_EQ( w.wait.not_full.waiters, 0 );
+	TEST_CHECK_EQ( w.wait.not_empty.waiters, 0 );
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Ring group. @{ */
+
+ringbuffer_spsc_type_def_ex( st_grp_ring, uint64_t, 16, uint8_t );
+ringbuffer_spsc_define_all( st_grp_ring )
+ringbuffer_spsc_bulk_define_all( st_grp_ring )
+
+#define	STRESS_GROUP_SHARDS	4
+#define	STRESS_GROUP_PRODUCERS	3	///< Shards 0 .. 2; shard 3 stays empty.
+
+ringbuffer_group_declare_all( st_grp, st_grp_ring, STRESS_GROUP_SHARDS );
+ringbuffer_group_define_all( st_grp, st_grp_ring )
+
+/** Items are `shard << 32 | sequence`, `stress_items` per producer; as for MPMC, except that
+ * `popped` only counts first deliveries, so consumers keep draining after a duplicate.
+ */
+static uint8_t	*st_grp_seen[ STRESS_GROUP_PRODUCERS ];
+static uint64_t	st_grp_popped, st_grp_stolen;
+
+static void	*group_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	st_grp_ring	*rb = RINGBUF_GROUP_SHARD( ( st_grp * )t->rb, t->id );
+	uint64_t	v, i;
+
+	pthread_barrier_wait( &stress_start );
+	for ( i = 0; i < stress_items; ++i )
+	{
+		v	= ( uint64_t )t->id << 32 | i;
+		while ( !st_grp_ring_push_front( rb, &v ) )
+			stress_wait();
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+/// Consumer `id - STRESS_GROUP_PRODUCERS` of 2, with shards 0-1 or 2-3 as home.
+static void	*group_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	const uint64_t	total = STRESS_GROUP_PRODUCERS * stress_items;
+	struct ring_buffer_group_cursor	c;
+	uint64_t	buf[ STRESS_BURST_MAX ], last[ STRESS_GROUP_SHARDS ], prev[ STRESS_GROUP_SHARDS ], p, seq;
+	size_t	n, i;
+	bool	stolen;
+
+	ring_buffer_group_cursor_init( &c, 2 * ( t->id - STRESS_GROUP_PRODUCERS ), 2, 1 + t->rng % 8 );
+	for ( p = 0; p < STRESS_GROUP_SHARDS; ++p )
+		last[ p ] = UINT64_MAX;
+
+	pthread_barrier_wait( &stress_start );
+	while ( __atomic_load_n( &st_grp_popped, __ATOMIC_RELAXED ) < total )
+	{
+		n	= st_grp_drain( t->rb, &c, buf, 1 + test_rand( &t->rng ) % STRESS_BURST_MAX );
+		if ( ( stolen = !n ) )
+			n	= st_grp_steal( t->rb, &c, buf, 1 + test_rand( &t->rng ) % STRESS_BURST_MAX );
+		if ( !n )
+		{
+			stress_wait();
+			continue;
+		}
+		if ( stolen )
+			__atomic_add_fetch( &st_grp_stolen, n, __ATOMIC_RELAXED );
+
+		for ( p = 0; p < STRESS_GROUP_SHARDS; ++p )
+			prev[ p ] = UINT64_MAX;
+		for ( i = 0; i < n; ++i )
+		{
+			p	= buf[ i ] >> 32;
+			seq	= buf[ i ] & 0xffffffffu;
+			if ( p >= STRESS_GROUP_PRODUCERS || seq >= stress_items
+				|| ( prev[ p ] != UINT64_MAX && seq != prev[ p ] + 1 )	// Within the batch.
+				|| ( last[ p ] != UINT64_MAX && seq <= last[ p ] ) )	// Across batches.
+			{
+				stress_fail( t, buf[ i ] );
+				continue;
+			}
+			prev[ p ] = last[ p ]	= seq;
+			if ( __atomic_fetch_add( &st_grp_seen[ p ][ seq ], 1, __ATOMIC_RELAXED ) )
+				stress_fail( t, buf[ i ] );	// Not counted: the producers still need room.
+			else
+				__atomic_add_fetch( &st_grp_popped, 1, __ATOMIC_RELAXED );
+			t->got++;
+		}
+		stress_pause( t );
+	}
+	return NULL;
+}
+
+static void	stress_group ( void )
+{
+	void	*( *const fn[] )( void * ) = { group_producer, group_producer, group_producer, group_consumer, group_consumer };
+	struct stress_thread	t[ STRESS_GROUP_PRODUCERS + 2 ];
+	uint64_t	got = 0, bad = 0, i;
+	unsigned	p;
+	st_grp		g;
+
+	for ( p = 0; p < STRESS_GROUP_PRODUCERS; ++p )
+		st_grp_seen[ p ]	= calloc( stress_items, 1 );
+	st_grp_popped = st_grp_stolen	= 0;
+	st_grp_init( &g );
+	stress_run( t, ARRAY_COUNT( t ), fn, &g );	// Producer `id` owns shard `id`.
+
+	for ( p = STRESS_GROUP_PRODUCERS; p < ARRAY_COUNT( t ); ++p )
+	{
+		STRESS_CHECK_THREAD( &t[ p ] );
+		got	+= t[ p ].got;
+	}
+	for ( p = 0; p < STRESS_GROUP_PRODUCERS; ++p )
+	{
+		for ( i = 0; i < stress_items; ++i )
+			bad	+= 1 != st_grp_seen[ p ][ i ];
+		free( st_grp_seen[ p ] );
+	}
+	printf( "%s: %" PRIu64 " item(s) stolen\n", test_case_, st_grp_stolen );
+	TEST_CHECK_EQ( got, STRESS_GROUP_PRODUCERS * stress_items );
+	TEST_CHECK_EQ( bad, 0 );
+	TEST_CHECK_EQ( st_grp_count( &g ), 0 );
+}
+
+/** @} */
+
+
+// --------------------------------------
+/** Deferred publication. @{ */
+
+ringbuffer_spsc_type_def_ex( st_def_ring, uint32_t, 16, uint8_t );
+ringbuffer_spsc_define_all( st_def_ring )
+ringbuffer_deferred_declare_all( st_def, st_def_ring );
+ringbuffer_deferred_define_all( st_def, st_def_ring )
+
+/// Publishes before waiting for space (the consumer may be waiting for these very elements).
+static void	*deferred_producer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	buf[ STRESS_BURST_MAX ], next = 0;
+	size_t		want, n, i;
+
+	pthread_barrier_wait( &stress_start );
+	while ( next < stress_items )
+	{
+		uint64_t	r = test_rand( &t->rng );
+
+		want	= 1 + ( r >> 8 ) % STRESS_BURST_MAX;
+		if ( want > stress_items - next )
+			want	= stress_items - next;
+		if ( r & 1 )
+			n	= st_def_push_deferred( t->rb, &next );
+		else
+		{
+			for ( i = 0; i < want; ++i )
+				buf[ i ] = next + i;
+			n	= st_def_push_n_deferred( t->rb, buf, want );
+		}
+		next	+= n;
+		if ( !n || !( r & 0x700 ) )
+			st_def_publish_input( t->rb );
+		if ( !n )
+			stress_wait();
+		stress_pause( t );
+	}
+	st_def_publish_input( t->rb );
+	return NULL;
+}
+
+static void	*deferred_consumer ( void *arg )
+{
+	struct stress_thread	*t = arg;
+	uint32_t	buf[ STRESS_BURST_MAX ];
+	size_t		n, i;
+
+	pthread_barrier_wait( &stress_start );
+	while ( t->got < stress_items )
+	{
+		uint64_t	r = test_rand( &t->rng );
+
+		if ( r & 1 )
+			n	= st_def_pop_deferred( t->rb, &buf[ 0 ] );
+		else
+			n	= st_def_pop_n_deferred( t->rb, buf, 1 + ( r >> 8 ) % STRESS_BURST_MAX );
+		for ( i = 0; i < n; ++i )
+			if ( buf[ i ] != t->got + i )
+				stress_fail( t, t->got + i );
+		t->got	+= n;
+		if ( !n || !( r & 0x700 ) )
+			st_def_publish_output( t->rb );
+		if ( !n )
+			stress_wait();
+		stress_pause( t );
+	}
+	st_def_publish_output( t->rb );
+	return NULL;
+}
+
+static void	stress_deferred ( void )
+{
+	void	*( *const fn[] )( void * ) = { deferred_producer, deferred_consumer };
+	struct stress_thread	t[ 2 ];
+	st_def	d;
+
+	st_def_init( &d, 5, 3 );
+	stress_run( t, 2, fn, &d );
+
+	STRESS_CHECK_THREAD( &t[ 1 ] );
+	TEST_CHECK_EQ( t[ 1 ].got, stress_items );
+	TEST_CHECK( st_def_ring_empty( &d.ring ) );
+	TEST_CHECK( !d.in.pending && !d.out.pending );
+}
+
+/** @} */
+
+
+int	main ( int argc, char **argv )
+{
+	int	a;
+
+	for ( a = 1; a < argc; ++a )
+	{
+		if ( !strncmp( argv[ a ], "--items=", 8 ) )
+			stress_items	= strtoull( argv[ a ] + 8, NULL, 0 );
+		else if ( !strncmp( argv[ a ], "--seed=", 7 ) )
+			stress_seed	= strtoull( argv[ a ] + 7, NULL, 0 );
+	}
+	if ( stress_items > UINT32_MAX )
+		stress_items	= UINT32_MAX;
+	test_init( argc, argv );
+	printf( "%" PRIu64 " items per run, seed %" PRIu64 "\n", stress_items, stress_seed );
+
+	TEST_CASE( "spsc/elem" )
+		stress_spsc( spsc_elem_producer, spsc_elem_consumer );
+
+	TEST_CASE( "spsc/bulk" )
+		stress_spsc( spsc_bulk_producer, spsc_bulk_consumer );
+
+#ifndef	STRESS_TSAN
+	TEST_CASE( "spsc/overwrite" )
+	{
+		st_ovw	rb;
+
+		st_ovw_init( &rb, NULL );
+		stress_overwrite( spsc_overwrite_producer, spsc_overwrite_consumer, &rb );
+	}
+
+	TEST_CASE( "spsc/overwrite_n" )
+	{
+		st_ovw_n	rb;
+
+		st_ovw_n_init( &rb, NULL );
+		stress_overwrite( spsc_overwrite_n_producer, spsc_overwrite_n_consumer, &rb );
+	}
+#endif
+
+	TEST_CASE( "mpmc" )
+		stress_mpmc();
+
+	TEST_CASE( "wait/elem" )
+		stress_wait_run( wait_elem_producer, wait_elem_consumer, false );
+
+	TEST_CASE( "wait/batch" )
+		stress_wait_run( wait_batch_producer, wait_batch_consumer, true );
+
+	TEST_CASE( "group" )
+		stress_group();
+
+	TEST_CASE( "deferred" )
+		stress_deferred();
+
+	return test_report();
+}
@@ -0,0 +1,111 @@
+#ifndef	RING_BUFFER_TEST_H
+#	define	RING_BUFFER_TEST_H
+
+/** Minimal test harness shared by the tests/ programs.
+ *
+ * - `TEST_CHECK( cond )` reports the failed condition (file, line, and the
+ *   current `TEST_CASE` name) and counts it, then carries on;
+ * - `TEST_CASE( name )` opens a named case: a block that only runs if selected
+ *   by the command line filter (a substring, see `test_init`);
+ * - `TEST_CHECK_STAT( a, b )` checks an instrumentation counter in `RINGBUF_STATS`
+ *   builds, and compiles to nothing (arguments included) otherwise;
+ * - `test_rand` is a small xorshift generator, so every run is reproducible
+ *   from its seed;
+ * - `test_report` prints the totals and returns the exit status (non-zero if any check failed);
+ *   a program returns `TEST_SKIPPED` instead when the system lacks what it tests.
+ *
+ * \code
+	int	main ( int argc, char **argv )
+	{
+		test_init( argc, argv );
+
+		TEST_CASE( "push_string/len0" )
+		{
+			TEST_CHECK( 0 == str_push_string( &rb, s, 0 ) );
+		}
+
+		return test_report();
+	}
+ * \endcode
+ */
+
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static const char	*test_filter_;
+static const char	*test_case_	= "";
+static unsigned		test_cases_, test_failed_;
+
+/// Take the first argument not starting with '-' (if any) as the case filter.
+static inline void	test_init ( int argc, char **argv )
+{
+	int	a;
+
+	for ( a = 1; a < argc && !test_filter_; ++a )
+		if ( '-' != argv[ a ][ 0 ] )
+			test_filter_	= argv[ a ];
+}
+
+/// Don't use. True (once) if case `name` is selected.
+static inline bool	test_begin_ ( const char *name )
+{
+	if ( test_filter_ && !strstr( name, test_filter_ ) )
+		return false;
+	test_case_	= name;
+	test_cases_++;
+	return true;
+}
+
+#define	TEST_CASE( name )	\
+	if ( test_begin_( name ) )
+
+#define	TEST_CHECK( cond )	do {	\
+	if ( !( cond ) )	{	\
+		fprintf( stderr, "%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, test_case_, #cond );	\
+		test_failed_++; } } while ( 0 )
+
+/// Check `a == b` (integers), printing both values on failure.
+#define	TEST_CHECK_EQ( a, b )	do {	\
+	uintmax_t	a_ = ( uintmax_t )( a ), b_ = ( uintmax_t )( b );	\
+	if ( a_ != b_ )	{	\
+		fprintf( stderr, "%s:%d: %s: check failed: %s == %s (%" PRIuMAX " != %" PRIuMAX ")\n",	\
+			__FILE__, __LINE__, test_case_, #a, #b, a_, b_ );	\
+		test_failed_++; } } while ( 0 )
+
+/// Check counter `a == b` (`RINGBUF_STATS` builds only: the counters may not even exist otherwise).
+#ifdef	RINGBUF_STATS
+#	define	TEST_CHECK_STAT( a, b )	TEST_CHECK_EQ( a, b )
+#else
+#	define	TEST_CHECK_STAT( a, b )	do { } while ( 0 )
+#endif
+
+/// Exit status for "not run here" (ctest SKIP_RETURN_CODE).
+#define	TEST_SKIPPED	77
+
+static inline int	test_report ( void )
+{
+	printf( "%u case(s), %u failure(s)\n", test_cases_, test_failed_ );
+
+	return test_failed_ ? 1 : 0;
+}
+
+/// xorshift64: never returns 0 for a non-zero state.
+static inline uint64_t	test_rand ( uint64_t *state )
+{
+	uint64_t	x = *state;
+
+	x	^= x << 13;
+	x	^= x >> 7;
+	x	^= x << 17;
+
+	return *state = x;
+}
+
+
+#endif	// RING_BUFFER_TEST_H
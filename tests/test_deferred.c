@@ -0,0 +1,129 @@
+/** test_deferred: deferred index publication (ring_buffer_deferred.h), single-threaded.
+ *
+ * Unpublished pushes stay invisible to the consumer and unpublished pops keep
+ * their space from the producer, until an explicit or periodic (`every`)
+ * publication; bulk forms across the wrap point, and the counters, which only
+ * move on publication. Publication across threads is stress_ring_buffer's
+ * deferred/ case.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_deferred.h"
+
+#include "test.h"
+
+
+ringbuffer_spsc_declare_all( tdef_ring, uint16_t, 8 );
+ringbuffer_spsc_define_all( tdef_ring )
+ringbuffer_deferred_declare_all( tdef, tdef_ring );
+ringbuffer_deferred_define_all( tdef, tdef_ring )
+
+ringbuffer_type_def( tdef_plain_ring, uint16_t, 8 );
+ringbuffer_define_all( tdef_plain_ring )
+ringbuffer_deferred_declare_all( tdef_plain, tdef_plain_ring );
+ringbuffer_deferred_define_all( tdef_plain, tdef_plain_ring )
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	uint16_t	v, src[ 16 ], dst[ 16 ];
+	size_t	i;
+	tdef_plain	p;
+	tdef	d;
+
+	test_init( argc, argv );
+
+	for ( i = 0; i < ARRAY_COUNT( src ); ++i )
+		src[ i ]	= ( uint16_t )( 100 + i );
+
+	TEST_CASE( "deferred/on-demand" )
+	{
+		tdef_init( &d, 0, 0 );
+		for ( v = 0; v < 3; ++v )
+			TEST_CHECK( tdef_push_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.input, 0 );
+		TEST_CHECK( !tdef_pop_deferred( &d, &v ) );	// Not published yet.
+
+		tdef_publish_input( &d );
+		TEST_CHECK_EQ( d.ring.input, 3 );
+		tdef_publish_input( &d );	// Nothing pending: no store.
+		for ( i = 0; i < 3; ++i )
+		{
+			TEST_CHECK( tdef_pop_deferred( &d, &v ) );
+			TEST_CHECK_EQ( v, i );
+		}
+		TEST_CHECK( !tdef_pop_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.output, 0 );
+
+		// Read but unreleased elements still take space.
+		for ( v = 3; v < 8; ++v )
+			TEST_CHECK( tdef_push_deferred( &d, &v ) );
+		TEST_CHECK( !tdef_push_deferred( &d, &v ) );
+		TEST_CHECK_EQ( tdef_push_n_deferred( &d, src, 4 ), 0 );
+		tdef_publish_output( &d );
+		TEST_CHECK_EQ( d.ring.output, 3 );
+		TEST_CHECK_EQ( tdef_push_n_deferred( &d, src, 4 ), 3 );
+		TEST_CHECK_EQ( d.in.pending, 8 );
+
+		tdef_publish_input( &d );
+		TEST_CHECK_EQ( tdef_pop_n_deferred( &d, dst, ARRAY_COUNT( dst ) ), 8 );
+		for ( i = 0; i < 5; ++i )
+			TEST_CHECK_EQ( dst[ i ], 3 + i );
+		TEST_CHECK( !memcmp( &dst[ 5 ], src, 3 * sizeof( *src ) ) );	// Wrapped.
+		tdef_publish_output( &d );
+		TEST_CHECK( tdef_ring_empty( &d.ring ) );
+
+		tdef_ring_stats_snapshot( &d.ring, &st );
+		TEST_CHECK_STAT( st.pushes, 11 );
+		TEST_CHECK_STAT( st.pops, 11 );
+		TEST_CHECK_STAT( st.rejected_pushes, 1 + 4 + 1 );
+		TEST_CHECK_STAT( st.empty_polls, 2 );
+		TEST_CHECK_STAT( st.high_water, 8 );
+	}
+
+	TEST_CASE( "deferred/every" )
+	{
+		tdef_init( &d, 4, 3 );
+		for ( v = 0; v < 3; ++v )
+			TEST_CHECK( tdef_push_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.input, 0 );
+		TEST_CHECK( tdef_push_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.input, 4 );	// Every 4th push.
+		TEST_CHECK_EQ( tdef_push_n_deferred( &d, src, 2 ), 2 );
+		TEST_CHECK_EQ( d.ring.input, 4 );
+		TEST_CHECK_EQ( tdef_push_n_deferred( &d, src + 2, 2 ), 2 );
+		TEST_CHECK_EQ( d.ring.input, 8 );	// A bulk push crossing `every` publishes all.
+
+		TEST_CHECK( tdef_pop_deferred( &d, &v ) && tdef_pop_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.output, 0 );
+		TEST_CHECK( tdef_pop_deferred( &d, &v ) );
+		TEST_CHECK_EQ( d.ring.output, 3 );
+		TEST_CHECK_EQ( tdef_pop_n_deferred( &d, dst, 5 ), 5 );
+		TEST_CHECK_EQ( d.ring.output, 8 );
+		TEST_CHECK( dst[ 0 ] == 3 && dst[ 1 ] == src[ 0 ] && dst[ 4 ] == src[ 3 ] );
+		TEST_CHECK_EQ( tdef_pop_n_deferred( &d, dst, 5 ), 0 );
+	}
+
+	TEST_CASE( "deferred/plain" )
+	{
+		tdef_plain_init( &p, 0, 2 );
+		TEST_CHECK( !p.in.cursor && !p.out.cursor );
+		// Wraps after 2 elements.
+		p.ring.input = p.ring.output = p.in.cursor = p.in.remote = p.out.cursor = p.out.remote	= 6;
+
+		TEST_CHECK_EQ( tdef_plain_push_n_deferred( &p, src, 10 ), 8 );
+		TEST_CHECK( tdef_plain_ring_empty( &p.ring ) );
+		tdef_plain_publish_input( &p );
+		TEST_CHECK( tdef_plain_ring_full( &p.ring ) );
+		TEST_CHECK_EQ( tdef_plain_pop_n_deferred( &p, dst, 3 ), 3 );
+		TEST_CHECK_EQ( p.ring.output, 6 + 3 );	// Every 2 popped: 3 crosses it.
+		TEST_CHECK_EQ( tdef_plain_pop_n_deferred( &p, dst + 3, 16 ), 5 );
+		TEST_CHECK( !memcmp( dst, src, 8 * sizeof( *src ) ) );
+		TEST_CHECK( tdef_plain_ring_empty( &p.ring ) );
+	}
+
+	return test_report();
+}
@@ -0,0 +1,147 @@
+/** test_group: sharded ring group (ring_buffer_group.h), single-threaded.
+ *
+ * Round-robin drains over the home shards (batch and `limit`), steals of half
+ * the fullest other shard, and shards whose consumer lock is held being passed
+ * over. Concurrent stealing consumers are stress_ring_buffer's group/ case.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_group.h"
+
+#include "test.h"
+
+
+ringbuffer_spsc_declare_all( tgrp_ring, uint32_t, 16 );
+ringbuffer_spsc_define_all( tgrp_ring )
+ringbuffer_spsc_bulk_define_all( tgrp_ring )
+
+ringbuffer_group_declare_all( tgrp, tgrp_ring, 4 );
+ringbuffer_group_define_all( tgrp, tgrp_ring )
+
+
+/// Element `seq` of shard `s`.
+#define	TGRP_ITEM( s, seq )	( ( uint32_t )( s ) << 16 | ( seq ) )
+
+/// Next sequence number per shard, for pushes and in-order checks.
+static uint32_t	tgrp_pushed[ 4 ], tgrp_popped[ 4 ];
+
+static void	tgrp_push ( tgrp *g, unsigned s, unsigned n )
+{
+	uint32_t	v;
+
+	while ( n-- )
+	{
+		v	= TGRP_ITEM( s, tgrp_pushed[ s ]++ );
+		TEST_CHECK( tgrp_ring_push_front( RINGBUF_GROUP_SHARD( g, s ), &v ) );
+	}
+}
+
+/// Check `n` popped elements: in order per shard, and all from shards in `from` (bit mask).
+static void	tgrp_check ( const uint32_t *v, size_t n, unsigned from )
+{
+	unsigned	s;
+
+	while ( n-- )
+	{
+		s	= *v >> 16;
+		TEST_CHECK( s < 4 && ( from & 1u << s ) );
+		if ( s < 4 )
+			TEST_CHECK_EQ( *v, TGRP_ITEM( s, tgrp_popped[ s ]++ ) );
+		v++;
+	}
+}
+
+static void	tgrp_reset ( tgrp *g )
+{
+	tgrp_init( g );
+	memset( tgrp_pushed, 0, sizeof( tgrp_pushed ) );
+	memset( tgrp_popped, 0, sizeof( tgrp_popped ) );
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_group_cursor	c;
+	uint32_t	out[ 64 ];
+	tgrp	g;
+
+	test_init( argc, argv );
+
+	TEST_CASE( "group/drain" )
+	{
+		tgrp_reset( &g );
+		ring_buffer_group_cursor_init( &c, 0, 2, 3 );	// Home: shards 0 and 1.
+		tgrp_push( &g, 0, 5 );
+		tgrp_push( &g, 1, 2 );
+		tgrp_push( &g, 2, 7 );
+		TEST_CHECK_EQ( tgrp_count( &g ), 14 );
+
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 3 + 2 );
+		TEST_CHECK( out[ 0 ] == TGRP_ITEM( 0, 0 ) && out[ 3 ] == TGRP_ITEM( 1, 0 ) );
+		tgrp_check( out, 5, 0x3 );
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, 1 ), 1 );	// `limit` first.
+		tgrp_check( out, 1, 0x1 );
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 1 );	// Resumes at shard 1 (empty).
+		tgrp_check( out, 1, 0x1 );
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 0 );
+		TEST_CHECK_EQ( tgrp_count( &g ), 7 );	// Shard 2 is nobody's home here.
+
+		// No batch limit (0).
+		ring_buffer_group_cursor_init( &c, 2, 2, 0 );
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 7 );
+		tgrp_check( out, 7, 0x4 );
+		TEST_CHECK_EQ( tgrp_count( &g ), 0 );
+	}
+
+	TEST_CASE( "group/steal" )
+	{
+		tgrp_reset( &g );
+		ring_buffer_group_cursor_init( &c, 0, 2, 4 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 0 );	// All empty.
+
+		tgrp_push( &g, 0, 10 );	// Home: never stolen from.
+		tgrp_push( &g, 2, 7 );
+		tgrp_push( &g, 3, 2 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 4 );	// Half of 7, rounded up.
+		tgrp_check( out, 4, 0x4 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 2 );	// Still shard 2 (3 > 2).
+		tgrp_check( out, 2, 0x4 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, 1 ), 1 );	// Shard 3 now, within `limit`.
+		tgrp_check( out, 1, 0x8 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 1 );	// 1 and 1: the first one.
+		tgrp_check( out, 1, 0x4 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 1 );
+		tgrp_check( out, 1, 0x8 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 0 );
+		TEST_CHECK_EQ( tgrp_count( &g ), 10 );
+	}
+
+	TEST_CASE( "group/busy" )
+	{
+		tgrp_reset( &g );
+		ring_buffer_group_cursor_init( &c, 0, 2, 0 );
+		tgrp_push( &g, 0, 3 );
+		tgrp_push( &g, 1, 3 );
+		tgrp_push( &g, 2, 3 );
+
+		// Another consumer holds shards 0 and 2: passed over, never waited for.
+		TEST_CHECK( ring_buffer_group_trylock( &g.shard[ 0 ].lock ) );
+		TEST_CHECK( ring_buffer_group_trylock( &g.shard[ 2 ].lock ) );
+		TEST_CHECK( !ring_buffer_group_trylock( &g.shard[ 0 ].lock ) );
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 3 );
+		tgrp_check( out, 3, 0x2 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 0 );
+		ring_buffer_group_unlock( &g.shard[ 0 ].lock );
+		ring_buffer_group_unlock( &g.shard[ 2 ].lock );
+
+		TEST_CHECK_EQ( tgrp_drain( &g, &c, out, ARRAY_COUNT( out ) ), 3 );
+		tgrp_check( out, 3, 0x1 );
+		TEST_CHECK_EQ( tgrp_steal( &g, &c, out, ARRAY_COUNT( out ) ), 2 );
+		tgrp_check( out, 2, 0x4 );
+		TEST_CHECK_EQ( tgrp_count( &g ), 1 );
+	}
+
+	return test_report();
+}
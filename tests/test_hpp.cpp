@@ -0,0 +1,159 @@
+/** test_hpp: C++17 front-end (ring_buffer.hpp).
+ *
+ * Each policy with a type counting its constructions and destructions (so
+ * every slot is constructed once and destroyed once, the destructor included),
+ * narrow indices wrapping many times, moves in and out, `peek`, overwrite of
+ * the oldest element, and MPMC producers and consumers on std::thread.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ring_buffer.hpp"
+
+#include "test.h"
+
+
+namespace
+{
+
+/// Counts live instances; moved-from instances keep `id` -1.
+struct tracked
+{
+	static inline int	live	= 0;
+	int	id	= -1;
+
+	tracked () noexcept				{ ++live; }
+	explicit tracked ( int i ) noexcept : id( i )	{ ++live; }
+	tracked ( const tracked &o ) noexcept : id( o.id )	{ ++live; }
+	tracked ( tracked &&o ) noexcept : id( o.id )	{ o.id = -1; ++live; }
+	tracked	&operator= ( const tracked & ) noexcept	= default;
+	tracked	&operator= ( tracked &&o ) noexcept	{ id = o.id; o.id = -1; return *this; }
+	~tracked ()					{ --live; }
+};
+
+static_assert( ringbuf::ring_buffer< int, 16 >::capacity() == 16 );
+static_assert( ringbuf::ring_buffer< int, 16, std::uint8_t >::wrap( 37 ) == 5 );
+
+template< class Policy >
+void	check_basic ()
+{
+	{
+		// uint8_t indices: 1000 elements wrap them almost four times.
+		ringbuf::ring_buffer< tracked, 8, std::uint8_t, Policy >	q;
+		tracked	t;
+		int	next	= 0;
+
+		TEST_CHECK( q.empty() && !q.full() );
+		for ( int i = 0; i < 1000; ++i )
+		{
+			TEST_CHECK( q.emplace( i ) );
+			if ( i % 3 != 2 && i != 999 )
+				continue;
+			while ( q.try_pop( t ) )
+				TEST_CHECK_EQ( t.id, next++ );
+		}
+		TEST_CHECK_EQ( next, 1000 );
+
+		for ( int i = 0; i < 8; ++i )
+			TEST_CHECK( q.try_push( tracked( i ) ) );
+		TEST_CHECK( q.full() );
+		TEST_CHECK_EQ( q.size(), 8 );
+		TEST_CHECK( q.pop() );
+		TEST_CHECK( q.try_pop( t ) && t.id == 1 );
+		TEST_CHECK_EQ( tracked::live, 1 + 6 );
+	}
+
+	TEST_CHECK_EQ( tracked::live, 0 );	// The destructor destroyed the 6 left.
+}
+
+}	// namespace
+
+
+int	main ( int argc, char **argv )
+{
+	test_init( argc, argv );
+
+	TEST_CASE( "hpp/spsc" )
+	{
+		ringbuf::ring_buffer< std::string, 4 >	q;
+		std::string	s( 100, 'x' );
+
+		check_basic< ringbuf::spsc >();
+
+		TEST_CHECK( q.emplace( 50, 'a' ) );
+		TEST_CHECK( q.try_push( s ) && s.size() == 100 );
+		TEST_CHECK( q.try_push( std::move( s ) ) );
+		TEST_CHECK( q.try_push( "last" ) );
+		TEST_CHECK( !q.try_push( "over" ) );
+		TEST_CHECK( q.peek( 0 ) && *q.peek( 0 ) == std::string( 50, 'a' ) );
+		TEST_CHECK( q.peek( 3 ) && *q.peek( 3 ) == "last" );
+		TEST_CHECK( !q.peek( 4 ) );
+		TEST_CHECK( q.pop() && q.try_pop( s ) && s == std::string( 100, 'x' ) );
+	}
+
+	TEST_CASE( "hpp/overwrite" )
+	{
+		check_basic< ringbuf::overwrite >();
+
+		{
+			ringbuf::ring_buffer< tracked, 4, std::uint16_t, ringbuf::overwrite >	q;
+
+			for ( int i = 0; i < 10; ++i )
+				TEST_CHECK( q.emplace( i ) );	// Never fails.
+			TEST_CHECK( q.full() );
+			TEST_CHECK_EQ( tracked::live, 4 );
+			for ( int i = 0; i < 4; ++i )
+				TEST_CHECK( q.peek( i ) && q.peek( i )->id == 6 + i );
+		}
+		TEST_CHECK_EQ( tracked::live, 0 );
+	}
+
+	TEST_CASE( "hpp/mpmc" )
+	{
+		constexpr int	producers = 2, consumers = 2, per_producer = 20000;
+		ringbuf::ring_buffer< std::string, 64, std::uint32_t, ringbuf::mpmc >	q;
+		std::atomic< long long >	sum { 0 };
+		std::atomic< int >	popped { 0 };
+		std::vector< std::thread >	threads;
+		std::string	s;
+
+		check_basic< ringbuf::mpmc >();
+
+		// std::string( const char * ) may throw: constructed first, then moved in.
+		TEST_CHECK( q.emplace( "x" ) && q.try_pop( s ) && s == "x" );
+
+		for ( int p = 0; p < producers; ++p )
+			threads.emplace_back( [ &q, p ] {
+				for ( int i = 0; i < per_producer; )
+					if ( q.try_push( std::to_string( p * per_producer + i ) ) )
+						++i;
+					else
+						std::this_thread::yield();
+			} );
+		for ( int c = 0; c < consumers; ++c )
+			threads.emplace_back( [ &q, &sum, &popped ] {
+				std::string	v;
+
+				while ( popped.load() < producers * per_producer )
+					if ( q.try_pop( v ) )
+					{
+						sum	+= std::stoll( v );
+						++popped;
+					}
+					else
+						std::this_thread::yield();
+			} );
+		for ( auto &t : threads )
+			t.join();
+
+		const long long	n	= producers * per_producer;
+
+		TEST_CHECK_EQ( popped.load(), n );
+		TEST_CHECK_EQ( sum.load(), n * ( n - 1 ) / 2 );
+		TEST_CHECK( q.empty() );
+	}
+
+	return test_report();
+}
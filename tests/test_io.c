@@ -0,0 +1,133 @@
+/** test_io: vectored fd I/O on byte ring buffers (ring_buffer_io.h).
+ *
+ * readv/writev over pipes and recvmsg/sendmsg over a socket pair, with spans
+ * split at the wrap point (one batch callback per segment), `max` limits, full
+ * and empty rings, and errors passed back as -errno.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_io.h"
+
+#include "test.h"
+
+
+ringbuffer_type_def( tio, char, 16 );
+ringbuffer_define_all( tio )
+ringbuffer_bulk_define_all( tio )
+ringbuffer_io_define_all( tio )
+
+
+/// Batch callback: counts the segments written.
+static size_t	tio_segments, tio_bytes;
+
+static void	tio_batch ( tio *rb, char *first, size_t n )
+{
+	( void )rb;
+	( void )first;
+	tio_segments++;
+	tio_bytes	+= n;
+}
+
+/// Empty ring with both (free-running) indices at `pos`.
+static void	tio_reset_at ( tio *rb, size_t pos )
+{
+	tio_init( rb, NULL );
+	rb->input = rb->output	= ( tio_index_t )pos;
+	rb->push_batch_callback	= tio_batch;
+	tio_segments = tio_bytes	= 0;
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	int	in[ 2 ], out[ 2 ], sv[ 2 ];
+	char	buf[ 32 ];
+	tio	rb;
+
+	test_init( argc, argv );
+
+	TEST_CHECK( !pipe( in ) && !pipe( out ) );
+	TEST_CHECK( !socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) );
+
+	TEST_CASE( "io/pipe" )
+	{
+		tio_reset_at( &rb, 12 );	// 4 bytes before the wrap point.
+		TEST_CHECK_EQ( write( in[ 1 ], "0123456789", 10 ), 10 );
+
+		TEST_CHECK_EQ( tio_read_fd( &rb, in[ 0 ], SIZE_MAX ), 10 );
+		TEST_CHECK_EQ( tio_count( &rb ), 10 );
+		TEST_CHECK_EQ( tio_segments, 2 );
+		TEST_CHECK_EQ( tio_bytes, 10 );
+		TEST_CHECK( !memcmp( &rb.data_buffer[ 12 ], "0123", 4 ) );
+		TEST_CHECK( !memcmp( &rb.data_buffer[ 0 ], "456789", 6 ) );
+
+		// Limited by `max`, then the rest: both from the wrapped span.
+		TEST_CHECK_EQ( tio_write_fd( &rb, out[ 1 ], 3 ), 3 );
+		TEST_CHECK_EQ( tio_write_fd( &rb, out[ 1 ], SIZE_MAX ), 7 );
+		TEST_CHECK( tio_empty( &rb ) );
+		TEST_CHECK_EQ( read( out[ 0 ], buf, sizeof( buf ) ), 10 );
+		TEST_CHECK( !memcmp( buf, "0123456789", 10 ) );
+
+		tio_stats_snapshot( &rb, &st );
+		TEST_CHECK_STAT( st.pushes, 10 );
+		TEST_CHECK_STAT( st.pops, 10 );
+		TEST_CHECK_STAT( st.high_water, 10 );
+	}
+
+	TEST_CASE( "io/full-empty" )
+	{
+		tio_reset_at( &rb, 0 );
+		TEST_CHECK_EQ( tio_write_fd( &rb, out[ 1 ], SIZE_MAX ), 0 );
+
+		TEST_CHECK_EQ( write( in[ 1 ], "abcdefghijklmnopqrst", 20 ), 20 );
+		TEST_CHECK_EQ( tio_read_fd( &rb, in[ 0 ], 5 ), 5 );
+		TEST_CHECK_EQ( tio_read_fd( &rb, in[ 0 ], SIZE_MAX ), 11 );
+		TEST_CHECK( tio_full( &rb ) );
+		TEST_CHECK_EQ( tio_read_fd( &rb, in[ 0 ], SIZE_MAX ), -ENOBUFS );
+		TEST_CHECK_EQ( tio_pop_n( &rb, buf, sizeof( buf ) ), 16 );
+		TEST_CHECK( !memcmp( buf, "abcdefghijklmnop", 16 ) );
+		TEST_CHECK_EQ( read( in[ 0 ], buf, sizeof( buf ) ), 4 );	// Left in the pipe.
+
+		tio_stats_snapshot( &rb, &st );
+		TEST_CHECK_STAT( st.empty_polls, 1 );
+		TEST_CHECK_STAT( st.rejected_pushes, 0 );	// Nothing was taken from the pipe.
+	}
+
+	TEST_CASE( "io/socket" )
+	{
+		tio_reset_at( &rb, 9 );
+		TEST_CHECK_EQ( tio_push_n( &rb, "hello, world", 12 ), 12 );	// Wraps.
+
+		TEST_CHECK_EQ( tio_send_fd( &rb, sv[ 0 ], SIZE_MAX, MSG_DONTWAIT ), 12 );
+		TEST_CHECK( tio_empty( &rb ) );
+		TEST_CHECK_EQ( tio_recv_fd( &rb, sv[ 1 ], SIZE_MAX, MSG_DONTWAIT ), 12 );
+		TEST_CHECK_EQ( tio_segments, 2 + 2 );	// push_n, then recv.
+		TEST_CHECK_EQ( tio_pop_n( &rb, buf, sizeof( buf ) ), 12 );
+		TEST_CHECK( !memcmp( buf, "hello, world", 12 ) );
+
+		TEST_CHECK_EQ( tio_recv_fd( &rb, sv[ 1 ], SIZE_MAX, MSG_DONTWAIT ), -EAGAIN );
+		TEST_CHECK( tio_empty( &rb ) );
+	}
+
+	TEST_CASE( "io/errors" )
+	{
+		tio_reset_at( &rb, 0 );
+		TEST_CHECK_EQ( tio_read_fd( &rb, -1, SIZE_MAX ), -EBADF );
+		TEST_CHECK_EQ( tio_push_n( &rb, "x", 1 ), 1 );
+		TEST_CHECK_EQ( tio_write_fd( &rb, -1, SIZE_MAX ), -EBADF );
+		TEST_CHECK_EQ( tio_count( &rb ), 1 );
+		TEST_CHECK_EQ( tio_segments, 1 );	// Only the push_n.
+	}
+
+	close( in[ 0 ] ); close( in[ 1 ] );
+	close( out[ 0 ] ); close( out[ 1 ] );
+	close( sv[ 0 ] ); close( sv[ 1 ] );
+
+	return test_report();
+}
@@ -0,0 +1,114 @@
+/** test_mirror: virtual-memory mirrored storage (ring_buffer_mirror.h).
+ *
+ * Size rules, aliasing of both halves, and spans across the wrap point coming
+ * back as a single segment from `_reserve`/`_peek_span` while the bulk copies
+ * still land where the unmirrored ring would put them.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_dynamic.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_mirror.h"
+
+#include "test.h"
+
+
+ringbuffer_dyn_declare_all( tmir, uint8_t );
+ringbuffer_dyn_define_all( tmir )
+ringbuffer_bulk_define_all( tmir )
+ringbuffer_mirror_declare_all( tmir );
+ringbuffer_mirror_define_all( tmir )
+
+
+/// Empty ring with both (free-running) indices at `pos`.
+static void	tmir_reset_at ( tmir *rb, size_t pos )
+{
+	rb->input = rb->output	= ( tmir_index_t )pos;
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	uint8_t	*p1, *p2, src[ 256 ], dst[ 256 ];
+	size_t	page = ( size_t )sysconf( _SC_PAGESIZE ), len, l1, l2, i;
+	tmir	rb;
+
+	test_init( argc, argv );
+
+	for ( i = 0; i < sizeof( src ); ++i )
+		src[ i ]	= ( uint8_t )( i * 7 + 1 );
+	len	= 2 * page;
+
+	TEST_CASE( "mirror/size-rules" )
+	{
+		memset( &rb, 0, sizeof( rb ) );
+		TEST_CHECK( !tmir_init_mirror( &rb, 0 ) );
+		TEST_CHECK( !tmir_init_mirror( &rb, page / 2 ) );	// Not a page multiple.
+		TEST_CHECK( !tmir_init_mirror( &rb, 3 * page ) );	// Not a power of two.
+		TEST_CHECK( !rb.data_buffer );
+
+		TEST_CHECK( tmir_init_mirror( &rb, len ) );
+		TEST_CHECK_EQ( RINGBUF_CAPACITY( &rb ), len );
+		TEST_CHECK_EQ( RINGBUF_LINEAR( &rb ), 2 * len );
+		tmir_free_mirror( &rb );
+		TEST_CHECK( !rb.data_buffer );
+	}
+
+	if ( !tmir_init_mirror( &rb, len ) )
+	{
+		printf( "mirror mapping failed, skipped\n" );
+		return TEST_SKIPPED;
+	}
+
+	TEST_CASE( "mirror/alias" )
+	{
+		rb.data_buffer[ 0 ]		= 0xa5;
+		rb.data_buffer[ len + len - 1 ]	= 0x5a;
+		TEST_CHECK_EQ( rb.data_buffer[ len ], 0xa5 );
+		TEST_CHECK_EQ( rb.data_buffer[ len - 1 ], 0x5a );
+	}
+
+	TEST_CASE( "mirror/spans" )
+	{
+		tmir_reset_at( &rb, 3 * len - 100 );	// 100 before the wrap point, third lap.
+
+		TEST_CHECK_EQ( tmir_reserve( &rb, 200, &p1, &l1, &p2, &l2 ), 200 );
+		TEST_CHECK( p1 == &rb.data_buffer[ len - 100 ] && l1 == 200 && !p2 && !l2 );
+		memcpy( p1, src, 200 );
+		tmir_commit( &rb, 200 );
+		TEST_CHECK( !memcmp( &rb.data_buffer[ 0 ], src + 100, 100 ) );	// Wrapped, through the alias.
+
+		TEST_CHECK_EQ( tmir_peek_span( &rb, SIZE_MAX, &p1, &l1, &p2, &l2 ), 200 );
+		TEST_CHECK( l1 == 200 && !p2 && !l2 );
+		TEST_CHECK( !memcmp( p1, src, 200 ) );
+		tmir_consume( &rb, 150 );
+
+		// Bulk copies across the wrap point.
+		TEST_CHECK_EQ( tmir_push_n( &rb, src, sizeof( src ) ), sizeof( src ) );
+		TEST_CHECK_EQ( tmir_count( &rb ), 50 + sizeof( src ) );
+		TEST_CHECK_EQ( tmir_pop_n( &rb, dst, 50 ), 50 );
+		TEST_CHECK( !memcmp( dst, src + 150, 50 ) );
+		TEST_CHECK_EQ( tmir_pop_n( &rb, dst, sizeof( dst ) ), sizeof( src ) );
+		TEST_CHECK( !memcmp( dst, src, sizeof( src ) ) );
+		TEST_CHECK( tmir_empty( &rb ) );
+
+		// A full ring is one segment too, from anywhere.
+		tmir_reset_at( &rb, len / 2 + 3 );
+		TEST_CHECK_EQ( tmir_reserve( &rb, SIZE_MAX, &p1, &l1, &p2, &l2 ), len );
+		TEST_CHECK( l1 == len && !p2 );
+		tmir_commit( &rb, len );
+		TEST_CHECK( tmir_full( &rb ) );
+		TEST_CHECK_EQ( tmir_peek_span( &rb, SIZE_MAX, &p1, &l1, &p2, &l2 ), len );
+		TEST_CHECK( l1 == len && !p2 );
+		tmir_consume( &rb, len );
+
+		tmir_stats_snapshot( &rb, &st );
+		TEST_CHECK_STAT( st.pushes, 200 + sizeof( src ) + len );
+		TEST_CHECK_STAT( st.pops, 200 + sizeof( src ) + len );
+	}
+
+	tmir_free_mirror( &rb );
+
+	return test_report();
+}
@@ -0,0 +1,151 @@
+/** test_registry: type-erased registry (ring_buffer_registry.h).
+ *
+ * Rings of three types (plain, SPSC, runtime-sized) joining one registry:
+ * totals and byte accounting, top-N fullest by ratio (ties in list order,
+ * `n` capped), the ops table, and leaving from the head, middle and
+ * tail of the list.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_dynamic.h"
+#include "ring_buffer_registry.h"
+
+#include "test.h"
+
+
+ringbuffer_type_def( treg_a, uint32_t, 16 );
+ringbuffer_define_all( treg_a )
+ringbuffer_registry_declare_all( treg_a );
+ringbuffer_registry_define_all( treg_a )
+
+ringbuffer_spsc_declare_all( treg_b, uint8_t, 64 );
+ringbuffer_spsc_define_all( treg_b )
+ringbuffer_registry_declare_all( treg_b );
+ringbuffer_registry_define_all( treg_b )
+
+ringbuffer_dyn_declare_all( treg_c, uint64_t );
+ringbuffer_dyn_define_all( treg_c )
+ringbuffer_registry_declare_all( treg_c );
+ringbuffer_registry_define_all( treg_c )
+
+
+/// Names of the registered rings, head first, joined in `buf`.
+static const char	*treg_list ( struct ring_buffer_registry *reg, char *buf, size_t size )
+{
+	struct ring_buffer_desc	*d;
+	size_t	len	= 0;
+
+	buf[ 0 ]	= '\0';
+	for ( d = reg->head; d && len < size; d = d->next )
+	{
+		TEST_CHECK( *d->pprev == d );
+		len	+= ( size_t )snprintf( buf + len, size - len, "%s%s", len ? "," : "", d->name );
+	}
+
+	return buf;
+}
+
+
+static struct ring_buffer_registry	reg;
+static struct ring_buffer_desc	da, db, dc, da2;
+static uint64_t	storage[ 32 ];
+static treg_a	a, a2;
+static treg_b	b;
+static treg_c	cr;
+
+/// Fresh registry holding `a` (4/16 used), `b` (48/64) and `c` (9/32), joined in that order.
+static void	treg_setup ( void )
+{
+	uint64_t	w = 0;
+	uint32_t	u = 0;
+	uint8_t	c = 0;
+	int	i;
+
+	ring_buffer_registry_init( &reg );
+	treg_a_init( &a, NULL );
+	treg_a_init( &a2, NULL );
+	treg_b_init( &b, NULL );
+	TEST_CHECK( treg_c_init_storage( &cr, storage, ARRAY_COUNT( storage ) ) );
+
+	for ( i = 0; i < 4; ++i )
+		TEST_CHECK( treg_a_push_front( &a, &u ) && treg_a_push_front( &a2, &u ) );
+	for ( i = 0; i < 48; ++i )
+		TEST_CHECK( treg_b_push_front( &b, &c ) );
+	for ( i = 0; i < 9; ++i )
+		TEST_CHECK( treg_c_push_front( &cr, &w ) );
+
+	treg_a_join( &a, &reg, &da, "a" );
+	treg_b_join( &b, &reg, &db, "b" );
+	treg_c_join( &cr, &reg, &dc, "c" );
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_registry_totals	tot;
+	struct ring_buffer_desc	*top[ RINGBUF_REGISTRY_TOP_MAX + 4 ];
+	struct ring_buffer_stats	st;
+	char	list[ 64 ];
+
+	test_init( argc, argv );
+
+	TEST_CASE( "registry/totals" )
+	{
+		ring_buffer_registry_init( &reg );
+		ring_buffer_registry_totals( &reg, &tot );
+		TEST_CHECK( !tot.rings && !tot.used && !tot.capacity && !tot.bytes_reserved );
+
+		treg_setup();
+		TEST_CHECK( !strcmp( treg_list( &reg, list, sizeof( list ) ), "c,b,a" ) );
+
+		ring_buffer_registry_totals( &reg, &tot );
+		TEST_CHECK_EQ( tot.rings, 3 );
+		TEST_CHECK_EQ( tot.used, 4 + 48 + 9 );
+		TEST_CHECK_EQ( tot.capacity, 16 + 64 + 32 );
+		TEST_CHECK_EQ( tot.bytes_used, 4 * 4 + 48 + 9 * 8 );
+		TEST_CHECK_EQ( tot.bytes_reserved, sizeof( a ) + sizeof( b ) + sizeof( cr ) + sizeof( storage ) );
+
+		TEST_CHECK_EQ( da.ops->element_size, 4 );
+		TEST_CHECK_EQ( dc.ops->capacity( dc.rb ), 32 );
+		dc.ops->stats( dc.rb, &st );
+		TEST_CHECK_STAT( st.pushes, 9 );
+	}
+
+	TEST_CASE( "registry/top" )
+	{
+		treg_setup();
+		TEST_CHECK_EQ( ring_buffer_registry_top( &reg, top, ARRAY_COUNT( top ) ), 3 );	// Capped, then what is there.
+		TEST_CHECK( top[ 0 ] == &db && top[ 1 ] == &dc && top[ 2 ] == &da );
+		TEST_CHECK_EQ( ring_buffer_registry_top( &reg, top, 1 ), 1 );
+		TEST_CHECK( top[ 0 ] == &db );
+		TEST_CHECK_EQ( ring_buffer_registry_top( &reg, top, 0 ), 0 );
+
+		// Same ratio as `a`: ranked before it (visited first), and what drops out at n = 3.
+		treg_a_join( &a2, &reg, &da2, "a2" );
+		TEST_CHECK_EQ( ring_buffer_registry_top( &reg, top, 4 ), 4 );
+		TEST_CHECK( top[ 0 ] == &db && top[ 1 ] == &dc && top[ 2 ] == &da2 && top[ 3 ] == &da );
+		TEST_CHECK_EQ( ring_buffer_registry_top( &reg, top, 3 ), 3 );
+		TEST_CHECK( top[ 2 ] == &da2 );
+	}
+
+	TEST_CASE( "registry/leave" )
+	{
+		treg_setup();
+		treg_a_join( &a2, &reg, &da2, "a2" );
+		ring_buffer_registry_leave( &reg, &db );	// Middle.
+		TEST_CHECK( !db.next && !db.pprev );
+		TEST_CHECK( !strcmp( treg_list( &reg, list, sizeof( list ) ), "a2,c,a" ) );
+		ring_buffer_registry_leave( &reg, &da2 );	// Head.
+		ring_buffer_registry_leave( &reg, &da );	// Tail.
+		TEST_CHECK( !strcmp( treg_list( &reg, list, sizeof( list ) ), "c" ) );
+
+		ring_buffer_registry_totals( &reg, &tot );
+		TEST_CHECK_EQ( tot.rings, 1 );
+		TEST_CHECK_EQ( tot.used, 9 );
+		ring_buffer_registry_leave( &reg, &dc );
+		TEST_CHECK( !reg.head && !reg.rings );
+	}
+
+	return test_report();
+}
@@ -0,0 +1,140 @@
+/** test_shm: shared-memory SPSC ring buffers (ring_buffer_shm.h).
+ *
+ * Create/attach/detach and their errors (existing or missing segment, header
+ * mismatch), two mappings of one segment at different addresses in the same
+ * process, then a forked consumer checking order and count against the parent
+ * producer. Skipped (TEST_SKIPPED) where shm_open() is not allowed.
+ */
+
+#include <sched.h>
+#include <sys/wait.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_shm.h"
+
+#include "test.h"
+
+
+ringbuffer_shm_declare_all( tshm, uint32_t, 64 );
+ringbuffer_shm_define_all( tshm )
+
+/// Same element type, other capacity: must not attach to a `tshm` segment.
+ringbuffer_shm_declare_all( tshm_other, uint32_t, 128 );
+ringbuffer_shm_define_all( tshm_other )
+
+
+#define	TSHM_ITEMS	100000u
+
+
+/// Forked consumer: pops TSHM_ITEMS in order, exit status 0 if all were right.
+static int	tshm_consumer ( const char *path )
+{
+	uint32_t	next = 0, *p;
+	tshm	*rb;
+
+	if ( !( rb = tshm_shm_attach( path ) ) )
+		return 2;
+	while ( next < TSHM_ITEMS )
+	{
+		if ( !( p = tshm_peek( rb, 0 ) ) )
+		{
+			sched_yield();
+			continue;
+		}
+		if ( *p != next++ )
+			return 1;
+		tshm_pop_back( rb );
+	}
+	tshm_shm_detach( rb );
+
+	return 0;
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	char	path[ 64 ];
+	tshm	*rb, *rb2;
+	uint32_t	v, i;
+	pid_t	pid;
+	int	status;
+
+	test_init( argc, argv );
+
+	snprintf( path, sizeof( path ), "/ringbuf_test_shm.%ld", ( long )getpid() );
+	if ( !( rb = tshm_shm_create( path, 0600 ) ) )
+	{
+		printf( "shm_open: %s, skipped\n", strerror( errno ) );
+		return TEST_SKIPPED;
+	}
+
+	TEST_CASE( "shm/create-attach" )
+	{
+		TEST_CHECK( tshm_empty( rb ) );
+		TEST_CHECK_EQ( rb->header.magic, RINGBUF_SHM_MAGIC );
+		TEST_CHECK_EQ( rb->header.capacity, 64 );
+		TEST_CHECK_EQ( rb->header.size, sizeof( tshm ) );
+
+		errno	= 0;
+		TEST_CHECK( !tshm_shm_create( path, 0600 ) );
+		TEST_CHECK_EQ( errno, EEXIST );
+		errno	= 0;
+		TEST_CHECK( !tshm_other_shm_attach( path ) );
+		TEST_CHECK_EQ( errno, EPROTO );
+		errno	= 0;
+		TEST_CHECK( !tshm_shm_attach( "/ringbuf_test_shm.missing" ) );
+		TEST_CHECK_EQ( errno, ENOENT );
+	}
+
+	TEST_CASE( "shm/two-mappings" )
+	{
+		// Producer through one mapping, consumer through another: nothing is address bound.
+		TEST_CHECK( ( rb2 = tshm_shm_attach( path ) ) && rb2 != rb );
+		if ( rb2 )
+		{
+			for ( v = 0; tshm_push_front( rb, &v ); ++v )
+				;
+			TEST_CHECK_EQ( v, 64 );
+			TEST_CHECK( tshm_full( rb2 ) );
+			for ( i = 0; i < 64; ++i )
+			{
+				TEST_CHECK( tshm_peek( rb2, 0 ) && *tshm_peek( rb2, 0 ) == i );
+				TEST_CHECK( tshm_pop_back( rb2 ) );
+			}
+			TEST_CHECK( tshm_empty( rb ) );
+			TEST_CHECK( !tshm_pop_back( rb2 ) );
+
+			tshm_stats_snapshot( rb, &st );
+			TEST_CHECK_STAT( st.pushes, 64 );
+			TEST_CHECK_STAT( st.rejected_pushes, 1 );
+			TEST_CHECK_STAT( st.pops, 64 );
+			TEST_CHECK_STAT( st.high_water, 64 );
+			tshm_shm_detach( rb2 );
+		}
+	}
+
+	TEST_CASE( "shm/fork" )
+	{
+		fflush( NULL );
+		if ( !( pid = fork() ) )
+			_exit( tshm_consumer( path ) );
+		TEST_CHECK( pid > 0 );
+		if ( pid > 0 )
+		{
+			for ( v = 0; v < TSHM_ITEMS; )
+				if ( tshm_push_front( rb, &v ) )
+					++v;
+				else
+					sched_yield();
+			TEST_CHECK_EQ( waitpid( pid, &status, 0 ), pid );
+			TEST_CHECK( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+			TEST_CHECK( tshm_empty( rb ) );
+		}
+	}
+
+	tshm_shm_detach( rb );
+	shm_unlink( path );
+
+	return test_report();
+}
@@ -0,0 +1,162 @@
+/** test_string: `_push_string` (and the string pops it pairs with).
+ *
+ * Empty pushes, pushes wrapping at the end of data_buffer (one copy and one
+ * batch callback per segment), partial pushes into a nearly full ring, wide
+ * elements and runtime-sized rings. Built with and without RINGBUF_STATS; the
+ * former also checks the counters the push updates.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_dynamic.h"
+#include "ring_buffer_string.h"
+
+#include "test.h"
+
+
+ringbuffer_type_def( tstr, char, 16 );
+ringbuffer_define_all( tstr )
+ringbuffer_push_string_def( tstr )
+ringbuffer_pop_string_def( tstr )
+ringbuffer_pop_until_def( tstr )
+
+ringbuffer_type_def( twide, uint16_t, 8 );
+ringbuffer_define_all( twide )
+ringbuffer_push_string_def( twide )
+ringbuffer_pop_string_def( twide )
+
+ringbuffer_dyn_type_def( tdyn, char );
+ringbuffer_dyn_define_all( tdyn )
+ringbuffer_push_string_def( tdyn )
+ringbuffer_pop_string_def( tdyn )
+
+
+/// Batch callback: records the segments written.
+static struct { char *first[ 4 ]; size_t n[ 4 ], calls; }	segs;
+
+static void	tstr_segments ( tstr *rb, char *first, size_t n )
+{
+	( void )rb;
+	if ( segs.calls < ARRAY_COUNT( segs.n ) )
+	{
+		segs.first[ segs.calls ]	= first;
+		segs.n[ segs.calls ]		= n;
+	}
+	segs.calls++;
+}
+
+/// Empty ring with both (free-running) indices at `pos`, as if `pos` elements went through.
+static void	tstr_reset_at ( tstr *rb, size_t pos )
+{
+	tstr_init( rb, NULL );
+	rb->input = rb->output	= ( tstr_index_t )pos;
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	char	out[ 32 ];
+	tstr	rb;
+
+	test_init( argc, argv );
+
+	TEST_CASE( "push_string/len0" )
+	{
+		tstr_init( &rb, NULL );
+		TEST_CHECK_EQ( tstr_push_string( &rb, "abc", 0 ), 0 );
+		TEST_CHECK( tstr_empty( &rb ) );
+
+		rb.push_batch_callback	= tstr_segments;
+		segs.calls	= 0;
+		TEST_CHECK_EQ( tstr_push_string( &rb, "abc", 0 ), 0 );
+		TEST_CHECK_EQ( segs.calls, 0 );
+
+		tstr_stats_snapshot( &rb, &st );
+		TEST_CHECK_STAT( st.pushes, 0 );
+		TEST_CHECK_STAT( st.rejected_pushes, 0 );
+	}
+
+	TEST_CASE( "push_string/fill" )
+	{
+		tstr_init( &rb, NULL );
+		TEST_CHECK_EQ( tstr_push_string( &rb, "0123456789abcdef", 16 ), 16 );
+		TEST_CHECK( tstr_full( &rb ) );
+		TEST_CHECK_EQ( tstr_pop_string( &rb, out, sizeof( out ) ), 16 );
+		TEST_CHECK( !memcmp( out, "0123456789abcdef", 16 ) );
+		TEST_CHECK( tstr_empty( &rb ) );
+	}
+
+	TEST_CASE( "push_string/wrap" )
+	{
+		tstr_reset_at( &rb, 13 );	// 3 elements left before the wrap point.
+		rb.push_batch_callback	= tstr_segments;
+		segs.calls	= 0;
+
+		TEST_CHECK_EQ( tstr_push_string( &rb, "wrap-around", 11 ), 11 );
+		TEST_CHECK_EQ( tstr_count( &rb ), 11 );
+
+		// One batch call per contiguous segment, in place.
+		TEST_CHECK_EQ( segs.calls, 2 );
+		TEST_CHECK( segs.first[ 0 ] == &rb.data_buffer[ 13 ] );
+		TEST_CHECK_EQ( segs.n[ 0 ], 3 );
+		TEST_CHECK( segs.first[ 1 ] == &rb.data_buffer[ 0 ] );
+		TEST_CHECK_EQ( segs.n[ 1 ], 8 );
+		TEST_CHECK( !memcmp( &rb.data_buffer[ 13 ], "wra", 3 ) );
+		TEST_CHECK( !memcmp( &rb.data_buffer[ 0 ], "p-around", 8 ) );
+
+		memset( out, 0, sizeof( out ) );
+		TEST_CHECK_EQ( tstr_pop_until( &rb, out, sizeof( out ), '-' ), 5 );
+		TEST_CHECK( !strcmp( out, "wrap-" ) );
+		TEST_CHECK_EQ( tstr_pop_string( &rb, out, sizeof( out ) ), 6 );
+		TEST_CHECK( !memcmp( out, "around", 6 ) );
+	}
+
+	TEST_CASE( "push_string/partial" )
+	{
+		tstr_reset_at( &rb, 10 );
+		TEST_CHECK_EQ( tstr_push_string( &rb, "0123456789ab", 12 ), 12 );
+
+		// 4 free: only the first 4 of 10 go in (and wrap).
+		TEST_CHECK_EQ( tstr_push_string( &rb, "ABCDEFGHIJ", 10 ), 4 );
+		TEST_CHECK( tstr_full( &rb ) );
+		TEST_CHECK_EQ( tstr_push_string( &rb, "K", 1 ), 0 );
+
+		TEST_CHECK_EQ( tstr_pop_string( &rb, out, sizeof( out ) ), 16 );
+		TEST_CHECK( !memcmp( out, "0123456789abABCD", 16 ) );
+
+		tstr_stats_snapshot( &rb, &st );
+		TEST_CHECK_STAT( st.pushes, 16 );
+		TEST_CHECK_STAT( st.rejected_pushes, 6 + 1 );
+		TEST_CHECK_STAT( st.high_water, 16 );
+	}
+
+	TEST_CASE( "push_string/wide" )
+	{
+		static const uint16_t	src[] = { 0x0101, 0x0202, 0x0303, 0x0404, 0x0505, 0x0606 };
+		uint16_t	dst[ 8 ];
+		twide		w;
+
+		twide_init( &w, NULL );
+		TEST_CHECK_EQ( twide_push_string( &w, ( uint16_t * )src, 5 ), 5 );
+		TEST_CHECK_EQ( twide_pop_string( &w, dst, 5 ), 5 );
+		// Wraps after 3 elements: the second copy must be in elements, not bytes.
+		TEST_CHECK_EQ( twide_push_string( &w, ( uint16_t * )src, 6 ), 6 );
+		TEST_CHECK_EQ( twide_pop_string( &w, dst, 8 ), 6 );
+		TEST_CHECK( !memcmp( dst, src, sizeof( src ) ) );
+	}
+
+	TEST_CASE( "push_string/dyn" )
+	{
+		char	mem[ 4 ];
+		tdyn	d;
+
+		TEST_CHECK( tdyn_init_storage( &d, mem, sizeof( mem ) ) );
+		TEST_CHECK_EQ( tdyn_push_string( &d, "abcdef", 6 ), 4 );
+		TEST_CHECK_EQ( tdyn_pop_string( &d, out, 3 ), 3 );
+		TEST_CHECK_EQ( tdyn_push_string( &d, "gh", 2 ), 2 );	// Wraps.
+		TEST_CHECK_EQ( tdyn_pop_string( &d, out, sizeof( out ) ), 3 );
+		TEST_CHECK( !memcmp( out, "dgh", 3 ) );
+	}
+
+	return test_report();
+}
@@ -0,0 +1,119 @@
+/** test_trace: queueing-delay tracing (ring_buffer_trace.h), on a fake clock.
+ *
+ * Bucket and lower-bound helpers over the whole range, delays recorded by the
+ * single and bulk pops (clock wrap included), stamps of a full ring left alone
+ * by a refused push, and percentiles from a snapshot.
+ */
+
+#include <stdint.h>
+
+/// Fake clock: every stamp and delay is known exactly.
+static uint32_t	ttr_now;
+
+#define	RINGBUF_TRACE_CLOCK()	ttr_now
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_trace.h"
+
+#include "test.h"
+
+
+ringbuffer_spsc_declare_all( ttr_ring, int, 8 );
+ringbuffer_spsc_define_all( ttr_ring )
+ringbuffer_spsc_bulk_define_all( ttr_ring )
+ringbuffer_trace_declare_all( ttr, ttr_ring );
+ringbuffer_trace_define_all( ttr, ttr_ring )
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_stats	st;
+	struct ring_buffer_hist	h;
+	int	src[ 8 ] = { 0, 1, 2, 3, 4, 5, 6, 7 }, dst[ 8 ], v;
+	unsigned	b, prev;
+	uint64_t	x;
+	ttr	t;
+
+	test_init( argc, argv );
+
+	TEST_CASE( "trace/buckets" )
+	{
+		for ( v = 0; v < ( int )RINGBUF_HIST_SUB; ++v )
+			TEST_CHECK_EQ( ring_buffer_hist_bucket( ( ringbuf_time_t )v ), v );
+
+		// Every value within its bucket, buckets increasing, up to the largest stamp.
+		prev	= 0;
+		for ( x = 1; x <= UINT32_MAX; x = x * 5 / 4 + 1 )
+		{
+			b	= ring_buffer_hist_bucket( ( ringbuf_time_t )x );
+			TEST_CHECK( b < RINGBUF_HIST_BUCKETS && b >= prev );
+			TEST_CHECK( ring_buffer_hist_lower( b ) <= x && x < ring_buffer_hist_lower( b + 1 ) );
+			prev	= b;
+		}
+		TEST_CHECK_EQ( ring_buffer_hist_bucket( UINT32_MAX ), RINGBUF_HIST_BUCKETS - 1 );
+		TEST_CHECK_EQ( ring_buffer_hist_lower( ring_buffer_hist_bucket( 10 ) ), 10 );
+	}
+
+	TEST_CASE( "trace/delays" )
+	{
+		ttr_init( &t );
+		ttr_now	= 100;
+		TEST_CHECK_EQ( ttr_push_n( &t, src, 3 ), 3 );
+		ttr_now	= 105;
+		TEST_CHECK( ttr_push( &t, &src[ 3 ] ) );
+
+		ttr_now	= 110;
+		TEST_CHECK_EQ( ttr_pop_n( &t, dst, 2 ), 2 );	// 10, 10.
+		ttr_now	= 200;
+		TEST_CHECK( ttr_pop( &t, &v ) && v == 2 );	// 100.
+		TEST_CHECK( ttr_pop( &t, &v ) && v == 3 );	// 95.
+		TEST_CHECK( !ttr_pop( &t, &v ) );
+
+		ttr_hist_snapshot( &t, &h );
+		TEST_CHECK_EQ( h.count, 4 );
+		TEST_CHECK_EQ( h.max, 100 );
+		TEST_CHECK_EQ( h.bucket[ ring_buffer_hist_bucket( 10 ) ], 2 );
+		TEST_CHECK_EQ( ring_buffer_hist_percentile( &h, 500 ), 10 );
+		TEST_CHECK_EQ( ring_buffer_hist_percentile( &h, 1000 ), ring_buffer_hist_lower( ring_buffer_hist_bucket( 100 ) ) );
+		TEST_CHECK_EQ( ring_buffer_hist_percentile( &h, 0 ), 10 );
+
+		// Across the clock wrap.
+		ttr_now	= UINT32_MAX - 5;
+		TEST_CHECK( ttr_push( &t, &src[ 0 ] ) );
+		ttr_now	= 4;
+		TEST_CHECK( ttr_pop( &t, &v ) );
+		ttr_hist_snapshot( &t, &h );
+		TEST_CHECK_EQ( h.count, 5 );
+		TEST_CHECK_EQ( h.bucket[ ring_buffer_hist_bucket( 10 ) ], 3 );
+
+		ttr_ring_stats_snapshot( &t.ring, &st );
+		TEST_CHECK_STAT( st.pushes, 5 );
+		TEST_CHECK_STAT( st.pops, 5 );
+		TEST_CHECK_STAT( st.empty_polls, 1 );
+	}
+
+	TEST_CASE( "trace/full" )
+	{
+		ttr_init( &t );
+		ttr_now	= 0;
+		TEST_CHECK_EQ( ttr_push_n( &t, src, 8 ), 8 );
+		ttr_now	= 50;
+		TEST_CHECK( !ttr_push( &t, &src[ 0 ] ) );	// Must not restamp the oldest slot.
+		TEST_CHECK_EQ( ttr_push_n( &t, src, 4 ), 0 );
+		ttr_now	= 60;
+		TEST_CHECK_EQ( ttr_pop_n( &t, dst, ARRAY_COUNT( dst ) ), 8 );
+		TEST_CHECK( !memcmp( dst, src, sizeof( src ) ) );
+
+		ttr_hist_snapshot( &t, &h );
+		TEST_CHECK_EQ( h.count, 8 );
+		TEST_CHECK_EQ( h.max, 60 );
+		TEST_CHECK_EQ( h.bucket[ ring_buffer_hist_bucket( 60 ) ], 8 );
+
+		ttr_ring_stats_snapshot( &t.ring, &st );
+		TEST_CHECK_STAT( st.rejected_pushes, 1 + 4 );
+	}
+
+	return test_report();
+}
@@ -0,0 +1,157 @@
+/** test_uring: io_uring fill/drain engine (ring_buffer_uring.h) over pipes.
+ *
+ * A fill reads the first free segment only, a busy slot refuses a second
+ * operation, re-armed drains keep the caller's `max` across the wrap point
+ * (plain and registered-buffer WRITE_FIXED), and a re-armed fill stops at
+ * EOF. Skipped (TEST_SKIPPED) where io_uring_setup() is not allowed.
+ */
+
+#include <unistd.h>
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_uring.h"
+
+#include "test.h"
+
+
+ringbuffer_spsc_declare_all( tu, uint8_t, 16 );
+ringbuffer_spsc_define_all( tu )
+ringbuffer_spsc_bulk_define_all( tu )
+ringbuffer_uring_declare_all( tu );
+ringbuffer_uring_define_all( tu )
+
+
+/// Completion results, in order (`notify` hook).
+static int	tu_res[ 16 ];
+static size_t	tu_completions;
+
+static void	tu_notify ( struct ring_buffer_uring_io *io )
+{
+	if ( tu_completions < ARRAY_COUNT( tu_res ) )
+		tu_res[ tu_completions ]	= io->res;
+	tu_completions++;
+}
+
+/// Empty ring with both (free-running) indices at `pos`.
+static void	tu_reset_at ( tu *rb, size_t pos )
+{
+	tu_init( rb, NULL );
+	rb->input = rb->output = rb->input_cache = rb->output_cache	= ( tu_index_t )pos;
+	tu_completions	= 0;
+}
+
+/// Submit and reap until `io` has nothing in flight (re-armed operations included).
+static void	tu_run ( struct ring_buffer_uring *u, struct ring_buffer_uring_io *io )
+{
+	while ( io->busy )
+	{
+		TEST_CHECK( ring_buffer_uring_submit( u, 1 ) >= 0 );
+		ring_buffer_uring_reap( u );
+	}
+}
+
+/// Drain 12 bytes, starting 6 before the wrap point, by `max` 5, through `buf_index`.
+static void	tu_drain_by_5 ( struct ring_buffer_uring *u, tu *rb, int buf_index )
+{
+	struct ring_buffer_uring_io	io;
+	struct ring_buffer_stats	st;
+	uint8_t	got[ 16 ];
+	int	p[ 2 ];
+	size_t	i;
+
+	TEST_CHECK( !pipe( p ) );
+	tu_reset_at( rb, 10 );
+	TEST_CHECK_EQ( tu_push_n( rb, ( const uint8_t * )"abcdefghijkl", 12 ), 12 );
+	tu_uring_io_init( &io, u, rb, p[ 1 ], buf_index );
+	io.rearm	= true;
+	io.notify	= tu_notify;
+
+	TEST_CHECK( tu_uring_drain( &io, 5 ) );
+	tu_run( u, &io );
+
+	// 5, then up to the wrap point, then 5 again: never more than `max`.
+	TEST_CHECK_EQ( tu_completions, 4 );
+	TEST_CHECK( tu_res[ 0 ] == 5 && tu_res[ 1 ] == 1 && tu_res[ 2 ] == 5 && tu_res[ 3 ] == 1 );
+	for ( i = 0; i < tu_completions && i < ARRAY_COUNT( tu_res ); ++i )
+		TEST_CHECK( tu_res[ i ] <= 5 );
+	TEST_CHECK( tu_empty( rb ) );
+	TEST_CHECK_EQ( read( p[ 0 ], got, sizeof( got ) ), 12 );
+	TEST_CHECK( !memcmp( got, "abcdefghijkl", 12 ) );
+
+	tu_stats_snapshot( rb, &st );
+	TEST_CHECK_STAT( st.pops, 12 );
+	TEST_CHECK_STAT( st.empty_polls, 1 );	// The last re-arm found the ring empty.
+
+	close( p[ 0 ] );
+	close( p[ 1 ] );
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct ring_buffer_uring	u;
+	struct ring_buffer_uring_io	io;
+	uint8_t	out[ 16 ];
+	int	p[ 2 ], err;
+	tu	rb;
+
+	test_init( argc, argv );
+
+	if ( ( err = ring_buffer_uring_init( &u, 8 ) ) < 0 )
+	{
+		printf( "io_uring_setup: %s, skipped\n", strerror( -err ) );
+		return TEST_SKIPPED;
+	}
+
+	TEST_CASE( "uring/fill" )
+	{
+		TEST_CHECK( !pipe( p ) );
+		TEST_CHECK_EQ( write( p[ 1 ], "0123456789", 10 ), 10 );
+		tu_reset_at( &rb, 12 );
+		tu_uring_io_init( &io, &u, &rb, p[ 0 ], -1 );
+		io.notify	= tu_notify;
+
+		TEST_CHECK( tu_uring_fill( &io, SIZE_MAX ) );
+		TEST_CHECK( io.busy );
+		TEST_CHECK( !tu_uring_fill( &io, SIZE_MAX ) );	// One in flight per slot.
+		tu_run( &u, &io );
+		TEST_CHECK_EQ( io.res, 4 );	// Up to the wrap point only.
+		TEST_CHECK_EQ( tu_count( &rb ), 4 );
+
+		TEST_CHECK( tu_uring_fill( &io, 3 ) );
+		tu_run( &u, &io );
+		TEST_CHECK_EQ( io.res, 3 );
+		TEST_CHECK_EQ( tu_completions, 2 );
+		TEST_CHECK_EQ( tu_pop_n( &rb, out, sizeof( out ) ), 7 );
+		TEST_CHECK( !memcmp( out, "0123456", 7 ) );
+
+		// Re-armed: the rest ("789"), then EOF, which commits nothing and stops.
+		close( p[ 1 ] );
+		io.rearm	= true;
+		TEST_CHECK( tu_uring_fill( &io, SIZE_MAX ) );
+		tu_run( &u, &io );
+		TEST_CHECK_EQ( tu_completions, 4 );
+		TEST_CHECK( tu_res[ 2 ] == 3 && tu_res[ 3 ] == 0 );
+		TEST_CHECK( !io.busy );
+		TEST_CHECK_EQ( tu_pop_n( &rb, out, sizeof( out ) ), 3 );
+		TEST_CHECK( !memcmp( out, "789", 3 ) );
+		close( p[ 0 ] );
+	}
+
+	TEST_CASE( "uring/drain" )
+		tu_drain_by_5( &u, &rb, -1 );
+
+	TEST_CASE( "uring/drain-fixed" )
+	{
+		if ( !( err = ring_buffer_uring_register( &u, &RINGBUF_URING_IOVEC( &rb ), 1 ) ) )
+			tu_drain_by_5( &u, &rb, 0 );
+		else
+			printf( "io_uring_register: %s, drain-fixed not run\n", strerror( -err ) );
+	}
+
+	ring_buffer_uring_exit( &u );
+
+	return test_report();
+}
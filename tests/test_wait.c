@@ -0,0 +1,137 @@
+/** test_wait: waitable SPSC wrappers (ring_buffer_wait.h), single-threaded.
+ *
+ * Non-blocking wrappers, timeouts on a full/empty ring (and their counters),
+ * `_pop_batch_wait` deadlines and watermarks, and `ring_buffer_wait_tune`
+ * clamping. Wakeups across threads are stress_ring_buffer's wait/ cases.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_wait.h"
+
+#include "test.h"
+
+
+ringbuffer_spsc_declare_all( tw_ring, int, 8 );
+ringbuffer_spsc_define_all( tw_ring )
+
+ringbuffer_wait_declare_all( tw, tw_ring );
+ringbuffer_wait_define_all( tw, tw_ring )
+
+
+/// Milliseconds elapsed since `t0` (CLOCK_MONOTONIC).
+static long	tw_elapsed_ms ( const struct timespec *t0 )
+{
+	struct timespec	t;
+
+	clock_gettime( CLOCK_MONOTONIC, &t );
+
+	return ( t.tv_sec - t0->tv_sec ) * 1000 + ( t.tv_nsec - t0->tv_nsec ) / 1000000;
+}
+
+static void	tw_fill ( tw *w, int n )
+{
+	int	i;
+
+	for ( i = 0; i < n; ++i )
+		TEST_CHECK( tw_push( w, &i ) );
+}
+
+
+int	main ( int argc, char **argv )
+{
+	struct timespec	t0;
+	int	v, out[ 16 ], i;
+	tw	w;
+
+	test_init( argc, argv );
+
+	TEST_CASE( "wait/nonblocking" )
+	{
+		tw_init( &w, NULL );
+		tw_fill( &w, 8 );
+		v	= 8;
+		TEST_CHECK( !tw_push( &w, &v ) );
+		for ( i = 0; i < 8; ++i )
+		{
+			TEST_CHECK( tw_pop( &w, &v ) );
+			TEST_CHECK_EQ( v, i );
+		}
+		TEST_CHECK( !tw_pop( &w, &v ) );
+
+		// Uncontended blocking calls never sleep.
+		TEST_CHECK_EQ( tw_push_wait( &w, &v, -1 ), 0 );
+		TEST_CHECK_EQ( tw_pop_wait( &w, &v, -1 ), 0 );
+		TEST_CHECK( tw_ring_empty( &w.ring ) );
+	}
+
+	TEST_CASE( "wait/timeout" )
+	{
+		tw_init( &w, NULL );
+		tw_fill( &w, 8 );
+
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		v	= 8;
+		TEST_CHECK_EQ( tw_push_wait( &w, &v, 20 ), -ETIMEDOUT );
+		TEST_CHECK( tw_elapsed_ms( &t0 ) >= 19 );
+		TEST_CHECK_EQ( tw_push_wait( &w, &v, 0 ), -ETIMEDOUT );
+		TEST_CHECK_EQ( tw_ring_count( &w.ring ), 8 );
+
+		while ( tw_pop( &w, &v ) )
+			;
+		clock_gettime( CLOCK_MONOTONIC, &t0 );
+		TEST_CHECK_EQ( tw_pop_wait( &w, &v, 10 ), -ETIMEDOUT );
+		TEST_CHECK( tw_elapsed_ms( &t0 ) >= 9 );
+
+		TEST_CHECK_STAT( w.wait.push_timeouts, 2 );
+		TEST_CHECK_STAT( w.wait.pop_timeouts, 1 );
+		TEST_CHECK_EQ( w.wait.not_full.waiters, 0 );
+		TEST_CHECK_EQ( w.wait.not_empty.waiters, 0 );
+	}
+
+	TEST_CASE( "wait/batch" )
+	{
+		tw_init( &w, NULL );
+		ring_buffer_wait_tune( &w.wait, 2, 4, 0, 0 );
+
+		// Below the high watermark: the deadline passes, then what is there is drained.
+		tw_fill( &w, 3 );
+		TEST_CHECK_EQ( tw_pop_batch_wait( &w, out, ARRAY_COUNT( out ), 10 ), 3 );
+		TEST_CHECK( out[ 0 ] == 0 && out[ 2 ] == 2 );
+		TEST_CHECK_STAT( w.wait.pop_timeouts, 1 );
+
+		// At the high watermark: no wait, even forever; `limit` still applies.
+		tw_fill( &w, 6 );
+		TEST_CHECK_EQ( tw_pop_batch_wait( &w, out, 5, -1 ), 5 );
+		TEST_CHECK_EQ( out[ 4 ], 4 );
+		TEST_CHECK_EQ( tw_ring_count( &w.ring ), 1 );
+
+		TEST_CHECK( tw_pop( &w, &v ) );
+		TEST_CHECK_EQ( tw_pop_batch_wait( &w, out, ARRAY_COUNT( out ), 0 ), 0 );
+		TEST_CHECK_STAT( w.wait.pop_timeouts, 2 );
+	}
+
+	TEST_CASE( "wait/tune" )
+	{
+		tw_init( &w, NULL );
+		TEST_CHECK_EQ( w.wait.capacity, 8 );
+		TEST_CHECK_EQ( w.wait.high_watermark, 1 );
+		TEST_CHECK_EQ( w.wait.low_watermark, 7 );
+
+		ring_buffer_wait_tune( &w.wait, 100, 100, 10, 2 );
+		TEST_CHECK_EQ( w.wait.high_watermark, 8 );
+		TEST_CHECK_EQ( w.wait.low_watermark, 7 );
+		TEST_CHECK_EQ( w.wait.spin_count, 10 );
+		TEST_CHECK_EQ( w.wait.yield_count, 2 );
+
+		ring_buffer_wait_tune( &w.wait, 0, 0, 0, 0 );
+		TEST_CHECK_EQ( w.wait.high_watermark, 1 );
+		TEST_CHECK_EQ( w.wait.low_watermark, 0 );
+
+		// Spinning first does not change the outcome.
+		ring_buffer_wait_tune( &w.wait, 7, 1, 100, 3 );
+		TEST_CHECK_EQ( tw_pop_wait( &w, &v, 0 ), -ETIMEDOUT );
+	}
+
+	return test_report();
+}
@@ -0,0 +1,134 @@
+/** test_window: segment visitor and window kernels (ring_buffer_window.h).
+ *
+ * Every (offset, n) window of a ring wrapping near the end of data_buffer,
+ * checked against a linear copy: segments handed to `_for_each_span`, sums,
+ * min/max and CRC-32 (check value included). Also the generic part alone on an
+ * SPSC ring of a non-arithmetic TYPE.
+ */
+
+#include "ring_buffer.h"
+#include "ring_buffer_spsc.h"
+#include "ring_buffer_bulk.h"
+#include "ring_buffer_window.h"
+
+#include "test.h"
+
+
+ringbuffer_type_def( twin, int16_t, 16 );
+ringbuffer_define_all( twin )
+ringbuffer_bulk_define_all( twin )
+ringbuffer_window_declare_all( twin, int32_t );
+ringbuffer_window_define_all( twin, int32_t )
+
+struct twin_pair	{ uint8_t a, b; };
+
+ringbuffer_spsc_declare_all( twin_spsc, struct twin_pair, 8 );
+ringbuffer_spsc_define_all( twin_spsc )
+ringbuffer_spsc_bulk_define_all( twin_spsc )
+ringbuffer_window_span_declare_all( twin_spsc );
+ringbuffer_window_span_define_all( twin_spsc )
+
+
+/// Span visitor: copies the segments out, in order.
+static struct { int16_t v[ 32 ]; size_t n, calls; }	spans;
+
+static void	twin_collect ( twin *rb, const int16_t *first, size_t n, void *ctx )
+{
+	TEST_CHECK( first >= rb->data_buffer && first + n <= rb->data_buffer + ARRAY_COUNT( rb->data_buffer ) );
+	TEST_CHECK( ctx == &spans );
+	memcpy( &spans.v[ spans.n ], first, n * sizeof( *first ) );
+	spans.n	+= n;
+	spans.calls++;
+}
+
+static void	twin_spsc_tally ( twin_spsc *rb, const struct twin_pair *first, size_t n, void *ctx )
+{
+	( void )rb;
+	( void )first;
+	*( size_t * )ctx	+= n;
+}
+
+
+int	main ( int argc, char **argv )
+{
+	int16_t	model[ 16 ], lo, hi, mlo, mhi;
+	size_t	used, off, n, w, i, total;
+	uint32_t	crc, mcrc;
+	int32_t	sum, msum;
+	struct twin_pair	pairs[ 6 ];
+	twin_spsc	rs;
+	twin	rb;
+
+	test_init( argc, argv );
+
+	TEST_CASE( "window/crc32" )
+	{
+		crc	= ~ring_buffer_crc32( ~0u, "123456789", 9 );
+		TEST_CHECK_EQ( crc, 0xcbf43926u );
+		crc	= ring_buffer_crc32( ring_buffer_crc32( ~0u, "1234", 4 ), "56789", 5 );
+		TEST_CHECK_EQ( ~crc, 0xcbf43926u );
+	}
+
+	TEST_CASE( "window/all" )
+	{
+		twin_init( &rb, NULL );
+		rb.input = rb.output	= 10;	// Wraps after 6 elements.
+		used	= 14;
+		for ( i = 0; i < used; ++i )
+			model[ i ]	= ( int16_t )( ( i * 37 ) % 23 - 11 );
+		TEST_CHECK_EQ( twin_push_n( &rb, model, used ), used );
+
+		for ( off = 0; off <= used + 1; ++off )
+			for ( n = 0; n <= used + 1; ++n )
+			{
+				w	= off < used ? ( n < used - off ? n : used - off ) : 0;
+
+				spans.n = spans.calls	= 0;
+				TEST_CHECK_EQ( twin_for_each_span( &rb, off, n, twin_collect, &spans ), w );
+				TEST_CHECK_EQ( spans.n, w );
+				TEST_CHECK_EQ( spans.calls, !w ? 0 : 10 + off < 16 && 10 + off + w > 16 ? 2 : 1 );
+				TEST_CHECK( !memcmp( spans.v, &model[ off ], w * sizeof( *model ) ) );
+
+				sum = msum	= 5;
+				lo = hi	= 99;
+				mlo = mhi	= w ? model[ off ] : 99;
+				for ( i = 0; i < w; ++i )
+				{
+					msum	+= model[ off + i ];
+					mlo	= model[ off + i ] < mlo ? model[ off + i ] : mlo;
+					mhi	= model[ off + i ] > mhi ? model[ off + i ] : mhi;
+				}
+				TEST_CHECK_EQ( twin_window_sum( &rb, off, n, &sum ), w );
+				TEST_CHECK_EQ( sum, msum );
+				TEST_CHECK_EQ( twin_window_minmax( &rb, off, n, &lo, &hi ), w );
+				TEST_CHECK( lo == mlo && hi == mhi );
+
+				crc = mcrc	= ~0u;
+				mcrc	= ring_buffer_crc32( mcrc, &model[ off ], w * sizeof( *model ) );
+				TEST_CHECK_EQ( twin_window_crc32( &rb, off, n, &crc ), w );
+				TEST_CHECK_EQ( crc, mcrc );
+			}
+
+		TEST_CHECK_EQ( twin_count( &rb ), used );	// Nothing consumed.
+	}
+
+	TEST_CASE( "window/spsc-generic" )
+	{
+		twin_spsc_init( &rs, NULL );
+		rs.input = rs.output = rs.input_cache = rs.output_cache	= 5;
+		for ( i = 0; i < ARRAY_COUNT( pairs ); ++i )
+			pairs[ i ]	= ( struct twin_pair ){ ( uint8_t )i, ( uint8_t )~i };
+		TEST_CHECK_EQ( twin_spsc_push_n( &rs, pairs, ARRAY_COUNT( pairs ) ), ARRAY_COUNT( pairs ) );
+
+		total	= 0;
+		TEST_CHECK_EQ( twin_spsc_for_each_span( &rs, 1, SIZE_MAX, twin_spsc_tally, &total ), 5 );
+		TEST_CHECK_EQ( total, 5 );
+
+		crc = mcrc	= ~0u;
+		mcrc	= ring_buffer_crc32( mcrc, pairs, sizeof( pairs ) );
+		TEST_CHECK_EQ( twin_spsc_window_crc32( &rs, 0, SIZE_MAX, &crc ), ARRAY_COUNT( pairs ) );
+		TEST_CHECK_EQ( crc, mcrc );
+	}
+
+	return test_report();
+}